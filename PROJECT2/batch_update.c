@@ -0,0 +1,54 @@
+#include "batch_update.h"
+#include <stdbool.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_HAVE_AVX2_PATH 1
+#endif
+
+static unsigned long long batch_add_scalar(long long* values, const long long* deltas, int count) {
+    unsigned long long mask = 0;
+    for (int i = 0; i < count; ++i) {
+        values[i] += deltas[i];
+        if (values[i] >= BATCH_SMALL_LIMIT || values[i] <= -BATCH_SMALL_LIMIT) mask |= 1ULL << i;
+    }
+    return mask;
+}
+
+#ifdef BATCH_HAVE_AVX2_PATH
+__attribute__((target("avx2")))
+static unsigned long long batch_add_avx2(long long* values, const long long* deltas, int count) {
+    // A result r is in range iff r + LIMIT lies in [0, 2 * LIMIT), i.e. has no bits above
+    const __m256i bias = _mm256_set1_epi64x(BATCH_SMALL_LIMIT);
+    const __m256i high_bits = _mm256_set1_epi64x(~(2 * BATCH_SMALL_LIMIT - 1));
+    const __m256i zero = _mm256_setzero_si256();
+    unsigned long long mask = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i sum = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(values + i)),
+                                       _mm256_loadu_si256((const __m256i*)(deltas + i)));
+        _mm256_storeu_si256((__m256i*)(values + i), sum);
+        __m256i outside = _mm256_and_si256(_mm256_add_epi64(sum, bias), high_bits);
+        int in_range = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(outside, zero)));
+        mask |= (unsigned long long)(~in_range & 0xF) << i;
+    }
+    if (i < count) mask |= batch_add_scalar(values + i, deltas + i, count - i) << i;
+    return mask;
+}
+
+static pthread_once_t detect_once = PTHREAD_ONCE_INIT;
+static bool cpu_has_avx2 = false;
+
+static void detect_avx2(void) {
+    __builtin_cpu_init();
+    cpu_has_avx2 = __builtin_cpu_supports("avx2");
+}
+#endif
+
+unsigned long long batch_add_small(long long* values, const long long* deltas, int count) {
+#ifdef BATCH_HAVE_AVX2_PATH
+    pthread_once(&detect_once, detect_avx2);
+    if (cpu_has_avx2) return batch_add_avx2(values, deltas, count);
+#endif
+    return batch_add_scalar(values, deltas, count);
+}
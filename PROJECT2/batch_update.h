@@ -0,0 +1,15 @@
+#ifndef BATCH_UPDATE_H
+#define BATCH_UPDATE_H
+
+// Values and amounts below this in magnitude take the vector path; their sums
+// are exact in 64 bits, so a lane can always be redone with BigInt
+#define BATCH_SMALL_LIMIT (1LL << 61)
+// Most lanes (updates) added at once
+#define BATCH_MAX_LANES 64
+
+// values[i] += deltas[i] for every i < count (count <= BATCH_MAX_LANES), with
+// AVX2 when the CPU has it. Returns a mask of the lanes whose result is no
+// longer below BATCH_SMALL_LIMIT in magnitude.
+unsigned long long batch_add_small(long long* values, const long long* deltas, int count);
+
+#endif // BATCH_UPDATE_H
@@ -0,0 +1,393 @@
+#include "cache.h"
+#include "units.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/sendfile.h>
+
+#define CACHE_MAGIC "PLCACHE1"
+
+// On-disk entry: header, identity string, source, stdout bytes, stderr bytes.
+// The identity and source are kept so a hit is verified byte for byte, not just by hash.
+typedef struct {
+    char magic[8];
+    uint64_t identity_length;
+    uint64_t source_length;
+    uint64_t stdout_length;
+    uint64_t stderr_length;
+    int32_t exit_status;
+    int32_t reserved;
+} CacheEntryHeader;
+
+// A cache file found while trimming the directory
+typedef struct {
+    char* path;
+    off_t size;
+    struct timespec last_used;
+} CacheFileInfo;
+
+uint64_t cache_hash_bytes(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+char* cache_read_file(const char* path, size_t* out_length) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    size_t capacity = 4096, length = 0, n;
+    char* data = (char*)malloc(capacity);
+    if (!data) {
+        fprintf(stderr, "Memory allocation failed for cached source.\n");
+        exit(EXIT_FAILURE);
+    }
+    while ((n = fread(data + length, 1, capacity - length, file)) > 0) {
+        length += n;
+        if (length == capacity) {
+            capacity *= 2;
+            data = (char*)realloc(data, capacity);
+            if (!data) {
+                fprintf(stderr, "Memory allocation failed for cached source.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    fclose(file);
+    *out_length = length;
+    return data;
+}
+
+void cache_build_identity(char* buffer, size_t size, const char* mode_key) {
+    struct stat st;
+    if (stat("/proc/self/exe", &st) == 0) {
+        snprintf(buffer, size, "exe:%llu:%lld:%lld.%09ld|%s", (unsigned long long)st.st_ino, (long long)st.st_size,
+                 (long long)st.st_mtim.tv_sec, st.st_mtim.tv_nsec, mode_key);
+    } else {
+        snprintf(buffer, size, "build:%s %s|%s", __DATE__, __TIME__, mode_key);
+    }
+}
+
+// True if the file at path is gone or was modified since `before` was taken
+static bool changed_since(const char* path, const struct stat* before) {
+    struct stat after;
+    return stat(path, &after) != 0 || after.st_size != before->st_size ||
+           after.st_mtim.tv_sec != before->st_mtim.tv_sec || after.st_mtim.tv_nsec != before->st_mtim.tv_nsec;
+}
+
+// True if the files the source includes still read as the bytes from
+// included_start to included_end of the stored source
+static bool includes_unchanged(const char* source_path, const char* source, size_t included_start, size_t included_end) {
+    if (included_end == included_start) return true; // Nothing included, or nothing readable
+    char* current = (char*)malloc(included_start + 1);
+    if (!current) {
+        fprintf(stderr, "Memory allocation failed for cached source.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(current, source, included_start);
+    size_t current_length = included_start;
+    units_append_sources(source_path, &current, &current_length);
+    bool same = current_length == included_end &&
+                memcmp(current + included_start, source + included_start, included_end - included_start) == 0;
+    free(current);
+    return same;
+}
+
+static bool write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+// Copies a byte range between descriptors in the kernel where possible. sendfile
+// refuses some targets (e.g. O_APPEND files), so fall back to read/write.
+static bool copy_range(int out_fd, int in_fd, off_t offset, size_t length) {
+    while (length > 0) {
+        ssize_t n = sendfile(out_fd, in_fd, &offset, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        length -= (size_t)n;
+    }
+    char buffer[65536];
+    while (length > 0) {
+        ssize_t n = pread(in_fd, buffer, length < sizeof(buffer) ? length : sizeof(buffer), offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0 || !write_all(out_fd, buffer, (size_t)n)) return false;
+        offset += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static bool read_exact(int fd, void* data, size_t length, off_t offset) {
+    char* p = (char*)data;
+    while (length > 0) {
+        ssize_t n = pread(fd, p, length, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        offset += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+// Compares a stored region of the entry with the expected bytes
+static bool region_matches(int fd, off_t offset, const char* expected, size_t length) {
+    char buffer[65536];
+    while (length > 0) {
+        size_t chunk = length < sizeof(buffer) ? length : sizeof(buffer);
+        if (!read_exact(fd, buffer, chunk, offset) || memcmp(buffer, expected, chunk) != 0) return false;
+        expected += chunk;
+        offset += (off_t)chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+static bool try_replay(const char* entry_path, const char* identity, const char* source, size_t source_length,
+                       int* exit_status) {
+    int fd = open(entry_path, O_RDONLY);
+    if (fd < 0) return false;
+
+    CacheEntryHeader header;
+    size_t identity_length = strlen(identity);
+    off_t data_start = (off_t)(sizeof(header) + identity_length + source_length);
+    bool hit = read_exact(fd, &header, sizeof(header), 0) &&
+               memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+               header.identity_length == identity_length && header.source_length == source_length &&
+               region_matches(fd, sizeof(header), identity, identity_length) &&
+               region_matches(fd, (off_t)(sizeof(header) + identity_length), source, source_length);
+    if (hit) {
+        futimens(fd, NULL); // Mark as recently used for eviction
+        fflush(stdout);
+        fflush(stderr);
+        copy_range(STDOUT_FILENO, fd, data_start, header.stdout_length);
+        copy_range(STDERR_FILENO, fd, data_start + (off_t)header.stdout_length, header.stderr_length);
+        *exit_status = header.exit_status;
+    }
+    close(fd);
+    return hit;
+}
+
+// True for the name of a finished entry: recorded output, or a compiled unit (units.h)
+static bool is_entry_name(const char* name) {
+    static const char* const suffixes[] = { CACHE_ENTRY_SUFFIX, UNIT_ENTRY_SUFFIX };
+    size_t name_length = strlen(name);
+    if (name[0] == '.') return false; // Still being written
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); ++i) {
+        size_t suffix_length = strlen(suffixes[i]);
+        if (name_length > suffix_length && strcmp(name + name_length - suffix_length, suffixes[i]) == 0) return true;
+    }
+    return false;
+}
+
+static int compare_last_used(const void* a, const void* b) {
+    const CacheFileInfo* x = (const CacheFileInfo*)a;
+    const CacheFileInfo* y = (const CacheFileInfo*)b;
+    if (x->last_used.tv_sec != y->last_used.tv_sec) return x->last_used.tv_sec < y->last_used.tv_sec ? -1 : 1;
+    if (x->last_used.tv_nsec != y->last_used.tv_nsec) return x->last_used.tv_nsec < y->last_used.tv_nsec ? -1 : 1;
+    return 0;
+}
+
+// Deletes least recently used entries until the directory fits in max_bytes
+static void trim_cache(const char* cache_dir, unsigned long long max_bytes) {
+    DIR* dir = opendir(cache_dir);
+    if (!dir) return;
+
+    CacheFileInfo* files = NULL;
+    int count = 0, capacity = 0;
+    unsigned long long total = 0;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (!is_entry_name(ent->d_name)) continue;
+        size_t name_length = strlen(ent->d_name);
+        size_t path_length = strlen(cache_dir) + name_length + 2;
+        char* path = (char*)malloc(path_length);
+        if (!path) {
+            fprintf(stderr, "Memory allocation failed while trimming cache.\n");
+            exit(EXIT_FAILURE);
+        }
+        snprintf(path, path_length, "%s/%s", cache_dir, ent->d_name);
+        struct stat st;
+        if (stat(path, &st) != 0) {
+            free(path);
+            continue;
+        }
+        if (count >= capacity) {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            files = (CacheFileInfo*)realloc(files, capacity * sizeof(CacheFileInfo));
+            if (!files) {
+                fprintf(stderr, "Memory allocation failed while trimming cache.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        files[count].path = path;
+        files[count].size = st.st_size;
+        files[count].last_used = st.st_mtim;
+        count++;
+        total += (unsigned long long)st.st_size;
+    }
+    closedir(dir);
+
+    if (total > max_bytes) {
+        qsort(files, count, sizeof(CacheFileInfo), compare_last_used);
+        for (int i = 0; i < count && total > max_bytes; ++i) {
+            if (unlink(files[i].path) == 0) total -= (unsigned long long)files[i].size;
+        }
+    }
+    for (int i = 0; i < count; ++i) free(files[i].path);
+    free(files);
+}
+
+CacheOutcome cache_run(const char* cache_dir, unsigned long long max_bytes, const char* source_path,
+                       const char* input_path, const char* mode_key, int* exit_status) {
+    if (mkdir(cache_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Warning: Could not create cache directory '%s'; running uncached.\n", cache_dir);
+        return CACHE_RUN_HERE;
+    }
+    struct stat source_before;
+    size_t source_length;
+    char* source = stat(source_path, &source_before) == 0 ? cache_read_file(source_path, &source_length) : NULL;
+    if (!source) return CACHE_RUN_HERE; // The normal run reports the unreadable file
+
+    char identity[512];
+    cache_build_identity(identity, sizeof(identity), mode_key);
+    // Included files follow the source, so editing any of them is a miss
+    size_t included_start = source_length;
+    units_append_sources(source_path, &source, &source_length);
+    if (source_length > included_start) {
+        size_t identity_length = strlen(identity);
+        snprintf(identity + identity_length, sizeof(identity) - identity_length, "|units@%zu", included_start);
+    }
+    size_t included_end = source_length;
+    struct stat input_before;
+    if (input_path) {
+        // The input is stored and verified right after the source; the identity says where it starts
+        size_t input_length;
+        char* input = stat(input_path, &input_before) == 0 ? cache_read_file(input_path, &input_length) : NULL;
+        if (!input) {
+            free(source);
+            return CACHE_RUN_HERE;
+        }
+        source = (char*)realloc(source, source_length + input_length + 1);
+        if (!source) {
+            fprintf(stderr, "Memory allocation failed for cached source.\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(source + source_length, input, input_length);
+        size_t identity_length = strlen(identity);
+        snprintf(identity + identity_length, sizeof(identity) - identity_length, "|input@%zu", source_length);
+        source_length += input_length;
+        free(input);
+    }
+    uint64_t key = cache_hash_bytes(cache_hash_bytes(CACHE_HASH_SEED, identity, strlen(identity)), source, source_length);
+
+    size_t path_length = strlen(cache_dir) + 64;
+    char* entry_path = (char*)malloc(path_length);
+    char* temp_path = (char*)malloc(path_length);
+    char* stderr_path = (char*)malloc(path_length);
+    if (!entry_path || !temp_path || !stderr_path) {
+        fprintf(stderr, "Memory allocation failed for cache paths.\n");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(entry_path, path_length, "%s/%016llx%s", cache_dir, (unsigned long long)key, CACHE_ENTRY_SUFFIX);
+    snprintf(temp_path, path_length, "%s/.tmp-%ld%s", cache_dir, (long)getpid(), CACHE_ENTRY_SUFFIX);
+    snprintf(stderr_path, path_length, "%s/.tmp-%ld.err", cache_dir, (long)getpid());
+
+    CacheOutcome outcome = CACHE_RUN_HERE;
+    if (try_replay(entry_path, identity, source, source_length, exit_status)) {
+        outcome = CACHE_REPLAYED;
+        goto done;
+    }
+
+    // Miss: the entry is written in place, stdout going straight after the source
+    int entry_fd = open(temp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    int stderr_fd = open(stderr_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    CacheEntryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.identity_length = strlen(identity);
+    header.source_length = source_length;
+    off_t data_start = (off_t)(sizeof(header) + header.identity_length + source_length);
+    if (entry_fd < 0 || stderr_fd < 0 || !write_all(entry_fd, (const char*)&header, sizeof(header)) ||
+        !write_all(entry_fd, identity, header.identity_length) || !write_all(entry_fd, source, source_length)) {
+        fprintf(stderr, "Warning: Could not write to cache directory '%s'; running uncached.\n", cache_dir);
+        if (entry_fd >= 0) close(entry_fd);
+        if (stderr_fd >= 0) close(stderr_fd);
+        unlink(temp_path);
+        unlink(stderr_path);
+        goto done;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t child = fork();
+    if (child == 0) {
+        dup2(entry_fd, STDOUT_FILENO);
+        dup2(stderr_fd, STDERR_FILENO);
+        close(entry_fd);
+        close(stderr_fd);
+        goto done; // The child runs the script; its exit status is recorded by the parent
+    }
+
+    bool commit = false;
+    if (child > 0) {
+        int status;
+        while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+        if (WIFEXITED(status)) {
+            *exit_status = WEXITSTATUS(status);
+            commit = true;
+        } else {
+            *exit_status = 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0); // Crashes are not cached
+        }
+        // A source (or input) edited during the run may not match what was stored
+        if (changed_since(source_path, &source_before) || (input_path && changed_since(input_path, &input_before)) ||
+            !includes_unchanged(source_path, source, included_start, included_end)) {
+            commit = false;
+        }
+
+        struct stat out_st, err_st;
+        fstat(entry_fd, &out_st);
+        fstat(stderr_fd, &err_st);
+        header.stdout_length = (uint64_t)(out_st.st_size - data_start);
+        header.stderr_length = (uint64_t)err_st.st_size;
+        header.exit_status = *exit_status;
+        lseek(entry_fd, 0, SEEK_END);
+        commit = commit && copy_range(entry_fd, stderr_fd, 0, header.stderr_length) &&
+                 pwrite(entry_fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+                 rename(temp_path, entry_path) == 0;
+
+        copy_range(STDOUT_FILENO, entry_fd, data_start, header.stdout_length);
+        copy_range(STDERR_FILENO, stderr_fd, 0, header.stderr_length);
+        outcome = CACHE_REPLAYED;
+    } else {
+        fprintf(stderr, "Warning: Could not fork a recording run; running uncached.\n");
+    }
+    close(entry_fd);
+    close(stderr_fd);
+    unlink(stderr_path);
+    if (!commit) unlink(temp_path);
+    if (commit) trim_cache(cache_dir, max_bytes);
+
+done:
+    free(entry_path);
+    free(temp_path);
+    free(stderr_path);
+    free(source);
+    return outcome;
+}
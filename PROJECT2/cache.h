@@ -0,0 +1,39 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Default bound on the total size of a cache directory
+#define CACHE_DEFAULT_MAX_BYTES (256ULL * 1024 * 1024)
+// File name suffix of cache entries
+#define CACHE_ENTRY_SUFFIX ".plc"
+// Starting value for cache_hash_bytes
+#define CACHE_HASH_SEED 1469598103934665603ULL
+
+typedef enum {
+    CACHE_REPLAYED,  // The result was served (from the cache, or recorded by a child run); exit with exit_status
+    CACHE_RUN_HERE   // Run the script normally in this process (child of a recording run, or caching unavailable)
+} CacheOutcome;
+
+// A program's output depends only on the source and the files it includes,
+// the interpreter binary, the output mode (mode_key) and the file its read
+// statements take input from (input_path, NULL if it has none: cached runs
+// never read stdin). On a hit the recorded
+// stdout/stderr bytes are copied out with sendfile. On a miss the process
+// forks: the child returns CACHE_RUN_HERE with stdout/stderr redirected into
+// a new entry, while the parent waits, stores the entry, replays it and
+// returns CACHE_REPLAYED. The directory is trimmed to max_bytes, least
+// recently used entries first.
+CacheOutcome cache_run(const char* cache_dir, unsigned long long max_bytes, const char* source_path,
+                       const char* input_path, const char* mode_key, int* exit_status);
+
+// FNV-1a over length bytes, continuing from hash
+uint64_t cache_hash_bytes(uint64_t hash, const void* data, size_t length);
+// Whole contents of a file (length in out_length), or NULL if it cannot be opened
+char* cache_read_file(const char* path, size_t* out_length);
+// Identifies the running interpreter binary (any rebuild changes it) and mode_key
+void cache_build_identity(char* buffer, size_t size, const char* mode_key);
+
+#endif // CACHE_H
@@ -0,0 +1,171 @@
+#include "check.h"
+#include "lexer.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+typedef struct {
+    char* path;
+    bool ok;
+    char error_msg[512];   // First error of the file, empty if ok
+} CheckResult;
+
+typedef struct {
+    const Grammar* grammar;
+    CheckResult* results;
+} CheckJob;
+
+// --- Single File ---
+
+// Lexes and recognizes one file; on failure the first error lands in result->error_msg
+static void check_file(const Grammar* grammar, CheckResult* result) {
+    result->ok = false;
+    result->error_msg[0] = '\0';
+
+    FILE* input = fopen(result->path, "r");
+    if (!input) {
+        snprintf(result->error_msg, sizeof(result->error_msg), "Could not open input file");
+        return;
+    }
+
+    LexContext* lex = (LexContext*)malloc(sizeof(LexContext));
+    if (!lex) {
+        fprintf(stderr, "Memory allocation failed for check lexer context.\n");
+        exit(EXIT_FAILURE);
+    }
+    init_lexer(lex, input, result->path);
+    lex->report_errors = false;
+    lex->intern_strings = false; // No AST is built, so literals need no pool entries
+
+    LRParser parser;
+    lr_parser_init(&parser, grammar);
+    parser.build_ast = false;
+    parser.report_errors = false;
+
+    ParseStatus status = PARSE_STATUS_CONTINUE;
+    while (status == PARSE_STATUS_CONTINUE) {
+        Token token = get_next_token(lex);
+        if (token.type == TOKEN_ERROR) {
+            snprintf(result->error_msg, sizeof(result->error_msg), "%s", lex->error_msg);
+            break;
+        }
+        status = lr_parser_feed(&parser, &token);
+    }
+
+    if (status == PARSE_STATUS_ACCEPT) {
+        result->ok = true;
+    } else if (status == PARSE_STATUS_ERROR) {
+        // Some driver messages open with a blank line; one line per file reads better here
+        const char* message = parser.error_msg;
+        while (*message == '\n') message++;
+        snprintf(result->error_msg, sizeof(result->error_msg), "%s", message);
+    }
+
+    lr_parser_free(&parser);
+    free_lex_context(lex);
+    free(lex);
+    fclose(input);
+}
+
+static void check_task(void* context, int task_index) {
+    CheckJob* job = (CheckJob*)context;
+    check_file(job->grammar, &job->results[task_index]);
+}
+
+// --- Directory Scan ---
+
+static void add_path(char*** paths, int* count, int* capacity, const char* path) {
+    if (*count >= *capacity) {
+        *capacity = *capacity == 0 ? 64 : *capacity * 2;
+        *paths = (char**)realloc(*paths, *capacity * sizeof(char*));
+        if (!*paths) {
+            fprintf(stderr, "Memory allocation failed for check file list.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    (*paths)[(*count)++] = strdup(path);
+}
+
+// Collects every regular file below dir_path, skipping hidden entries. Symlinks
+// to files are checked, but symlinked directories are not followed: one that
+// points at an ancestor would make the scan recurse forever.
+static void collect_files(const char* dir_path, char*** paths, int* count, int* capacity) {
+    DIR* dir = opendir(dir_path);
+    if (!dir) {
+        fprintf(stderr, "Error: Could not open directory '%s'\n", dir_path);
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        size_t length = strlen(dir_path) + strlen(entry->d_name) + 2;
+        char* child = (char*)malloc(length);
+        if (!child) {
+            fprintf(stderr, "Memory allocation failed for check file list.\n");
+            exit(EXIT_FAILURE);
+        }
+        snprintf(child, length, "%s/%s", dir_path, entry->d_name);
+        struct stat info;
+        bool found = lstat(child, &info) == 0;
+        // A link stands for its target, unless that is a directory
+        if (found && S_ISLNK(info.st_mode)) found = stat(child, &info) == 0 && !S_ISDIR(info.st_mode);
+        if (found) {
+            if (S_ISDIR(info.st_mode)) {
+                collect_files(child, paths, count, capacity);
+            } else if (S_ISREG(info.st_mode)) {
+                add_path(paths, count, capacity, child);
+            }
+        }
+        free(child);
+    }
+    closedir(dir);
+}
+
+static int compare_paths(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+bool run_check(const Grammar* grammar, const char* path) {
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        fprintf(stderr, "Error: Could not open input file '%s'\n", path);
+        return false;
+    }
+
+    char** paths = NULL;
+    int count = 0, capacity = 0;
+    bool directory = S_ISDIR(info.st_mode);
+    if (directory) {
+        collect_files(path, &paths, &count, &capacity);
+        qsort(paths, count, sizeof(char*), compare_paths);
+    } else {
+        add_path(&paths, &count, &capacity, path);
+    }
+
+    CheckResult* results = (CheckResult*)calloc(count > 0 ? count : 1, sizeof(CheckResult));
+    if (!results) {
+        fprintf(stderr, "Memory allocation failed for check results.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < count; ++i) results[i].path = paths[i];
+
+    CheckJob job = { .grammar = grammar, .results = results };
+    parallel_for(count, check_task, &job);
+
+    int failed = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!results[i].ok) {
+            fprintf(stderr, "%s: %s\n", results[i].path, results[i].error_msg);
+            failed++;
+        }
+        free(paths[i]);
+    }
+    if (directory) printf("Checked %d file(s): %d with errors\n", count, failed);
+
+    free(results);
+    free(paths);
+    return failed == 0;
+}
@@ -0,0 +1,15 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdbool.h>
+#include "parser.h"
+
+// Syntax-only check of a script, or of every file below a directory.
+// Tokens are streamed from the lexer straight into the LR driver with AST
+// construction switched off, so no tree is ever allocated. Only the first
+// error of each file is reported, as "<file>: <message>" on stderr; files of
+// a directory are checked in parallel and reported in path order. The parsing
+// tables must already be built. Returns false if any file failed.
+bool run_check(const Grammar* grammar, const char* path);
+
+#endif // CHECK_H
@@ -0,0 +1,316 @@
+#include "compress.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define HASH_BITS 12
+#define MIN_MATCH 4
+// As in LZ4: a block ends in at least 5 literals, and no match starts in its
+// last 12 bytes, so decoders may copy in whole words near the end
+#define LAST_LITERALS 5
+#define MATCH_FIND_LIMIT 12
+// Largest encoding of a block (every byte a literal, plus length bytes)
+#define COMPRESS_BOUND (COMPRESS_BLOCK_SIZE + COMPRESS_BLOCK_SIZE / 255 + 16)
+// Hash table positions that can no longer be matched
+#define NO_POSITION (-1)
+
+struct Compressor {
+    const OutputSink* downstream;
+    // The window (the last COMPRESS_WINDOW_SIZE bytes or fewer) followed by the
+    // block being filled; positions below are offsets into it
+    unsigned char* buffer;
+    size_t window_length;
+    size_t block_length;
+    int32_t table[1 << HASH_BITS]; // Last position of each hashed 4-byte sequence
+    unsigned char* encoded;        // COMPRESS_BOUND bytes after a block length
+    uint64_t total;
+};
+
+static uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hash_sequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void store32_le(unsigned char* p, uint32_t value) {
+    for (int i = 0; i < 4; ++i) p[i] = (unsigned char)(value >> (8 * i));
+}
+
+static void store64_le(unsigned char* p, uint64_t value) {
+    for (int i = 0; i < 8; ++i) p[i] = (unsigned char)(value >> (8 * i));
+}
+
+static unsigned char* put_length(unsigned char* out, size_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (unsigned char)length;
+    return out;
+}
+
+static unsigned char* put_sequence(unsigned char* out, const unsigned char* literals, size_t literal_length,
+                                   size_t offset, size_t match_length) {
+    unsigned char* token = out++;
+    *token = (unsigned char)((literal_length >= 15 ? 15 : literal_length) << 4);
+    if (literal_length >= 15) out = put_length(out, literal_length - 15);
+    memcpy(out, literals, literal_length);
+    out += literal_length;
+    if (match_length == 0) return out; // The closing literals
+    *out++ = (unsigned char)offset;
+    *out++ = (unsigned char)(offset >> 8);
+    size_t extra = match_length - MIN_MATCH;
+    *token |= (unsigned char)(extra >= 15 ? 15 : extra);
+    if (extra >= 15) out = put_length(out, extra - 15);
+    return out;
+}
+
+// Length of the common run at a and b, at least MIN_MATCH, stopping before limit
+static size_t match_length(const unsigned char* a, const unsigned char* b, const unsigned char* limit) {
+    size_t length = MIN_MATCH;
+    while (b + length + sizeof(uint64_t) <= limit) {
+        uint64_t x, y;
+        memcpy(&x, a + length, sizeof(x));
+        memcpy(&y, b + length, sizeof(y));
+        if (x != y) return length + (size_t)(__builtin_ctzll(x ^ y) >> 3);
+        length += sizeof(uint64_t);
+    }
+    while (b + length < limit && a[length] == b[length]) length++;
+    return length;
+}
+
+// Encodes buffer[start, end) into out, matching against anything from 0 on;
+// returns the encoded length
+static size_t encode_block(Compressor* compressor, size_t start, size_t end, unsigned char* out) {
+    const unsigned char* base = compressor->buffer;
+    unsigned char* out_start = out;
+    size_t anchor = start;
+    if (end - start > MATCH_FIND_LIMIT) {
+        size_t find_limit = end - MATCH_FIND_LIMIT;
+        const unsigned char* match_limit = base + end - LAST_LITERALS;
+        size_t position = start;
+        while (position < find_limit) {
+            uint32_t sequence = read32(base + position);
+            uint32_t hash = hash_sequence(sequence);
+            int32_t candidate = compressor->table[hash];
+            compressor->table[hash] = (int32_t)position;
+            if (candidate == NO_POSITION || position - (size_t)candidate > COMPRESS_WINDOW_SIZE ||
+                read32(base + candidate) != sequence) {
+                // Step faster through data that keeps not matching
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+            size_t reference = (size_t)candidate;
+            while (position > anchor && reference > 0 && base[position - 1] == base[reference - 1]) {
+                position--;
+                reference--;
+            }
+            size_t length = match_length(base + reference, base + position, match_limit);
+            out = put_sequence(out, base + anchor, position - anchor, position - reference, length);
+            position += length;
+            anchor = position;
+            if (position - 2 >= start && position < find_limit) {
+                compressor->table[hash_sequence(read32(base + position - 2))] = (int32_t)(position - 2);
+            }
+        }
+    }
+    out = put_sequence(out, base + anchor, end - anchor, 0, 0);
+    return (size_t)(out - out_start);
+}
+
+static void flush_block(Compressor* compressor) {
+    if (compressor->block_length == 0) return;
+    size_t start = compressor->window_length;
+    size_t end = start + compressor->block_length;
+    unsigned char* header = compressor->encoded;
+    size_t length = encode_block(compressor, start, end, header + 4);
+    if (length >= compressor->block_length) {
+        // Incompressible: the block goes out as is
+        length = compressor->block_length;
+        store32_le(header, (uint32_t)length | COMPRESS_STORED_FLAG);
+        memcpy(header + 4, compressor->buffer + start, length);
+    } else {
+        store32_le(header, (uint32_t)length);
+    }
+    compressor->downstream->write(compressor->downstream->context, (const char*)header, length + 4);
+    compressor->total += compressor->block_length;
+
+    // Keep the tail as the window of the next block; positions move down with it
+    size_t keep = end < COMPRESS_WINDOW_SIZE ? end : COMPRESS_WINDOW_SIZE;
+    size_t shift = end - keep;
+    if (shift > 0) {
+        memmove(compressor->buffer, compressor->buffer + shift, keep);
+        for (size_t i = 0; i < sizeof(compressor->table) / sizeof(compressor->table[0]); ++i) {
+            int32_t position = compressor->table[i];
+            compressor->table[i] = position != NO_POSITION && (size_t)position >= shift ? (int32_t)((size_t)position - shift) : NO_POSITION;
+        }
+    }
+    compressor->window_length = keep;
+    compressor->block_length = 0;
+}
+
+Compressor* compressor_create(const OutputSink* downstream) {
+    Compressor* compressor = (Compressor*)malloc(sizeof(Compressor));
+    unsigned char* buffer = (unsigned char*)malloc(COMPRESS_WINDOW_SIZE + COMPRESS_BLOCK_SIZE);
+    unsigned char* encoded = (unsigned char*)malloc(4 + COMPRESS_BOUND);
+    if (!compressor || !buffer || !encoded) {
+        fprintf(stderr, "Memory allocation failed for output compressor.\n");
+        exit(EXIT_FAILURE);
+    }
+    compressor->downstream = downstream;
+    compressor->buffer = buffer;
+    compressor->window_length = 0;
+    compressor->block_length = 0;
+    for (size_t i = 0; i < sizeof(compressor->table) / sizeof(compressor->table[0]); ++i) {
+        compressor->table[i] = NO_POSITION;
+    }
+    compressor->encoded = encoded;
+    compressor->total = 0;
+    downstream->write(downstream->context, COMPRESS_MAGIC, 4);
+    return compressor;
+}
+
+void compressor_write(Compressor* compressor, const char* data, size_t length) {
+    while (length > 0) {
+        size_t room = COMPRESS_BLOCK_SIZE - compressor->block_length;
+        size_t chunk = length < room ? length : room;
+        memcpy(compressor->buffer + compressor->window_length + compressor->block_length, data, chunk);
+        compressor->block_length += chunk;
+        data += chunk;
+        length -= chunk;
+        if (compressor->block_length == COMPRESS_BLOCK_SIZE) flush_block(compressor);
+    }
+}
+
+void compressor_finish(Compressor* compressor) {
+    flush_block(compressor);
+    unsigned char trailer[12];
+    store32_le(trailer, 0);
+    store64_le(trailer + 4, compressor->total);
+    compressor->downstream->write(compressor->downstream->context, (const char*)trailer, sizeof(trailer));
+    free(compressor->buffer);
+    free(compressor->encoded);
+    free(compressor);
+}
+
+static bool get_length(const unsigned char** in, const unsigned char* end, size_t* length) {
+    unsigned char byte;
+    do {
+        if (*in >= end) return false;
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// Decodes in[0, length) after the window_length bytes of history in buffer;
+// returns the decoded length, or -1 if the block is damaged
+static long decode_block(unsigned char* buffer, size_t window_length, const unsigned char* in, size_t length) {
+    const unsigned char* in_end = in + length;
+    unsigned char* out = buffer + window_length;
+    unsigned char* out_end = out + COMPRESS_BLOCK_SIZE;
+    while (in < in_end) {
+        unsigned char token = *in++;
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !get_length(&in, in_end, &literal_length)) return -1;
+        if (literal_length > (size_t)(in_end - in) || literal_length > (size_t)(out_end - out)) return -1;
+        memcpy(out, in, literal_length);
+        out += literal_length;
+        in += literal_length;
+        if (in == in_end) break; // The closing literals have no match
+
+        if (in_end - in < 2) return -1;
+        size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+        in += 2;
+        size_t match = token & 15;
+        if (match == 15 && !get_length(&in, in_end, &match)) return -1;
+        match += MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(out - buffer) || match > (size_t)(out_end - out)) return -1;
+        const unsigned char* source = out - offset;
+        if (offset >= match) {
+            memcpy(out, source, match);
+        } else {
+            // Overlapping: each byte may repeat one just written
+            for (size_t i = 0; i < match; ++i) out[i] = source[i];
+        }
+        out += match;
+    }
+    return (long)(out - (buffer + window_length));
+}
+
+static uint64_t load_le(const unsigned char* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) value = (value << 8) | p[i];
+    return value;
+}
+
+bool decompress_stream(FILE* in, FILE* out) {
+    unsigned char magic[4];
+    if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, COMPRESS_MAGIC, sizeof(magic)) != 0) {
+        fprintf(stderr, "Decompress Error: Input is not compressed program output.\n");
+        return false;
+    }
+    unsigned char* buffer = (unsigned char*)malloc(COMPRESS_WINDOW_SIZE + COMPRESS_BLOCK_SIZE);
+    unsigned char* encoded = (unsigned char*)malloc(COMPRESS_BOUND);
+    if (!buffer || !encoded) {
+        fprintf(stderr, "Memory allocation failed for output decompressor.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bool ok = false;
+    size_t window_length = 0;
+    uint64_t total = 0;
+    for (;;) {
+        unsigned char header[4];
+        if (fread(header, 1, sizeof(header), in) != sizeof(header)) {
+            fprintf(stderr, "Decompress Error: Stream is truncated after %llu bytes of output.\n", (unsigned long long)total);
+            break;
+        }
+        uint32_t word = (uint32_t)load_le(header, 4);
+        if (word == 0) {
+            unsigned char trailer[8];
+            if (fread(trailer, 1, sizeof(trailer), in) != sizeof(trailer)) {
+                fprintf(stderr, "Decompress Error: Stream is truncated after %llu bytes of output.\n", (unsigned long long)total);
+            } else if (load_le(trailer, 8) != total) {
+                fprintf(stderr, "Decompress Error: Stream records %llu bytes of output but holds %llu.\n",
+                        (unsigned long long)load_le(trailer, 8), (unsigned long long)total);
+            } else {
+                ok = true;
+            }
+            break;
+        }
+        bool stored = (word & COMPRESS_STORED_FLAG) != 0;
+        size_t length = word & ~COMPRESS_STORED_FLAG;
+        if (length > (stored ? COMPRESS_BLOCK_SIZE : COMPRESS_BOUND)) {
+            fprintf(stderr, "Decompress Error: Damaged block after %llu bytes of output.\n", (unsigned long long)total);
+            break;
+        }
+        unsigned char* target = stored ? buffer + window_length : encoded;
+        if (fread(target, 1, length, in) != length) {
+            fprintf(stderr, "Decompress Error: Stream is truncated after %llu bytes of output.\n", (unsigned long long)total);
+            break;
+        }
+        long decoded = stored ? (long)length : decode_block(buffer, window_length, encoded, length);
+        if (decoded < 0) {
+            fprintf(stderr, "Decompress Error: Damaged block after %llu bytes of output.\n", (unsigned long long)total);
+            break;
+        }
+        if (fwrite(buffer + window_length, 1, (size_t)decoded, out) != (size_t)decoded) {
+            fprintf(stderr, "Decompress Error: Could not write the output.\n");
+            break;
+        }
+        total += (uint64_t)decoded;
+
+        size_t end = window_length + (size_t)decoded;
+        size_t keep = end < COMPRESS_WINDOW_SIZE ? end : COMPRESS_WINDOW_SIZE;
+        memmove(buffer, buffer + end - keep, keep);
+        window_length = keep;
+    }
+    free(buffer);
+    free(encoded);
+    return ok;
+}
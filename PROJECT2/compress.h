@@ -0,0 +1,32 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "output.h"
+
+// Stream format: COMPRESS_MAGIC, then blocks of up to COMPRESS_BLOCK_SIZE
+// output bytes, each a 32-bit little-endian length (top bit set: stored as is)
+// and that many bytes, then a zero length and the 64-bit little-endian total.
+// Compressed blocks use the LZ4 sequence format (a token of literal and match
+// lengths, literals, a 16-bit offset), and matches may reach back into the
+// COMPRESS_WINDOW_SIZE bytes before the block, so repeated lines compress
+// across block boundaries too.
+#define COMPRESS_MAGIC "PLZ1"
+#define COMPRESS_BLOCK_SIZE 65536
+#define COMPRESS_WINDOW_SIZE 65535
+#define COMPRESS_STORED_FLAG 0x80000000u
+
+typedef struct Compressor Compressor;
+
+// Compresses everything written to it into downstream (which must outlive it)
+Compressor* compressor_create(const OutputSink* downstream);
+void compressor_write(Compressor* compressor, const char* data, size_t length);
+// Compresses what is still buffered, ends the stream and frees the compressor
+void compressor_finish(Compressor* compressor);
+
+// Decodes a whole stream from in to out; reports the first problem (not a
+// stream, damaged or truncated data, a write error) and returns false
+bool decompress_stream(FILE* in, FILE* out);
+
+#endif // COMPRESS_H
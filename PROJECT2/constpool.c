@@ -0,0 +1,184 @@
+#include "constpool.h"
+#include "digest.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Entries per storage chunk; chunks are never reallocated, so entries keep their address
+#define CONSTANT_POOL_CHUNK 256
+// Initial number of hash slots (power of two)
+#define CONSTANT_POOL_INITIAL_SLOTS 256
+
+typedef struct PoolChunk {
+    struct PoolChunk* next;
+    int used;
+    PoolConstant entries[CONSTANT_POOL_CHUNK];
+} PoolChunk;
+
+// An index slot keeps its entry's hash, so growing the index and probing past
+// other entries never rehash or compare their contents
+typedef struct {
+    PoolConstant* entry;      // NULL = empty
+    unsigned long long hash;
+} PoolSlot;
+
+static struct {
+    pthread_mutex_t lock;
+    PoolChunk* chunks;        // Newest first
+    PoolSlot* slots;          // Open-addressing index
+    int slot_capacity;
+    int count;
+} pool = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static unsigned long long hash_bytes(unsigned long long hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL; // FNV-1a prime
+    }
+    return hash;
+}
+
+static unsigned long long hash_integer(const BigInt* value) {
+    unsigned long long hash = hash_bytes(14695981039346656037ULL, &value->sign, sizeof(value->sign));
+    return hash_bytes(hash, value->limbs, sizeof(value->limbs));
+}
+
+static unsigned long long hash_string(const char* text, size_t length) {
+    // Literals can be long, so they take the stripe-at-a-time hash; equality
+    // still checks is_string
+    Digest digest;
+    digest_init(&digest);
+    digest_update(&digest, text, length);
+    return digest_value(&digest);
+}
+
+static bool same_integer(const PoolConstant* entry, const BigInt* value) {
+    return !entry->is_string && entry->value.sign == value->sign &&
+           memcmp(entry->value.limbs, value->limbs, sizeof(value->limbs)) == 0;
+}
+
+static bool same_string(const PoolConstant* entry, const char* text, size_t length) {
+    return entry->is_string && entry->length == length && memcmp(entry->text, text, length) == 0;
+}
+
+static void insert_slot(PoolSlot* slots, int capacity, unsigned long long hash, PoolConstant* entry) {
+    int mask = capacity - 1;
+    int i = (int)(hash & mask);
+    while (slots[i].entry) i = (i + 1) & mask;
+    slots[i].entry = entry;
+    slots[i].hash = hash;
+}
+
+// Keeps the index at most half full
+static void grow_slots_if_needed(void) {
+    if (pool.slots && (pool.count + 1) * 2 <= pool.slot_capacity) return;
+    int capacity = pool.slots ? pool.slot_capacity * 2 : CONSTANT_POOL_INITIAL_SLOTS;
+    PoolSlot* slots = (PoolSlot*)calloc(capacity, sizeof(PoolSlot));
+    if (!slots) {
+        fprintf(stderr, "Memory allocation failed for constant pool index.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < pool.slot_capacity; ++i) {
+        if (pool.slots[i].entry) insert_slot(slots, capacity, pool.slots[i].hash, pool.slots[i].entry);
+    }
+    free(pool.slots);
+    pool.slots = slots;
+    pool.slot_capacity = capacity;
+}
+
+// Claims storage for a new entry and indexes it
+static PoolConstant* add_entry(unsigned long long hash) {
+    if (!pool.chunks || pool.chunks->used == CONSTANT_POOL_CHUNK) {
+        PoolChunk* chunk = (PoolChunk*)malloc(sizeof(PoolChunk));
+        if (!chunk) {
+            fprintf(stderr, "Memory allocation failed for constant pool.\n");
+            exit(EXIT_FAILURE);
+        }
+        chunk->next = pool.chunks;
+        chunk->used = 0;
+        pool.chunks = chunk;
+    }
+    PoolConstant* entry = &pool.chunks->entries[pool.chunks->used++];
+    insert_slot(pool.slots, pool.slot_capacity, hash, entry);
+    pool.count++;
+    return entry;
+}
+
+static char* copy_text(const char* text, size_t length) {
+    char* copy = (char*)malloc(length + 1);
+    if (!copy) {
+        fprintf(stderr, "Memory allocation failed for constant pool text.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+const PoolConstant* constant_pool_integer(const BigInt* value) {
+    unsigned long long hash = hash_integer(value);
+    pthread_mutex_lock(&pool.lock);
+    grow_slots_if_needed();
+    int mask = pool.slot_capacity - 1;
+    for (int i = (int)(hash & mask); pool.slots[i].entry; i = (i + 1) & mask) {
+        if (pool.slots[i].hash == hash && same_integer(pool.slots[i].entry, value)) {
+            pthread_mutex_unlock(&pool.lock);
+            return pool.slots[i].entry;
+        }
+    }
+
+    char str_buffer[MAX_BIGINT_STRING_LEN + 2];
+    big_int_to_string(value, str_buffer);
+    PoolConstant* entry = add_entry(hash);
+    big_int_copy(&entry->value, value);
+    entry->length = strlen(str_buffer);
+    entry->text = copy_text(str_buffer, entry->length);
+    entry->is_string = false;
+    pthread_mutex_unlock(&pool.lock);
+    return entry;
+}
+
+const PoolConstant* constant_pool_string(const char* text, size_t length) {
+    unsigned long long hash = hash_string(text, length);
+    pthread_mutex_lock(&pool.lock);
+    grow_slots_if_needed();
+    int mask = pool.slot_capacity - 1;
+    for (int i = (int)(hash & mask); pool.slots[i].entry; i = (i + 1) & mask) {
+        if (pool.slots[i].hash == hash && same_string(pool.slots[i].entry, text, length)) {
+            pthread_mutex_unlock(&pool.lock);
+            return pool.slots[i].entry;
+        }
+    }
+
+    PoolConstant* entry = add_entry(hash);
+    memset(&entry->value, 0, sizeof(entry->value));
+    entry->text = copy_text(text, length);
+    entry->length = length;
+    entry->is_string = true;
+    pthread_mutex_unlock(&pool.lock);
+    return entry;
+}
+
+int constant_pool_count(void) {
+    pthread_mutex_lock(&pool.lock);
+    int count = pool.count;
+    pthread_mutex_unlock(&pool.lock);
+    return count;
+}
+
+void constant_pool_free(void) {
+    pthread_mutex_lock(&pool.lock);
+    while (pool.chunks) {
+        PoolChunk* next = pool.chunks->next;
+        for (int i = 0; i < pool.chunks->used; ++i) free((void*)pool.chunks->entries[i].text);
+        free(pool.chunks);
+        pool.chunks = next;
+    }
+    free(pool.slots);
+    pool.slots = NULL;
+    pool.slot_capacity = 0;
+    pool.count = 0;
+    pthread_mutex_unlock(&pool.lock);
+}
@@ -0,0 +1,29 @@
+#ifndef CONSTPOOL_H
+#define CONSTPOOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "bigint.h"
+
+// One interned literal. Entries never move or change once created, so AST
+// nodes point at them directly and any thread may read them.
+typedef struct PoolConstant {
+    BigInt value;       // Integer constants only
+    const char* text;   // Decimal text of an integer, or the contents of a string (NUL-terminated)
+    size_t length;      // Bytes in text
+    bool is_string;
+} PoolConstant;
+
+// Return the pool entry for an integer / string literal, adding it on first
+// sight. Every occurrence of the same literal shares one entry, so equal
+// constants compare equal by pointer. Safe to call from several threads.
+const PoolConstant* constant_pool_integer(const BigInt* value);
+const PoolConstant* constant_pool_string(const char* text, size_t length);
+
+// Number of distinct constants interned so far
+int constant_pool_count(void);
+
+// Releases every entry; no AST referencing the pool may be used afterwards
+void constant_pool_free(void);
+
+#endif // CONSTPOOL_H
@@ -0,0 +1,114 @@
+#include "digest.h"
+#include <string.h>
+
+#define PRIME1 0x9E3779B185EBCA87ULL
+#define PRIME2 0xC2B2AE3D27D4EB4FULL
+#define PRIME3 0x165667B19E3779F9ULL
+#define PRIME4 0x85EBCA77C2B2AE63ULL
+#define PRIME5 0x27D4EB2F165667C5ULL
+
+static uint64_t rotl64(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Reads little-endian, whatever the host order
+static uint64_t read64(const unsigned char* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) value = (value << 8) | p[i];
+    return value;
+}
+
+static uint32_t read32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t round64(uint64_t lane, uint64_t input) {
+    lane += input * PRIME2;
+    return rotl64(lane, 31) * PRIME1;
+}
+
+static uint64_t merge_round(uint64_t hash, uint64_t lane) {
+    hash ^= round64(0, lane);
+    return hash * PRIME1 + PRIME4;
+}
+
+static void consume_stripes(Digest* digest, const unsigned char* p, size_t stripes) {
+    uint64_t l0 = digest->lanes[0], l1 = digest->lanes[1], l2 = digest->lanes[2], l3 = digest->lanes[3];
+    for (size_t i = 0; i < stripes; ++i, p += 32) {
+        l0 = round64(l0, read64(p));
+        l1 = round64(l1, read64(p + 8));
+        l2 = round64(l2, read64(p + 16));
+        l3 = round64(l3, read64(p + 24));
+    }
+    digest->lanes[0] = l0;
+    digest->lanes[1] = l1;
+    digest->lanes[2] = l2;
+    digest->lanes[3] = l3;
+}
+
+void digest_init(Digest* digest) {
+    digest->total = 0;
+    digest->lanes[0] = PRIME1 + PRIME2;
+    digest->lanes[1] = PRIME2;
+    digest->lanes[2] = 0;
+    digest->lanes[3] = 0 - PRIME1;
+    digest->buffered = 0;
+}
+
+void digest_update(Digest* digest, const void* data, size_t length) {
+    const unsigned char* p = (const unsigned char*)data;
+    digest->total += length;
+    if (digest->buffered + length < 32) {
+        memcpy(digest->buffer + digest->buffered, p, length);
+        digest->buffered += length;
+        return;
+    }
+    if (digest->buffered > 0) {
+        size_t fill = 32 - digest->buffered;
+        memcpy(digest->buffer + digest->buffered, p, fill);
+        consume_stripes(digest, digest->buffer, 1);
+        p += fill;
+        length -= fill;
+        digest->buffered = 0;
+    }
+    consume_stripes(digest, p, length / 32);
+    p += length / 32 * 32;
+    digest->buffered = length % 32;
+    memcpy(digest->buffer, p, digest->buffered);
+}
+
+uint64_t digest_value(const Digest* digest) {
+    uint64_t hash;
+    if (digest->total >= 32) {
+        const uint64_t* l = digest->lanes;
+        hash = rotl64(l[0], 1) + rotl64(l[1], 7) + rotl64(l[2], 12) + rotl64(l[3], 18);
+        for (int i = 0; i < 4; ++i) hash = merge_round(hash, l[i]);
+    } else {
+        hash = PRIME5; // lanes[2] holds the seed, 0
+    }
+    hash += digest->total;
+
+    const unsigned char* p = digest->buffer;
+    size_t remaining = digest->buffered;
+    for (; remaining >= 8; remaining -= 8, p += 8) {
+        hash ^= round64(0, read64(p));
+        hash = rotl64(hash, 27) * PRIME1 + PRIME4;
+    }
+    if (remaining >= 4) {
+        hash ^= (uint64_t)read32(p) * PRIME1;
+        hash = rotl64(hash, 23) * PRIME2 + PRIME3;
+        p += 4;
+        remaining -= 4;
+    }
+    for (; remaining > 0; --remaining, ++p) {
+        hash ^= (uint64_t)*p * PRIME5;
+        hash = rotl64(hash, 11) * PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
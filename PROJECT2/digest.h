@@ -0,0 +1,23 @@
+#ifndef DIGEST_H
+#define DIGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming XXH64 (seed 0), so digests match the xxhsum tool's -H64 output
+// for the same bytes. Its four independent accumulators each take 8 bytes of
+// every 32-byte stripe, which keeps the multipliers of a stripe in flight at
+// once.
+typedef struct {
+    uint64_t total;        // Bytes hashed so far
+    uint64_t lanes[4];
+    unsigned char buffer[32]; // Bytes that do not yet fill a stripe
+    size_t buffered;
+} Digest;
+
+void digest_init(Digest* digest);
+void digest_update(Digest* digest, const void* data, size_t length);
+// The hash of everything added so far (the state may keep growing after)
+uint64_t digest_value(const Digest* digest);
+
+#endif // DIGEST_H
@@ -0,0 +1,323 @@
+#include "incremental.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Statements produced by one reparse, handed over by the driver callback
+typedef struct {
+    ASTNode** statements;
+    StatementSpan* spans;
+    int count;
+    int capacity;
+
+    int statement_start;                    // Offset where the statement being parsed began
+    int prev_token_end;                     // Offset just past the last token fed before the lookahead
+    SourceLocation prev_token_end_location;
+
+    // Resynchronization with the spans from before the edit
+    const StatementSpan* old_spans;         // NULL for a full parse
+    int old_first;                          // First old statement the edit may have touched
+    int old_count;
+    int edit_end;                           // First byte after the inserted text
+    int delta;                              // Offset change for text after the edit
+    int resync_index;                       // Old statement whose end the new stream reached, or -1
+} ReparseState;
+
+// Finds the old statement ending exactly at 'end', or -1. Old spans are sorted by end.
+static int find_span_ending_at(const StatementSpan* spans, int first, int count, int end) {
+    int lo = first, hi = count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (spans[mid].end == end) return mid;
+        if (spans[mid].end < end) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+static void collect_statement(ASTNode* statement, void* user_data) {
+    ReparseState* state = (ReparseState*)user_data;
+    if (state->count >= state->capacity) {
+        state->capacity = state->capacity == 0 ? 16 : state->capacity * 2;
+        state->statements = (ASTNode**)realloc(state->statements, state->capacity * sizeof(ASTNode*));
+        state->spans = (StatementSpan*)realloc(state->spans, state->capacity * sizeof(StatementSpan));
+        if (!state->statements || !state->spans) {
+            fprintf(stderr, "Memory allocation failed for reparsed statements.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    StatementSpan* span = &state->spans[state->count];
+    span->start = state->statement_start;
+    span->end = state->prev_token_end;
+    span->end_location = state->prev_token_end_location;
+    state->statements[state->count++] = statement;
+    state->statement_start = state->prev_token_end; // The lookahead begins the next statement
+
+    // Past the edit, the rest of the text is unchanged. Landing on an old boundary
+    // means the lexer and the LR stack are exactly where they were before, so the
+    // remaining statements would parse identically.
+    if (state->old_spans && span->end >= state->edit_end) {
+        state->resync_index = find_span_ending_at(state->old_spans, state->old_first, state->old_count,
+                                                  span->end - state->delta);
+    }
+}
+
+// Moves a reused subtree from before the edit to its place after it. Only
+// nodes on the boundary line have their columns moved.
+static void shift_locations(ASTNode* node, const SourceLocation* from, const SourceLocation* to) {
+    if (!node) return;
+    if (node->location.line == from->line) {
+        node->location.column += to->column - from->column;
+    }
+    node->location.line += to->line - from->line;
+    node->location.offset += to->offset - from->offset;
+    for (int i = 0; i < node->num_children; ++i) {
+        shift_locations(node->children[i], from, to);
+    }
+    if (node->type == AST_LOOP_STATEMENT) {
+        shift_locations(node->data.loop.count_expr, from, to);
+        shift_locations(node->data.loop.body, from, to);
+    }
+}
+
+static void ensure_statement_capacity(IncrementalParser* ip, ASTNode* list, int needed) {
+    if (needed <= list->children_capacity && needed <= ip->span_capacity) return;
+    int new_capacity = list->children_capacity > 16 ? list->children_capacity : 16;
+    while (new_capacity < needed) new_capacity *= 2;
+    list->children = (ASTNode**)realloc(list->children, new_capacity * sizeof(ASTNode*));
+    ip->spans = (StatementSpan*)realloc(ip->spans, new_capacity * sizeof(StatementSpan));
+    if (!list->children || !ip->spans) {
+        fprintf(stderr, "Memory allocation failed for incremental statement list.\n");
+        exit(EXIT_FAILURE);
+    }
+    list->children_capacity = new_capacity;
+    ip->span_capacity = new_capacity;
+}
+
+// Re-lexes and re-parses from the boundary before statement 'first' until the
+// token stream resynchronizes with an old boundary (or the input ends), then
+// splices the new statements over the ones they replace.
+static bool reparse(IncrementalParser* ip, int first, int edit_end, int delta) {
+    ASTNode* list = ip->program ? ip->program->children[0] : NULL;
+    int old_count = list ? list->num_children : 0;
+
+    SourceLocation restart;
+    if (first > 0) {
+        restart = ip->spans[first - 1].end_location;
+    } else {
+        restart = (SourceLocation){ .line = 1, .column = 0, .offset = 0, .filename = ip->filename };
+    }
+    lexer_set_input_string(ip->lex, ip->text + restart.offset, ip->length - (size_t)restart.offset);
+    ip->lex->location = restart;
+
+    ReparseState state = {0};
+    state.statement_start = restart.offset;
+    state.prev_token_end = restart.offset;
+    state.prev_token_end_location = restart;
+    state.old_spans = list ? ip->spans : NULL;
+    state.old_first = first;
+    state.old_count = old_count;
+    state.edit_end = edit_end;
+    state.delta = delta;
+    state.resync_index = -1;
+
+    LRParser parser;
+    lr_parser_init(&parser, ip->grammar);
+    parser.on_statement = collect_statement;
+    parser.statement_user_data = &state;
+    parser.detach_statements = true;
+    if (first > 0) {
+        // The stack at every top-level boundary: state 0 under the StatementList goto.
+        // An empty list stands in for the statements before the checkpoint.
+        StackEntry boundary[2] = {
+            { .state = 0, .ast_node = NULL },
+            { .state = goto_table[0][NT_STATEMENT_LIST], .ast_node = create_ast_node(AST_STATEMENT_LIST, restart) }
+        };
+        lr_parser_restore(&parser, boundary, 2);
+    }
+
+    ParseStatus status = PARSE_STATUS_CONTINUE;
+    while (status == PARSE_STATUS_CONTINUE && state.resync_index < 0) {
+        Token token = get_next_token(ip->lex);
+        if (token.type == TOKEN_ERROR) {
+            status = PARSE_STATUS_ERROR; // The lexer has already reported the problem
+            break;
+        }
+        status = lr_parser_feed(&parser, &token);
+        state.prev_token_end = ip->lex->location.offset;
+        state.prev_token_end_location = ip->lex->location;
+        if (status == PARSE_STATUS_CONTINUE && token.type == TOKEN_EOF) {
+            fprintf(stderr, "Parser Error: Unexpected end of input.\n");
+            status = PARSE_STATUS_ERROR;
+        }
+    }
+    if (status == PARSE_STATUS_ACCEPT) {
+        free_ast_node(parser.result); // Statements were detached; only the program shell is left
+        parser.result = NULL;
+    }
+    lr_parser_free(&parser);
+
+    if (status == PARSE_STATUS_ERROR) {
+        for (int i = 0; i < state.count; ++i) {
+            free_ast_node(state.statements[i]);
+        }
+        free(state.statements);
+        free(state.spans);
+        return false;
+    }
+
+    if (!list) {
+        SourceLocation start = state.count > 0 ? state.statements[0]->location : restart;
+        ip->program = create_ast_node(AST_PROGRAM, start);
+        list = create_ast_node(AST_STATEMENT_LIST, start);
+        add_child_to_ast_node(ip->program, list);
+    }
+
+    // Old statements [first, replaced_end) give way to the new ones; the rest are reused
+    int replaced_end = state.resync_index >= 0 ? state.resync_index + 1 : old_count;
+    int tail = old_count - replaced_end;
+    if (tail > 0) {
+        SourceLocation from = ip->spans[replaced_end - 1].end_location;
+        SourceLocation to = state.spans[state.count - 1].end_location;
+        for (int i = replaced_end; i < old_count; ++i) {
+            shift_locations(list->children[i], &from, &to);
+            ip->spans[i].start += delta;
+            ip->spans[i].end += delta;
+            if (ip->spans[i].end_location.line == from.line) {
+                ip->spans[i].end_location.column += to.column - from.column;
+            }
+            ip->spans[i].end_location.line += to.line - from.line;
+            ip->spans[i].end_location.offset += delta;
+        }
+    }
+    for (int i = first; i < replaced_end; ++i) {
+        free_ast_node(list->children[i]);
+    }
+
+    int new_count = first + state.count + tail;
+    ensure_statement_capacity(ip, list, new_count);
+    memmove(&list->children[first + state.count], &list->children[replaced_end], tail * sizeof(ASTNode*));
+    memmove(&ip->spans[first + state.count], &ip->spans[replaced_end], tail * sizeof(StatementSpan));
+    memcpy(&list->children[first], state.statements, state.count * sizeof(ASTNode*));
+    memcpy(&ip->spans[first], state.spans, state.count * sizeof(StatementSpan));
+    for (int i = first; i < first + state.count; ++i) {
+        ip->spans[i].id = ip->next_id++;
+    }
+    list->num_children = new_count;
+    if (first == 0 && new_count > 0) {
+        list->location = list->children[0]->location;
+        ip->program->location = list->location;
+    }
+
+    ip->last_reparsed = state.count;
+    ip->last_reused = first + tail;
+    free(state.statements);
+    free(state.spans);
+    return true;
+}
+
+// Replaces removed bytes at offset with the given data, growing the buffer if needed
+static void splice_text(char** text, size_t* length, size_t* capacity,
+                        size_t offset, size_t removed, const char* data, size_t data_length) {
+    size_t new_length = *length - removed + data_length;
+    if (new_length > *capacity || !*text) {
+        *capacity = new_length > 0 ? new_length * 2 : 64;
+        *text = (char*)realloc(*text, *capacity);
+        if (!*text) {
+            fprintf(stderr, "Memory allocation failed for incremental parser text.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memmove(*text + offset + data_length, *text + offset + removed, *length - offset - removed);
+    memcpy(*text + offset, data, data_length);
+    *length = new_length;
+}
+
+// Reparses the current text as one edit of the last text that parsed
+static bool reparse_edit(IncrementalParser* ip, size_t offset, size_t removed, size_t inserted_length) {
+    if (!ip->program) {
+        return reparse(ip, 0, 0, 0); // Nothing has parsed yet: no boundaries to start from
+    }
+
+    // First statement whose tokens reach past the edit point. Statements end with
+    // ';' or '}', which never merge with following text, so the one before is safe.
+    ASTNode* list = ip->program->children[0];
+    int lo = 0, hi = list->num_children;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if ((size_t)ip->spans[mid].end > offset) hi = mid;
+        else lo = mid + 1;
+    }
+    return reparse(ip, lo, (int)(offset + inserted_length), (int)inserted_length - (int)removed);
+}
+
+IncrementalParser* incremental_parser_create(const Grammar* grammar, const char* text, size_t length, const char* filename) {
+    IncrementalParser* ip = (IncrementalParser*)calloc(1, sizeof(IncrementalParser));
+    LexContext* lex = (LexContext*)malloc(sizeof(LexContext));
+    if (!ip || !lex) {
+        fprintf(stderr, "Memory allocation failed for incremental parser.\n");
+        free(ip);
+        free(lex);
+        return NULL;
+    }
+    init_lexer(lex, NULL, filename);
+    ip->grammar = grammar;
+    ip->filename = filename;
+    ip->lex = lex;
+    splice_text(&ip->text, &ip->length, &ip->capacity, 0, 0, text, length);
+
+    ip->valid = reparse(ip, 0, 0, 0);
+    if (ip->valid) {
+        splice_text(&ip->parsed_text, &ip->parsed_length, &ip->parsed_capacity, 0, 0, text, length);
+    }
+    return ip;
+}
+
+bool incremental_parser_edit(IncrementalParser* ip, size_t offset, size_t removed, const char* inserted, size_t inserted_length) {
+    if (offset > ip->length || removed > ip->length - offset) {
+        fprintf(stderr, "Edit range %zu+%zu is outside the %zu-byte document.\n", offset, removed, ip->length);
+        return false;
+    }
+    splice_text(&ip->text, &ip->length, &ip->capacity, offset, removed, inserted, inserted_length);
+
+    if (ip->valid) {
+        ip->valid = reparse_edit(ip, offset, removed, inserted_length);
+        if (ip->valid) {
+            splice_text(&ip->parsed_text, &ip->parsed_length, &ip->parsed_capacity, offset, removed, inserted, inserted_length);
+        }
+        return ip->valid;
+    }
+
+    // The AST still describes the last text that parsed. Treat everything typed
+    // since then as a single edit of that text, so a broken intermediate state
+    // does not cost a full reparse (or new statement identities) once it is fixed.
+    size_t limit = ip->length < ip->parsed_length ? ip->length : ip->parsed_length;
+    size_t prefix = 0;
+    while (prefix < limit && ip->text[prefix] == ip->parsed_text[prefix]) prefix++;
+    size_t suffix = 0;
+    while (suffix < limit - prefix &&
+           ip->text[ip->length - 1 - suffix] == ip->parsed_text[ip->parsed_length - 1 - suffix]) {
+        suffix++;
+    }
+    ip->valid = reparse_edit(ip, prefix, ip->parsed_length - prefix - suffix, ip->length - prefix - suffix);
+    if (ip->valid) {
+        ip->parsed_length = 0;
+        splice_text(&ip->parsed_text, &ip->parsed_length, &ip->parsed_capacity, 0, 0, ip->text, ip->length);
+    }
+    return ip->valid;
+}
+
+ASTNode* incremental_parser_program(const IncrementalParser* ip) {
+    return ip->valid ? ip->program : NULL;
+}
+
+void incremental_parser_free(IncrementalParser* ip) {
+    if (!ip) return;
+    free_ast_node(ip->program);
+    free(ip->spans);
+    free(ip->text);
+    free(ip->parsed_text);
+    free_lex_context(ip->lex);
+    free(ip->lex);
+    free(ip);
+}
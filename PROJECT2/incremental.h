@@ -0,0 +1,58 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "lexer.h"
+#include "parser.h"
+
+// Source range covered by one top-level statement
+typedef struct {
+    int start;                   // Byte offset where lexing of the statement began
+    int end;                     // Byte offset just past its last token
+    SourceLocation end_location; // Line/column just past its last token
+    unsigned long id;            // Stable identity: kept while the statement is reused across edits
+} StatementSpan;
+
+// An editable document whose AST is kept up to date across edits. Top-level
+// statement boundaries are the checkpoints: there the LR stack is always
+// [0, goto(0, StatementList)] and the lexer is back in its start state, so an
+// edit only re-lexes and re-parses from the statement it touches until the
+// new token stream lines up with an old boundary again.
+typedef struct {
+    const Grammar* grammar;
+    const char* filename;
+
+    char* text;                  // Current source text (not NUL-terminated)
+    size_t length;
+    size_t capacity;
+    char* parsed_text;           // Last text that parsed; program and spans describe it
+    size_t parsed_length;
+    size_t parsed_capacity;
+    bool valid;                  // Whether the current text parsed (text == parsed_text)
+
+    LexContext* lex;             // Persistent, so symbol table indices stay stable
+    ASTNode* program;            // AST_PROGRAM -> AST_STATEMENT_LIST of parsed_text, NULL until something parses
+    StatementSpan* spans;        // One per statement in the program's statement list
+    int span_capacity;
+
+    unsigned long next_id;       // Identity handed to the next freshly parsed statement
+    int last_reparsed;           // Statements re-parsed by the most recent update
+    int last_reused;             // Statements carried over unchanged by the most recent update
+} IncrementalParser;
+
+// Parses the initial text. The parsing tables must already be built.
+// Returns NULL only on allocation failure; check incremental_parser_program()
+// for syntax errors.
+IncrementalParser* incremental_parser_create(const Grammar* grammar, const char* text, size_t length, const char* filename);
+
+// Replaces removed bytes at offset with inserted bytes and brings the AST up to
+// date. Returns false if the edit is out of range or the new text does not parse.
+bool incremental_parser_edit(IncrementalParser* ip, size_t offset, size_t removed, const char* inserted, size_t inserted_length);
+
+// AST of the current text, or NULL if it does not parse. Owned by the session.
+ASTNode* incremental_parser_program(const IncrementalParser* ip);
+
+void incremental_parser_free(IncrementalParser* ip);
+
+#endif // INCREMENTAL_H
@@ -0,0 +1,191 @@
+#include "input.h"
+#include "interpreter.h"
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define INPUT_HAVE_SSE2_PATH 1
+#endif
+
+// Digits a uint64_t always holds (10^19 - 1 < 2^64)
+#define INPUT_NATIVE_DIGITS 19
+
+static int input_fd = -1;          // -1 while unbound
+static bool input_owned = false;   // Opened by input_bind_file (stdin is not)
+static bool input_at_eof = false;  // Nothing is left to pull into the buffer
+static char buffer[INPUT_BUFFER_SIZE];
+static size_t position = 0;        // Next unread byte
+static size_t length = 0;          // Bytes in buffer
+
+static bool is_separator(char c) {
+    return c == ' ' || c == ',' || (c >= '\t' && c <= '\r');
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// --- Scanning (16 bytes at a time with SSE2) ---
+
+// Number of separators at the start of p[0..n)
+static size_t separator_run(const char* p, size_t n) {
+    size_t i = 0;
+#ifdef INPUT_HAVE_SSE2_PATH
+    const __m128i space = _mm_set1_epi8(' '), comma = _mm_set1_epi8(',');
+    const __m128i below_tab = _mm_set1_epi8('\t' - 1), above_cr = _mm_set1_epi8('\r' + 1);
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(p + i));
+        // Bytes >= 0x80 compare as negative, so they are never in '\t'..'\r'
+        __m128i control = _mm_and_si128(_mm_cmpgt_epi8(c, below_tab), _mm_cmplt_epi8(c, above_cr));
+        __m128i separator = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, space), _mm_cmpeq_epi8(c, comma)), control);
+        unsigned int other = ~(unsigned int)_mm_movemask_epi8(separator) & 0xFFFF;
+        if (other) return i + __builtin_ctz(other);
+    }
+#endif
+    while (i < n && is_separator(p[i])) i++;
+    return i;
+}
+
+// Number of decimal digits at the start of p[0..n)
+static size_t digit_run(const char* p, size_t n) {
+    size_t i = 0;
+#ifdef INPUT_HAVE_SSE2_PATH
+    const __m128i below_zero = _mm_set1_epi8('0' - 1), above_nine = _mm_set1_epi8('9' + 1);
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, below_zero), _mm_cmplt_epi8(c, above_nine));
+        unsigned int other = ~(unsigned int)_mm_movemask_epi8(digit) & 0xFFFF;
+        if (other) return i + __builtin_ctz(other);
+    }
+#endif
+    while (i < n && is_digit(p[i])) i++;
+    return i;
+}
+
+// --- Conversion ---
+
+// Value of the 8 digits at p, combined pairwise inside one 64-bit word
+static uint64_t eight_digits(const char* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t chunk;
+    memcpy(&chunk, p, sizeof(chunk)); // First digit in the lowest byte
+    chunk -= 0x3030303030303030ULL;
+    chunk = chunk * 10 + (chunk >> 8); // Two-digit values in bytes 0, 2, 4 and 6
+    chunk = ((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)) +
+             ((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))) >> 32;
+    return chunk;
+#else
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) value = value * 10 + (uint64_t)(p[i] - '0');
+    return value;
+#endif
+}
+
+static uint64_t native_digits(const char* p, size_t count) {
+    uint64_t value = 0;
+    size_t i = 0;
+    for (; i < count % 8; ++i) value = value * 10 + (uint64_t)(p[i] - '0');
+    for (; i < count; i += 8) value = value * 100000000ULL + eight_digits(p + i);
+    return value;
+}
+
+// --- Buffering ---
+
+// Moves the unread bytes to the front and appends more; false at end of input
+static bool refill(void) {
+    if (input_at_eof) return false;
+    memmove(buffer, buffer + position, length - position);
+    length -= position;
+    position = 0;
+    ssize_t n;
+    while ((n = read(input_fd, buffer + length, INPUT_BUFFER_SIZE - length)) < 0) {
+        if (errno != EINTR) break;
+    }
+    if (n <= 0) {
+        input_at_eof = true;
+        return false;
+    }
+    length += (size_t)n;
+    return true;
+}
+
+// Consumes the rest of a token that is not a valid integer
+static void skip_token(void) {
+    do {
+        while (position < length && !is_separator(buffer[position])) position++;
+    } while (position == length && refill());
+}
+
+static void reset_buffer(void) {
+    position = 0;
+    length = 0;
+    input_at_eof = false;
+}
+
+// --- Binding ---
+
+bool input_bind_file(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    input_unbind();
+    input_fd = fd;
+    input_owned = true;
+    return true;
+}
+
+void input_bind_stdin(void) {
+    input_unbind();
+    input_fd = STDIN_FILENO;
+}
+
+void input_unbind(void) {
+    if (input_owned) close(input_fd);
+    input_fd = -1;
+    input_owned = false;
+    reset_buffer();
+}
+
+bool input_rewind(void) {
+    if (!input_owned || lseek(input_fd, 0, SEEK_SET) != 0) return false;
+    reset_buffer();
+    return true;
+}
+
+InputStatus input_read_integer(BigInt* out) {
+    if (input_fd < 0) return INPUT_UNBOUND;
+    for (;;) {
+        position += separator_run(buffer + position, length - position);
+        if (position < length) break;
+        if (!refill()) return INPUT_END;
+    }
+
+    // Offsets are relative to position, which a refill moves to the front
+    size_t sign = buffer[position] == '-' ? 1 : 0;
+    size_t digits = digit_run(buffer + position + sign, length - position - sign);
+    while (position + sign + digits == length && digits <= MAX_BIGINT_LITERAL_DIGITS && refill()) {
+        digits += digit_run(buffer + position + sign + digits, length - position - sign - digits);
+    }
+    size_t end = position + sign + digits;
+    if (digits == 0 || digits > MAX_BIGINT_LITERAL_DIGITS || (end < length && !is_separator(buffer[end]))) {
+        position = end;
+        skip_token();
+        return INPUT_MALFORMED;
+    }
+
+    const char* text = buffer + position + sign;
+    if (digits <= INPUT_NATIVE_DIGITS) {
+        big_int_zero(out);
+        out->limbs[0] = native_digits(text, digits);
+        out->sign = sign && out->limbs[0] != 0 ? -1 : 1;
+    } else {
+        char literal[MAX_BIGINT_STRING_LEN];
+        memcpy(literal, buffer + position, sign + digits);
+        literal[sign + digits] = '\0';
+        big_int_from_string(out, literal);
+    }
+    position = end;
+    return INPUT_OK;
+}
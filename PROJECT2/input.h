@@ -0,0 +1,33 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "bigint.h"
+
+// Bytes pulled from the input file per read
+#define INPUT_BUFFER_SIZE (64 * 1024)
+
+typedef enum {
+    INPUT_OK,         // An integer was stored
+    INPUT_END,        // Only separators were left
+    INPUT_MALFORMED,  // The next token is not a decimal integer of at most MAX_BIGINT_LITERAL_DIGITS digits; it is skipped
+    INPUT_UNBOUND     // No input source is bound
+} InputStatus;
+
+// Integers consumed by read statements: decimal numbers with an optional
+// leading '-', separated by whitespace or commas. Only the interpreter's
+// thread reads, so the state is process-wide.
+// Binds a file; false if it cannot be opened (the previous binding is kept)
+bool input_bind_file(const char* path);
+// Binds stdin (not rewindable, never closed)
+void input_bind_stdin(void);
+// Drops the binding; reads report INPUT_UNBOUND afterwards
+void input_unbind(void);
+// Restarts a bound file from its first byte, so each run of a program sees the
+// same input; false for stdin
+bool input_rewind(void);
+// Parses the next integer into out (left untouched unless INPUT_OK)
+InputStatus input_read_integer(BigInt* out);
+
+#endif // INPUT_H
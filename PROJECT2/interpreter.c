@@ -1,396 +1,1598 @@
-#include "interpreter.h" // Include its own header
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdbool.h>
-
-// Global or passed-around runtime symbol table instance
-static RuntimeSymbolTable global_runtime_sym_table;
-
-// Forward declarations for interpret functions for different AST node types (internal to this file)
-static void interpret_statement_list(ASTNode* node);
-static void interpret_statement(ASTNode* node); // Forward declaration for interpret_statement
-static void interpret_declaration(ASTNode* node);
-static void interpret_assignment(ASTNode* node);
-static void interpret_increment(ASTNode* node);
-static void interpret_decrement(ASTNode* node);
-static void interpret_write_statement(ASTNode* node);
-static void interpret_loop_statement(ASTNode* node);
-static void interpret_code_block(ASTNode* node);
-// Changed return type and parameter type to BigInt for evaluation
-static void evaluate_big_int_value(ASTNode* node, BigInt* result);
-
-
-
-
-// --- Runtime Symbol Table (Environment) Implementations ---
-
-void init_runtime_symbol_table(RuntimeSymbolTable* table) {
-    table->entries = NULL;
-    table->count = 0;
-    table->capacity = 0;
-}
-
-// Changed value to const BigInt*
-void add_or_update_runtime_symbol(RuntimeSymbolTable* table, const char* name, const BigInt* value) {
-    // Check if symbol already exists, then update
-    for (int i = 0; i < table->count; ++i) {
-        if (strcmp(table->entries[i].name, name) == 0) {
-            // Update the existing BigInt value
-            big_int_copy(&table->entries[i].value, value); // Use your BigInt copy function
-            return;
-        }
-    }
-
-    // Symbol does not exist, add new entry
-    if (table->count >= table->capacity) {
-        // Double capacity or set to a default if currently 0
-        table->capacity = (table->capacity == 0) ? 4 : table->capacity * 2;
-        table->entries = (RuntimeSymbolEntry*)realloc(table->entries, table->capacity * sizeof(RuntimeSymbolEntry));
-        if (!table->entries) {
-            fprintf(stderr, "Memory allocation failed for runtime symbol table.\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    table->entries[table->count].name = strdup(name); // Duplicate string for ownership
-    if (!table->entries[table->count].name) {
-        fprintf(stderr, "Memory allocation failed for symbol name.\n");
-        exit(EXIT_FAILURE);
-    }
-    // Copy the BigInt value to the new entry
-    big_int_copy(&table->entries[table->count].value, value); // Use your BigInt copy function
-    table->count++;
-}
-
-// Changed out_value to BigInt*
-bool lookup_runtime_symbol(RuntimeSymbolTable* table, const char* name, BigInt* out_value) {
-    for (int i = 0; i < table->count; ++i) {
-        if (strcmp(table->entries[i].name, name) == 0) {
-            if (out_value) {
-                big_int_copy(out_value, &table->entries[i].value); // Copy the BigInt value
-            }
-            return true;
-        }
-    }
-    return false;
-}
-
-void free_runtime_symbol_table(RuntimeSymbolTable* table) {
-    for (int i = 0; i < table->count; ++i) {
-        free(table->entries[i].name); // Free duplicated names
-        // No need to free BigInt.value as it's stored by value, not pointer.
-    }
-    free(table->entries); // Free the array itself
-    table->entries = NULL;
-    table->count = 0;
-    table->capacity = 0;
-}
-
-// --- Interpreter Logic Implementations ---
-
-// Main interpretation entry point (defined here, declared in interpreter.h)
-void interpret_program(ASTNode* root_node) {
-    // The root node should be of type AST_PROGRAM.
-    // Its first child is the StatementList.
-    if (!root_node || root_node->type != AST_PROGRAM || root_node->num_children != 1 ||
-        root_node->children[0]->type != AST_STATEMENT_LIST) {
-        fprintf(stderr, "Interpreter Error: Invalid AST root node. Expected AST_PROGRAM with a StatementList child.\n");
-        return;
-    }
-
-    init_runtime_symbol_table(&global_runtime_sym_table);
-
-    printf("\n--- Starting Program Execution ---\n");
-
-    // The PROGRAM node has a single child: the STATEMENT_LIST
-    interpret_statement_list(root_node->children[0]);
-
-    printf("\n--- Program Execution Finished ---\n");
-
-    free_runtime_symbol_table(&global_runtime_sym_table);
-}
-
-
-static void interpret_statement_list(ASTNode* node) {
-    if (!node || node->type != AST_STATEMENT_LIST) {
-        fprintf(stderr, "Interpreter Error: Invalid AST_STATEMENT_LIST node structure.\n");
-        return;
-    }
-
-    for (int i = 0; i < node->num_children; ++i) {
-        interpret_statement(node->children[i]);
-    }
-}
-
-static void interpret_statement(ASTNode* node) {
-    if (!node) {
-        fprintf(stderr, "Interpreter Error: NULL statement node.\n");
-        return;
-    }
-
-    switch (node->type) {
-        case AST_DECLARATION:
-            interpret_declaration(node);
-            break;
-        case AST_ASSIGNMENT:
-            interpret_assignment(node);
-            break;
-        case AST_INCREMENT:
-            interpret_increment(node);
-            break;
-        case AST_DECREMENT:
-            interpret_decrement(node);
-            break;
-        case AST_WRITE_STATEMENT:
-            interpret_write_statement(node);
-            break;
-        case AST_LOOP_STATEMENT:
-            interpret_loop_statement(node);
-            break;
-        // AST_STATEMENT_LIST is handled by interpret_statement_list
-        // AST_PROGRAM is handled by interpret_program
-        // Other types are not expected as top-level statements
-        default:
-            fprintf(stderr, "Interpreter Error: Unexpected AST node type for a statement: %d\n", node->type);
-            break;
-    }
-}
-
-
-static void interpret_declaration(ASTNode* node) {
-    if (!node || node->type != AST_DECLARATION || node->num_children != 1 ||
-        node->children[0]->type != AST_IDENTIFIER) {
-        fprintf(stderr, "Interpreter Error: Invalid AST_DECLARATION node structure.\n");
-        return;
-    }
-
-    char* var_name = node->children[0]->data.identifier.name;
-    BigInt dummy_lookup; // Dummy for lookup, we only care if it exists
-
-    // Check if the variable is already declared
-    if (lookup_runtime_symbol(&global_runtime_sym_table, var_name, &dummy_lookup)) {
-        fprintf(stderr, "Runtime Error: Variable '%s' already declared at line %d, column %d.\n",
-                var_name, node->location.line, node->location.column);
-        return; // Stop processing this declaration
-    }
-
-    // Declare with default value 0 (as BigInt)
-    BigInt zero_val;
-    big_int_zero(&zero_val);
-    add_or_update_runtime_symbol(&global_runtime_sym_table, var_name, &zero_val);
-    printf("[DEBUG] Declared variable '%s' with initial value 0.\n", var_name);
-}
-
-static void interpret_assignment(ASTNode* node) {
-    if (!node || node->type != AST_ASSIGNMENT || node->num_children != 2 ||
-        node->children[0]->type != AST_IDENTIFIER || node->children[1]->type != AST_INT_VALUE) {
-        fprintf(stderr, "Interpreter Error: Invalid AST_ASSIGNMENT node structure.\n");
-        return;
-    }
-
-    char* var_name = node->children[0]->data.identifier.name;
-    BigInt value_to_assign; // Result of evaluation
-    evaluate_big_int_value(node->children[1], &value_to_assign);
-
-    BigInt dummy_lookup; // Dummy for lookup, if we only care if it exists
-    if (lookup_runtime_symbol(&global_runtime_sym_table, var_name, &dummy_lookup)) {
-        add_or_update_runtime_symbol(&global_runtime_sym_table, var_name, &value_to_assign);
-        printf("[DEBUG] Assigned '%s' := ", var_name);
-        big_int_print(&value_to_assign);
-        printf(".\n");
-    } else {
-        fprintf(stderr, "Runtime Error: Undeclared variable '%s' in assignment at line %d, column %d.\n",
-                var_name, node->location.line, node->location.column);
-    }
-}
-
-static void interpret_increment(ASTNode* node) {
-    if (!node || node->type != AST_INCREMENT || node->num_children != 2 ||
-        node->children[0]->type != AST_IDENTIFIER || node->children[1]->type != AST_INT_VALUE) {
-        fprintf(stderr, "Interpreter Error: Invalid AST_INCREMENT node structure.\n");
-        return;
-    }
-
-    char* var_name = node->children[0]->data.identifier.name;
-    BigInt increment_val;
-    evaluate_big_int_value(node->children[1], &increment_val);
-
-    BigInt current_value;
-    BigInt new_value;
-
-    if (lookup_runtime_symbol(&global_runtime_sym_table, var_name, &current_value)) {
-        big_int_add(&new_value, &current_value, &increment_val);
-        add_or_update_runtime_symbol(&global_runtime_sym_table, var_name, &new_value);
-        printf("[DEBUG] Incremented '%s' by ", var_name);
-        big_int_print(&increment_val);
-        printf(". New value: ");
-        big_int_print(&new_value);
-        printf(".\n");
-    } else {
-        fprintf(stderr, "Runtime Error: Undeclared variable '%s' in increment at line %d, column %d.\n",
-                var_name, node->location.line, node->location.column);
-    }
-}
-
-static void interpret_decrement(ASTNode* node) {
-    if (!node || node->type != AST_DECREMENT || node->num_children != 2 ||
-        node->children[0]->type != AST_IDENTIFIER || node->children[1]->type != AST_INT_VALUE) {
-        fprintf(stderr, "Interpreter Error: Invalid AST_DECREMENT node structure.\n");
-        return;
-    }
-
-    char* var_name = node->children[0]->data.identifier.name;
-    BigInt decrement_val;
-    evaluate_big_int_value(node->children[1], &decrement_val);
-
-    BigInt current_value;
-    BigInt new_value;
-
-    if (lookup_runtime_symbol(&global_runtime_sym_table, var_name, &current_value)) {
-        big_int_sub(&new_value, &current_value, &decrement_val);
-        add_or_update_runtime_symbol(&global_runtime_sym_table, var_name, &new_value);
-        printf("[DEBUG] Decremented '%s' by ", var_name);
-        big_int_print(&decrement_val);
-        printf(". New value: ");
-        big_int_print(&new_value);
-        printf(".\n");
-    } else {
-        fprintf(stderr, "Runtime Error: Undeclared variable '%s' in decrement at line %d, column %d.\n",
-                var_name, node->location.line, node->location.column);
-    }
-}
-
-
-static void interpret_write_statement(ASTNode* node) {
-    if (!node || node->type != AST_WRITE_STATEMENT || node->num_children != 1 ||
-        node->children[0]->type != AST_OUTPUT_LIST) {
-        fprintf(stderr, "Interpreter Error: Invalid AST_WRITE_STATEMENT node structure.\n");
-        return;
-    }
-
-    ASTNode* output_list_node = node->children[0];
-    char str_buffer[MAX_BIGINT_STRING_LEN + 1]; // Buffer for printing BigInts
-
-    for (int i = 0; i < output_list_node->num_children; ++i) {
-        ASTNode* list_element = output_list_node->children[i];
-        if (!list_element || list_element->num_children != 1) { // Each list element has one child (int_value, string, newline)
-            fprintf(stderr, "Interpreter Error: Invalid AST_LIST_ELEMENT node structure within output list.\n");
-            continue;
-        }
-
-        ASTNode* element_content = list_element->children[0];
-
-        switch (element_content->type) {
-            case AST_INT_VALUE: {
-                BigInt value_to_print;
-                evaluate_big_int_value(element_content, &value_to_print);
-                big_int_to_string(&value_to_print, str_buffer);
-                printf("%s", str_buffer);
-                break;
-            }
-            case AST_STRING_LITERAL:
-                printf("%s", element_content->data.string_value);
-                break;
-            case AST_NEWLINE:
-                printf("\n");
-                break;
-            default:
-                fprintf(stderr, "Interpreter Error: Unsupported AST node type in output list: %d\n", element_content->type);
-                break;
-        }
-    }
-}
-
-
-static void interpret_loop_statement(ASTNode* node) {
-    // Loop statement structure: AST_LOOP_STATEMENT (with data.loop.count_expr and data.loop.body)
-    if (!node || node->type != AST_LOOP_STATEMENT || !node->data.loop.count_expr || !node->data.loop.body) {
-        fprintf(stderr, "Interpreter Error: Invalid AST_LOOP_STATEMENT node structure. Missing count_expr or body.\n");
-        return;
-    }
-
-    ASTNode* count_expr_node = node->data.loop.count_expr;
-    ASTNode* body_node = node->data.loop.body;
-
-    // Evaluate the initial loop count. This will be the *effective* number of times the loop runs.
-    BigInt loop_count;
-    evaluate_big_int_value(count_expr_node, &loop_count);
-
-    BigInt zero;
-    big_int_zero(&zero);
-
-    // Check for negative loop count
-    if (loop_count.sign == -1) {
-        fprintf(stderr, "Runtime Error: Loop count cannot be negative at line %d, column %d. Skipping loop.\n",
-                node->location.line, node->location.column);
-        return;
-    }
-
-    // If initial count is zero, skip the loop entirely
-    if (big_int_abs_compare(&loop_count, &zero) == 0) {
-        printf("[DEBUG] Interpreting loop statement (count: 0, skipping loop).\n");
-        return;
-    }
-
-    printf("[DEBUG] Interpreting loop statement (BigInt count: ");
-    big_int_print(&loop_count);
-    printf(").\n");
-
-    BigInt current_iteration;
-    big_int_zero(&current_iteration);
-    BigInt one;
-    big_int_from_long_long(&one, 1);
-
-    // Loop as long as current_iteration < loop_count
-    while (big_int_abs_compare(&current_iteration, &loop_count) < 0) {
-        if (body_node->type == AST_CODE_BLOCK) {
-            interpret_code_block(body_node);
-        } else {
-            interpret_statement(body_node);
-        }
-        big_int_add(&current_iteration, &current_iteration, &one); // Increment internal counter for loop iterations
-        printf("[DEBUG] Loop iteration count: "); // Debug for loop
-        big_int_print(&current_iteration);
-        printf(".\n");
-    }
-    printf("[DEBUG] Loop finished. Iterations completed: ");
-    big_int_print(&current_iteration);
-    printf(".\n");
-}
-
-static void interpret_code_block(ASTNode* node) {
-    if (!node || node->type != AST_CODE_BLOCK || node->num_children != 1 || node->children[0]->type != AST_STATEMENT_LIST) {
-        fprintf(stderr, "Interpreter Error: Invalid AST_CODE_BLOCK node structure.\n");
-        return;
-    }
-    printf("[DEBUG] Entering code block.\n");
-    interpret_statement_list(node->children[0]);
-    printf("[DEBUG] Exiting code block.\n\n"); // Added newline for clarity
-}
-
-
-// Evaluates an <int_value> AST node to its BigInt value
-static void evaluate_big_int_value(ASTNode* node, BigInt* result) {
-    if (!node || node->type != AST_INT_VALUE || node->num_children != 1) {
-        fprintf(stderr, "Interpreter Error: Invalid AST_INT_VALUE node structure. Expected one child.\n");
-        big_int_zero(result);
-        return;
-    }
-
-    ASTNode* child = node->children[0];
-    if (child->type == AST_INTEGER_LITERAL) {
-        // The AST_INTEGER_LITERAL node now directly holds a BigInt
-        big_int_copy(result, &child->data.integer);
-    } else if (child->type == AST_IDENTIFIER) {
-        char* var_name = child->data.identifier.name;
-        if (!lookup_runtime_symbol(&global_runtime_sym_table, var_name, result)) {
-            fprintf(stderr, "Runtime Error: Undeclared variable '%s' used in expression at line %d, column %d.\n",
-                    var_name, node->location.line, node->location.column);
-            big_int_zero(result); // Return 0 for undeclared variable
-        }
-    } else {
-        fprintf(stderr, "Interpreter Error: Invalid child type for AST_INT_VALUE: %d\n", child->type);
-        big_int_zero(result);
-    }
-}
+#include "interpreter.h" // Include its own header
+#include "output.h"
+#include "loop_render.h"
+#include "linear_loop.h"
+#include "regions.h"
+#include "batch_update.h"
+#include "input.h"
+#include "vector.h"
+#include "metrics.h"
+#include "store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h> // For LLONG_MAX and PATH_MAX
+
+// Global or passed-around runtime symbol table instance
+static RuntimeSymbolTable global_runtime_sym_table;
+// Vector variables, kept apart so that number lookups and fast paths never meet one
+static VectorTable global_vector_table;
+// Read/write set of the statement being executed, if dependency tracking is on
+static AccessLog* active_access_log = NULL;
+// Bumped whenever the environment is recreated, so cached entry indices can be checked
+static unsigned long environment_generation = 0;
+// Where the nodes of the script being run are located (interpreter_set_script_path)
+static const char* script_path = NULL;
+
+// Initial values of declared variables (--bindings); names not listed start at 0
+static char* const* binding_names = NULL;
+static const BigInt* binding_values = NULL;
+static int binding_count = 0;
+
+// Frames kept inline before the executor stack moves to the heap
+#define EXEC_INLINE_FRAMES 8
+
+// One open loop of the statement being executed. Code blocks only occur as
+// loop bodies, so a loop's frame also tracks its way through the block.
+typedef struct {
+    ASTNode* node;                 // The loop statement
+    BigInt count;                  // Iterations to run
+    BigInt iteration;              // Iterations completed
+    bool body_running;             // The body of the current iteration has been started
+    ASTNode* list;                 // Statement list of the block body being run, or NULL
+    struct UpdateBatchPlan* plan;  // Its batched-update plan, if batching is on
+    int index;                     // Next statement of the list to run
+    int next_run;                  // Next update run of the plan
+} ExecFrame;
+
+// Explicit stack replacing recursion through nested loops: nesting costs one
+// frame per level (bounded by max_nesting_depth) instead of C stack
+typedef struct {
+    ExecFrame* frames;
+    int count;
+    int capacity;
+    ExecFrame inline_frames[EXEC_INLINE_FRAMES];
+} ExecStack;
+
+// Forward declarations for interpret functions for different AST node types (internal to this file)
+static void interpret_statement_list(ASTNode* node);
+static void interpret_statement(ASTNode* node); // Runs one statement, nested loops included
+static void begin_statement(ExecStack* stack, ASTNode* node);
+static void interpret_declaration(ASTNode* node);
+static void interpret_vector_declaration(ASTNode* node);
+static void interpret_vector_update(ASTNode* node, NumberVector* vector);
+static void interpret_assignment(ASTNode* node);
+static void interpret_increment(ASTNode* node);
+static void interpret_decrement(ASTNode* node);
+static void interpret_write_statement(ASTNode* node);
+static void interpret_read_statement(ASTNode* node);
+static void begin_loop_statement(ExecStack* stack, ASTNode* node);
+static void begin_code_block(ExecFrame* frame, ASTNode* node);
+static void run_exec_stack(ExecStack* stack);
+// Changed return type and parameter type to BigInt for evaluation
+static void evaluate_big_int_value(ASTNode* node, BigInt* result);
+static const BigInt* evaluate_operand(ASTNode* node, BigInt* scratch);
+
+
+
+
+// --- Runtime Symbol Table (Environment) Implementations ---
+
+void init_runtime_symbol_table(RuntimeSymbolTable* table) {
+    table->entries = NULL;
+    table->count = 0;
+    table->capacity = 0;
+    table->index = NULL;
+    table->index_capacity = 0;
+}
+
+// FNV-1a hash of a variable name, used by the runtime symbol index
+static unsigned int hash_runtime_name(const char* name) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; ++p) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+// Inserts an entry into the hash index (the name must not be indexed yet)
+static void index_runtime_entry(RuntimeSymbolTable* table, int entry_idx) {
+    unsigned int mask = (unsigned int)table->index_capacity - 1;
+    unsigned int slot = hash_runtime_name(table->entries[entry_idx].name) & mask;
+    while (table->index[slot] != -1) {
+        slot = (slot + 1) & mask;
+    }
+    table->index[slot] = entry_idx;
+}
+
+int find_runtime_symbol(const RuntimeSymbolTable* table, const char* name) {
+    if (table->index_capacity == 0) return -1;
+    unsigned int mask = (unsigned int)table->index_capacity - 1;
+    unsigned int slot = hash_runtime_name(name) & mask;
+    while (table->index[slot] != -1) {
+        int i = table->index[slot];
+        if (strcmp(table->entries[i].name, name) == 0) {
+            return i;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+// Changed value to const BigInt*
+void add_or_update_runtime_symbol(RuntimeSymbolTable* table, const char* name, const BigInt* value) {
+    // Check if symbol already exists, then update
+    int existing = find_runtime_symbol(table, name);
+    if (existing != -1) {
+        // Update the existing BigInt value
+        big_int_copy(&table->entries[existing].value, value); // Use your BigInt copy function
+        if (table->entries[existing].decimal) table->entries[existing].decimal->valid = false;
+        return;
+    }
+
+    // Symbol does not exist, add new entry
+    if (table->count >= table->capacity) {
+        // Double capacity or set to a default if currently 0
+        table->capacity = (table->capacity == 0) ? 4 : table->capacity * 2;
+        table->entries = (RuntimeSymbolEntry*)realloc(table->entries, table->capacity * sizeof(RuntimeSymbolEntry));
+        if (!table->entries) {
+            fprintf(stderr, "Memory allocation failed for runtime symbol table.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    // Keep the hash index at most half full, rebuilding it when it grows
+    if ((table->count + 1) * 2 > table->index_capacity) {
+        table->index_capacity = (table->index_capacity == 0) ? 16 : table->index_capacity * 2;
+        free(table->index);
+        table->index = (int*)malloc(table->index_capacity * sizeof(int));
+        if (!table->index) {
+            fprintf(stderr, "Memory allocation failed for runtime symbol index.\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(table->index, -1, table->index_capacity * sizeof(int));
+        for (int i = 0; i < table->count; ++i) {
+            index_runtime_entry(table, i);
+        }
+    }
+
+    table->entries[table->count].name = strdup(name); // Duplicate string for ownership
+    if (!table->entries[table->count].name) {
+        fprintf(stderr, "Memory allocation failed for symbol name.\n");
+        exit(EXIT_FAILURE);
+    }
+    // Copy the BigInt value to the new entry
+    big_int_copy(&table->entries[table->count].value, value); // Use your BigInt copy function
+    table->entries[table->count].decimal = NULL;
+    index_runtime_entry(table, table->count);
+    table->count++;
+}
+
+// Changed out_value to BigInt*
+bool lookup_runtime_symbol(RuntimeSymbolTable* table, const char* name, BigInt* out_value) {
+    int i = find_runtime_symbol(table, name);
+    if (i == -1) {
+        return false;
+    }
+    if (out_value) {
+        big_int_copy(out_value, &table->entries[i].value); // Copy the BigInt value
+    }
+    return true;
+}
+
+void free_runtime_symbol_table(RuntimeSymbolTable* table) {
+    for (int i = 0; i < table->count; ++i) {
+        free(table->entries[i].name); // Free duplicated names
+        free(table->entries[i].decimal);
+        // No need to free BigInt.value as it's stored by value, not pointer.
+    }
+    free(table->entries); // Free the array itself
+    free(table->index);
+    table->entries = NULL;
+    table->index = NULL;
+    table->count = 0;
+    table->capacity = 0;
+    table->index_capacity = 0;
+}
+
+// --- Decimal Caches ---
+
+void decimal_cache_fill(DecimalCache* cache, const BigInt* value) {
+    char str_buffer[MAX_BIGINT_STRING_LEN + 2];
+    big_int_to_string(value, str_buffer);
+    const char* digits = str_buffer[0] == '-' ? str_buffer + 1 : str_buffer;
+    int length = (int)strlen(digits);
+    cache->valid = length <= DECIMAL_CACHE_DIGITS;
+    if (!cache->valid) return;
+    cache->sign = str_buffer[0] == '-' ? -1 : 1;
+    cache->start = DECIMAL_CACHE_DIGITS + 1 - length;
+    memcpy(cache->text + cache->start, digits, length);
+}
+
+// Adds amount to the magnitude digit by digit; the carry usually stops after one digit
+static bool decimal_magnitude_add(DecimalCache* cache, unsigned long long amount) {
+    int i = DECIMAL_CACHE_DIGITS;
+    while (amount > 0) {
+        if (i < cache->start) {
+            if (i < 1) return false; // Keep index 0 free for the sign
+            cache->text[i] = '0';
+            cache->start = i;
+        }
+        unsigned long long digit = (unsigned long long)(cache->text[i] - '0') + amount % 10;
+        amount /= 10;
+        if (digit >= 10) {
+            digit -= 10;
+            amount++;
+        }
+        cache->text[i--] = (char)('0' + digit);
+    }
+    return true;
+}
+
+// Subtracts amount from the magnitude; fails if the magnitude would go negative
+static bool decimal_magnitude_sub(DecimalCache* cache, unsigned long long amount) {
+    int i = DECIMAL_CACHE_DIGITS;
+    while (amount > 0) {
+        if (i < cache->start) return false;
+        int digit = (cache->text[i] - '0') - (int)(amount % 10);
+        amount /= 10;
+        if (digit < 0) {
+            digit += 10;
+            amount++;
+        }
+        cache->text[i--] = (char)('0' + digit);
+    }
+    while (cache->start < DECIMAL_CACHE_DIGITS && cache->text[cache->start] == '0') cache->start++;
+    if (cache->start == DECIMAL_CACHE_DIGITS && cache->text[cache->start] == '0') cache->sign = 1;
+    return true;
+}
+
+// Mirrors value += direction * delta on the decimal text. Fails (leaving the
+// cache to be refilled) if |delta| > DECIMAL_CACHE_MAX_STEP or the value would
+// outgrow DECIMAL_CACHE_DIGITS or cross zero.
+bool decimal_cache_add(DecimalCache* cache, const BigInt* delta, int direction) {
+    for (int i = 1; i < NUM_LIMBS; ++i) {
+        if (delta->limbs[i] != 0) return false;
+    }
+    unsigned long long amount = delta->limbs[0];
+    if (amount == 0) return true;
+    if (amount > DECIMAL_CACHE_MAX_STEP) return false;
+    direction *= delta->sign;
+
+    bool is_zero = cache->start == DECIMAL_CACHE_DIGITS && cache->text[cache->start] == '0';
+    if (is_zero) cache->sign = direction;
+    if (is_zero || cache->sign == direction) return decimal_magnitude_add(cache, amount);
+    return decimal_magnitude_sub(cache, amount);
+}
+
+// Writes a variable's value through its decimal cache
+static void write_variable_value(RuntimeSymbolEntry* entry) {
+    if (!entry->decimal) {
+        entry->decimal = (DecimalCache*)malloc(sizeof(DecimalCache));
+        if (!entry->decimal) {
+            fprintf(stderr, "Memory allocation failed for decimal cache.\n");
+            exit(EXIT_FAILURE);
+        }
+        entry->decimal->valid = false;
+    }
+    DecimalCache* cache = entry->decimal;
+    if (!cache->valid) decimal_cache_fill(cache, &entry->value);
+    if (!cache->valid) {
+        char str_buffer[MAX_BIGINT_STRING_LEN + 2];
+        big_int_to_string(&entry->value, str_buffer);
+        output_write_string(str_buffer);
+        return;
+    }
+    int first = cache->start;
+    if (cache->sign == -1) cache->text[--first] = '-';
+    output_write(cache->text + first, DECIMAL_CACHE_DIGITS + 1 - first);
+}
+
+// --- Variable Access Tracking ---
+
+static bool big_int_equal(const BigInt* a, const BigInt* b) {
+    return big_int_abs_compare(a, b) == 0 && a->sign == b->sign;
+}
+
+static VariableAccess* find_access(VariableAccess* accesses, int count, const char* name) {
+    for (int i = 0; i < count; ++i) {
+        if (strcmp(accesses[i].name, name) == 0) return &accesses[i];
+    }
+    return NULL;
+}
+
+static VariableAccess* append_access(VariableAccess** accesses, int* count, int* capacity, const char* name) {
+    if (*count >= *capacity) {
+        *capacity = *capacity == 0 ? 4 : *capacity * 2;
+        *accesses = (VariableAccess*)realloc(*accesses, *capacity * sizeof(VariableAccess));
+        if (!*accesses) {
+            fprintf(stderr, "Memory allocation failed for access log.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    VariableAccess* access = &(*accesses)[(*count)++];
+    access->name = strdup(name);
+    if (!access->name) {
+        fprintf(stderr, "Memory allocation failed for access log name.\n");
+        exit(EXIT_FAILURE);
+    }
+    access->declared = false;
+    access->value_used = false;
+    big_int_zero(&access->value);
+    return access;
+}
+
+// The vector called name, if any; number statements only look when vectors exist
+static NumberVector* find_vector(const char* name) {
+    return global_vector_table.count > 0 ? vector_table_find(&global_vector_table, name) : NULL;
+}
+
+// Access logs only record numbers, so a statement that involved a vector is never replayed
+static void note_vector_use(void) {
+    if (active_access_log) active_access_log->touched_vector = true;
+}
+
+// Records a read. Only the first one before any write matters: later reads see
+// either that same entry value or a value the statement produced itself.
+static void note_read(const char* name, bool value_used) {
+    AccessLog* log = active_access_log;
+    if (!log || find_access(log->writes, log->write_count, name)) return;
+
+    VariableAccess* access = find_access(log->reads, log->read_count, name);
+    if (access && (access->value_used || !value_used)) return;
+    if (!access) access = append_access(&log->reads, &log->read_count, &log->read_capacity, name);
+
+    int idx = find_runtime_symbol(&global_runtime_sym_table, name);
+    access->declared = idx >= 0 || find_vector(name);
+    access->value_used = value_used;
+    if (idx >= 0) big_int_copy(&access->value, &global_runtime_sym_table.entries[idx].value);
+}
+
+// Records a write; final values are captured once the statement has finished
+static void note_write(const char* name) {
+    AccessLog* log = active_access_log;
+    if (!log || find_access(log->writes, log->write_count, name)) return;
+    append_access(&log->writes, &log->write_count, &log->write_capacity, name);
+}
+
+void access_log_clear(AccessLog* log) {
+    for (int i = 0; i < log->read_count; ++i) free(log->reads[i].name);
+    for (int i = 0; i < log->write_count; ++i) free(log->writes[i].name);
+    log->read_count = 0;
+    log->write_count = 0;
+    log->consumed_input = false;
+    log->touched_vector = false;
+}
+
+void access_log_free(AccessLog* log) {
+    access_log_clear(log);
+    free(log->reads);
+    free(log->writes);
+    log->reads = NULL;
+    log->writes = NULL;
+    log->read_capacity = 0;
+    log->write_capacity = 0;
+}
+
+void interpreter_set_access_log(AccessLog* log) {
+    active_access_log = log;
+}
+
+bool interpreter_reads_match(const AccessLog* log) {
+    if (log->consumed_input || log->touched_vector) return false;
+    for (int i = 0; i < log->read_count; ++i) {
+        const VariableAccess* access = &log->reads[i];
+        int idx = find_runtime_symbol(&global_runtime_sym_table, access->name);
+        if ((idx >= 0 || find_vector(access->name)) != access->declared) return false;
+        if (idx >= 0 && access->value_used &&
+            !big_int_equal(&global_runtime_sym_table.entries[idx].value, &access->value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void interpreter_apply_writes(const AccessLog* log) {
+    for (int i = 0; i < log->write_count; ++i) {
+        add_or_update_runtime_symbol(&global_runtime_sym_table, log->writes[i].name, &log->writes[i].value);
+    }
+}
+
+bool interpreter_get_variable(const char* name, BigInt* out_value) {
+    return lookup_runtime_symbol(&global_runtime_sym_table, name, out_value);
+}
+
+void interpreter_set_bindings(char* const* names, const BigInt* values, int count) {
+    binding_names = names;
+    binding_values = values;
+    binding_count = count;
+}
+
+void interpreter_set_script_path(const char* path) {
+    script_path = path;
+}
+
+const char* runtime_error_unit(const ASTNode* node) {
+    // Per thread, since region and SPMD workers report errors too
+    static _Thread_local char suffix[PATH_MAX + 8];
+    const char* file = node->location.filename;
+    if (!file || !script_path || file == script_path || strcmp(file, script_path) == 0) return "";
+    snprintf(suffix, sizeof(suffix), " in '%s'", file);
+    return suffix;
+}
+
+void interpreter_reset_environment(void) {
+    free_runtime_symbol_table(&global_runtime_sym_table);
+    init_runtime_symbol_table(&global_runtime_sym_table);
+    vector_table_free(&global_vector_table);
+    environment_generation++;
+}
+
+// --- Interpreter Logic Implementations ---
+
+// Main interpretation entry point (defined here, declared in interpreter.h)
+void interpret_program(ASTNode* root_node) {
+    // The root node should be of type AST_PROGRAM.
+    // Its first child is the StatementList.
+    if (!root_node || root_node->type != AST_PROGRAM || root_node->num_children != 1 ||
+        root_node->children[0]->type != AST_STATEMENT_LIST) {
+        fprintf(stderr, "Interpreter Error: Invalid AST root node. Expected AST_PROGRAM with a StatementList child.\n");
+        return;
+    }
+
+    interpreter_begin();
+
+    // The PROGRAM node has a single child: the STATEMENT_LIST
+    if (!trace_enabled && !active_access_log) {
+        // Traces would interleave, so independent statements only run side by side in quiet mode
+        interpret_statement_regions(root_node->children[0]);
+    } else {
+        interpret_statement_list(root_node->children[0]);
+    }
+
+    interpreter_end();
+}
+
+// Session entry points: the runtime environment lives between begin and end,
+// so statements can be executed one at a time as they are produced (pipelined parsing).
+void interpreter_begin(void) {
+    init_runtime_symbol_table(&global_runtime_sym_table);
+    vector_table_init(&global_vector_table);
+    environment_generation++;
+    if (trace_enabled) printf("\n--- Starting Program Execution ---\n");
+}
+
+void interpret_top_level_statement(ASTNode* node) {
+    interpret_statement(node);
+
+    AccessLog* log = active_access_log;
+    if (log) {
+        for (int i = 0; i < log->write_count; ++i) {
+            int idx = find_runtime_symbol(&global_runtime_sym_table, log->writes[i].name);
+            log->writes[i].declared = idx >= 0;
+            if (idx >= 0) big_int_copy(&log->writes[i].value, &global_runtime_sym_table.entries[idx].value);
+        }
+    }
+}
+
+void interpreter_end(void) {
+    if (trace_enabled) printf("\n--- Program Execution Finished ---\n");
+    if (store_is_open()) store_save(&global_runtime_sym_table, &global_vector_table);
+    free_runtime_symbol_table(&global_runtime_sym_table);
+    vector_table_free(&global_vector_table);
+}
+
+
+static void interpret_statement_list(ASTNode* node) {
+    if (!node || node->type != AST_STATEMENT_LIST) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_STATEMENT_LIST node structure.\n");
+        return;
+    }
+
+    for (int i = 0; i < node->num_children; ++i) {
+        interpret_statement(node->children[i]);
+    }
+}
+
+static void interpret_statement(ASTNode* node) {
+    ExecStack stack;
+    stack.frames = stack.inline_frames;
+    stack.count = 0;
+    stack.capacity = EXEC_INLINE_FRAMES;
+    begin_statement(&stack, node);
+    run_exec_stack(&stack);
+    if (stack.frames != stack.inline_frames) free(stack.frames);
+}
+
+// Runs a simple statement outright; a loop only gets its frame pushed
+static void begin_statement(ExecStack* stack, ASTNode* node) {
+    if (!node) {
+        fprintf(stderr, "Interpreter Error: NULL statement node.\n");
+        return;
+    }
+    if (metrics_segment) metrics_add_statements(1);
+
+    switch (node->type) {
+        case AST_DECLARATION:
+            interpret_declaration(node);
+            break;
+        case AST_VECTOR_DECLARATION:
+            interpret_vector_declaration(node);
+            break;
+        case AST_ASSIGNMENT:
+            interpret_assignment(node);
+            break;
+        case AST_INCREMENT:
+            interpret_increment(node);
+            break;
+        case AST_DECREMENT:
+            interpret_decrement(node);
+            break;
+        case AST_WRITE_STATEMENT:
+            interpret_write_statement(node);
+            break;
+        case AST_READ_STATEMENT:
+            interpret_read_statement(node);
+            break;
+        case AST_LOOP_STATEMENT:
+            begin_loop_statement(stack, node);
+            break;
+        case AST_INCLUDE_STATEMENT:
+            // Every front end links includes (units.h) or refuses them before running
+            fprintf(stderr, "Runtime Error: include statement was not linked (line %d, column %d%s).\n",
+                    node->location.line, node->location.column, runtime_error_unit(node));
+            break;
+        // AST_STATEMENT_LIST is handled by interpret_statement_list
+        // AST_PROGRAM is handled by interpret_program
+        // Other types are not expected as top-level statements
+        default:
+            fprintf(stderr, "Interpreter Error: Unexpected AST node type for a statement: %d\n", node->type);
+            break;
+    }
+}
+
+
+// Value a declaration starts the variable at: 0 (stored in zero), the value
+// bound to its name, or its value in the store
+static const BigInt* initial_value(const char* name, BigInt* zero) {
+    big_int_zero(zero);
+    const BigInt* initial = zero;
+    if (store_is_open()) {
+        const BigInt* stored = store_number(name);
+        return stored ? stored : zero;
+    }
+    for (int i = 0; i < binding_count; ++i) {
+        if (strcmp(binding_names[i], name) == 0) initial = &binding_values[i];
+    }
+    return initial;
+}
+
+static void interpret_declaration(ASTNode* node) {
+    if (!node || node->type != AST_DECLARATION || node->num_children != 1 ||
+        node->children[0]->type != AST_IDENTIFIER) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_DECLARATION node structure.\n");
+        return;
+    }
+
+    char* var_name = node->children[0]->data.identifier.name;
+    BigInt dummy_lookup; // Dummy for lookup, we only care if it exists
+
+    // Check if the variable is already declared
+    note_read(var_name, false);
+    if (lookup_runtime_symbol(&global_runtime_sym_table, var_name, &dummy_lookup) || find_vector(var_name)) {
+        fprintf(stderr, "Runtime Error: Variable '%s' already declared at line %d, column %d%s.\n",
+                var_name, node->location.line, node->location.column, runtime_error_unit(node));
+        return; // Stop processing this declaration
+    }
+
+    // Declare with default value 0 (as BigInt), or the value bound to the name
+    BigInt zero_val;
+    const BigInt* initial = initial_value(var_name, &zero_val);
+    add_or_update_runtime_symbol(&global_runtime_sym_table, var_name, initial);
+    note_write(var_name);
+    if (trace_enabled) {
+        printf("[DEBUG] Declared variable '%s' with initial value ", var_name);
+        big_int_print(initial);
+        printf(".\n");
+    }
+}
+
+static void interpret_vector_declaration(ASTNode* node) {
+    if (!node || node->type != AST_VECTOR_DECLARATION || node->num_children != 2 ||
+        node->children[0]->type != AST_IDENTIFIER || node->children[1]->type != AST_INT_VALUE) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_VECTOR_DECLARATION node structure.\n");
+        return;
+    }
+
+    char* var_name = node->children[0]->data.identifier.name;
+    BigInt length;
+    evaluate_big_int_value(node->children[1], &length);
+
+    note_read(var_name, false);
+    note_vector_use();
+    if (find_runtime_symbol(&global_runtime_sym_table, var_name) >= 0 || find_vector(var_name)) {
+        fprintf(stderr, "Runtime Error: Variable '%s' already declared at line %d, column %d%s.\n",
+                var_name, node->location.line, node->location.column, runtime_error_unit(node));
+        return;
+    }
+    bool in_range = length.sign == 1 && length.limbs[0] <= VECTOR_MAX_LENGTH;
+    for (int i = 1; i < NUM_LIMBS; ++i) {
+        if (length.limbs[i] != 0) in_range = false;
+    }
+    if (!in_range) {
+        fprintf(stderr, "Runtime Error: Vector length must be between 0 and %d at line %d, column %d%s.\n",
+                VECTOR_MAX_LENGTH, node->location.line, node->location.column, runtime_error_unit(node));
+        return;
+    }
+
+    // Elements keep their values from the store if it holds a vector of this length
+    size_t element_count = (size_t)length.limbs[0];
+    BigInt zero_val;
+    if (store_is_open()) {
+        const BigInt* stored = store_vector(var_name, element_count);
+        big_int_zero(&zero_val);
+        NumberVector* vector = vector_table_add(&global_vector_table, var_name, element_count, &zero_val);
+        for (size_t i = 0; stored && i < element_count; ++i) vector_set(vector, i, &stored[i]);
+        if (trace_enabled) {
+            printf("[DEBUG] Declared vector '%s' with %zu %s.\n", var_name, element_count,
+                   stored ? "stored elements" : "elements of initial value 0");
+        }
+        return;
+    }
+
+    // Every element starts at 0, or at the value bound to the name
+    const BigInt* initial = initial_value(var_name, &zero_val);
+    vector_table_add(&global_vector_table, var_name, element_count, initial);
+    if (trace_enabled) {
+        printf("[DEBUG] Declared vector '%s' with %llu elements of initial value ", var_name, length.limbs[0]);
+        big_int_print(initial);
+        printf(".\n");
+    }
+}
+
+// An assignment, increment or decrement of a whole vector. The operand is
+// either a vector of the same length, taken element by element, or a number
+// applied to every element.
+static void interpret_vector_update(ASTNode* node, NumberVector* vector) {
+    note_vector_use();
+    ASTNode* operand = node->children[1];
+    NumberVector* source = NULL;
+    if (operand->num_children == 1 && operand->children[0]->type == AST_IDENTIFIER) {
+        source = find_vector(operand->children[0]->data.identifier.name);
+    }
+    int sign = node->type == AST_DECREMENT ? -1 : 1;
+
+    if (source) {
+        if (source->length != vector->length) {
+            fprintf(stderr, "Runtime Error: Vectors '%s' (%zu elements) and '%s' (%zu elements) differ in length at line %d, column %d%s.\n",
+                    vector->name, vector->length, source->name, source->length, node->location.line, node->location.column, runtime_error_unit(node));
+            return;
+        }
+        if (node->type == AST_ASSIGNMENT) {
+            vector_copy(vector, source);
+        } else {
+            vector_add(vector, source, sign);
+        }
+    } else {
+        BigInt operand_scratch;
+        const BigInt* amount = evaluate_operand(operand, &operand_scratch);
+        if (node->type == AST_ASSIGNMENT) {
+            vector_fill(vector, amount);
+        } else {
+            vector_add_scalar(vector, amount, sign);
+        }
+        if (trace_enabled) {
+            printf("[DEBUG] Vector '%s' %s ", vector->name, node->type == AST_ASSIGNMENT ? ":=" : sign > 0 ? "+=" : "-=");
+            big_int_print(amount);
+            printf(" (%zu elements).\n", vector->length);
+        }
+        return;
+    }
+    if (trace_enabled) {
+        printf("[DEBUG] Vector '%s' %s '%s' (%zu elements).\n", vector->name,
+               node->type == AST_ASSIGNMENT ? ":=" : sign > 0 ? "+=" : "-=", source->name, vector->length);
+    }
+}
+
+static void interpret_assignment(ASTNode* node) {
+    if (!node || node->type != AST_ASSIGNMENT || node->num_children != 2 ||
+        node->children[0]->type != AST_IDENTIFIER || node->children[1]->type != AST_INT_VALUE) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_ASSIGNMENT node structure.\n");
+        return;
+    }
+
+    char* var_name = node->children[0]->data.identifier.name;
+    NumberVector* vector = find_vector(var_name);
+    if (vector) {
+        interpret_vector_update(node, vector);
+        return;
+    }
+    BigInt value_to_assign; // Result of evaluation
+    evaluate_big_int_value(node->children[1], &value_to_assign);
+
+    BigInt dummy_lookup; // Dummy for lookup, if we only care if it exists
+    note_read(var_name, false);
+    if (lookup_runtime_symbol(&global_runtime_sym_table, var_name, &dummy_lookup)) {
+        add_or_update_runtime_symbol(&global_runtime_sym_table, var_name, &value_to_assign);
+        note_write(var_name);
+        if (trace_enabled) {
+            printf("[DEBUG] Assigned '%s' := ", var_name);
+            big_int_print(&value_to_assign);
+            printf(".\n");
+        }
+    } else {
+        fprintf(stderr, "Runtime Error: Undeclared variable '%s' in assignment at line %d, column %d%s.\n",
+                var_name, node->location.line, node->location.column, runtime_error_unit(node));
+    }
+}
+
+static void interpret_increment(ASTNode* node) {
+    if (!node || node->type != AST_INCREMENT || node->num_children != 2 ||
+        node->children[0]->type != AST_IDENTIFIER || node->children[1]->type != AST_INT_VALUE) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_INCREMENT node structure.\n");
+        return;
+    }
+
+    char* var_name = node->children[0]->data.identifier.name;
+    NumberVector* vector = find_vector(var_name);
+    if (vector) {
+        interpret_vector_update(node, vector);
+        return;
+    }
+    BigInt operand_scratch;
+    const BigInt* increment_val = evaluate_operand(node->children[1], &operand_scratch);
+
+    note_read(var_name, true);
+    int idx = find_runtime_symbol(&global_runtime_sym_table, var_name);
+    if (idx >= 0) {
+        RuntimeSymbolEntry* entry = &global_runtime_sym_table.entries[idx];
+        big_int_add(&entry->value, &entry->value, increment_val);
+        if (entry->decimal && entry->decimal->valid && !decimal_cache_add(entry->decimal, increment_val, 1)) {
+            entry->decimal->valid = false;
+        }
+        note_write(var_name);
+        if (trace_enabled) {
+            printf("[DEBUG] Incremented '%s' by ", var_name);
+            big_int_print(increment_val);
+            printf(". New value: ");
+            big_int_print(&entry->value);
+            printf(".\n");
+        }
+    } else {
+        fprintf(stderr, "Runtime Error: Undeclared variable '%s' in increment at line %d, column %d%s.\n",
+                var_name, node->location.line, node->location.column, runtime_error_unit(node));
+    }
+}
+
+static void interpret_decrement(ASTNode* node) {
+    if (!node || node->type != AST_DECREMENT || node->num_children != 2 ||
+        node->children[0]->type != AST_IDENTIFIER || node->children[1]->type != AST_INT_VALUE) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_DECREMENT node structure.\n");
+        return;
+    }
+
+    char* var_name = node->children[0]->data.identifier.name;
+    NumberVector* vector = find_vector(var_name);
+    if (vector) {
+        interpret_vector_update(node, vector);
+        return;
+    }
+    BigInt operand_scratch;
+    const BigInt* decrement_val = evaluate_operand(node->children[1], &operand_scratch);
+
+    note_read(var_name, true);
+    int idx = find_runtime_symbol(&global_runtime_sym_table, var_name);
+    if (idx >= 0) {
+        RuntimeSymbolEntry* entry = &global_runtime_sym_table.entries[idx];
+        big_int_sub(&entry->value, &entry->value, decrement_val);
+        if (entry->decimal && entry->decimal->valid && !decimal_cache_add(entry->decimal, decrement_val, -1)) {
+            entry->decimal->valid = false;
+        }
+        note_write(var_name);
+        if (trace_enabled) {
+            printf("[DEBUG] Decremented '%s' by ", var_name);
+            big_int_print(decrement_val);
+            printf(". New value: ");
+            big_int_print(&entry->value);
+            printf(".\n");
+        }
+    } else {
+        fprintf(stderr, "Runtime Error: Undeclared variable '%s' in decrement at line %d, column %d%s.\n",
+                var_name, node->location.line, node->location.column, runtime_error_unit(node));
+    }
+}
+
+
+static void interpret_write_statement(ASTNode* node) {
+    if (!node || node->type != AST_WRITE_STATEMENT || node->num_children != 1 ||
+        node->children[0]->type != AST_OUTPUT_LIST) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_WRITE_STATEMENT node structure.\n");
+        return;
+    }
+
+    ASTNode* output_list_node = node->children[0];
+    char str_buffer[MAX_BIGINT_STRING_LEN + 1]; // Buffer for printing BigInts
+
+    for (int i = 0; i < output_list_node->num_children; ++i) {
+        ASTNode* list_element = output_list_node->children[i];
+        if (!list_element || list_element->num_children != 1) { // Each list element has one child (int_value, string, newline)
+            fprintf(stderr, "Interpreter Error: Invalid AST_LIST_ELEMENT node structure within output list.\n");
+            continue;
+        }
+
+        ASTNode* element_content = list_element->children[0];
+
+        switch (element_content->type) {
+            case AST_INT_VALUE: {
+                ASTNode* value_node = element_content->num_children == 1 ? element_content->children[0] : NULL;
+                int idx = -1;
+                if (value_node && value_node->type == AST_IDENTIFIER) {
+                    note_read(value_node->data.identifier.name, true);
+                    idx = find_runtime_symbol(&global_runtime_sym_table, value_node->data.identifier.name);
+                }
+                if (idx >= 0) {
+                    write_variable_value(&global_runtime_sym_table.entries[idx]);
+                    break;
+                }
+                NumberVector* vector = idx < 0 && value_node && value_node->type == AST_IDENTIFIER
+                                           ? find_vector(value_node->data.identifier.name) : NULL;
+                if (vector) {
+                    note_vector_use();
+                    vector_write(vector);
+                    break;
+                }
+                if (value_node && value_node->type == AST_INTEGER_LITERAL) {
+                    // Rendered once, when the literal was interned
+                    output_write(value_node->data.constant->text, value_node->data.constant->length);
+                    break;
+                }
+                BigInt operand_scratch;
+                big_int_to_string(evaluate_operand(element_content, &operand_scratch), str_buffer);
+                output_write_string(str_buffer);
+                break;
+            }
+            case AST_STRING_LITERAL:
+                output_write(element_content->data.constant->text, element_content->data.constant->length);
+                break;
+            case AST_NEWLINE:
+                output_write("\n", 1);
+                break;
+            default:
+                fprintf(stderr, "Interpreter Error: Unsupported AST node type in output list: %d\n", element_content->type);
+                break;
+        }
+    }
+}
+
+static void interpret_read_statement(ASTNode* node) {
+    if (!node || node->type != AST_READ_STATEMENT || node->num_children != 1 ||
+        node->children[0]->type != AST_IDENTIFIER) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_READ_STATEMENT node structure.\n");
+        return;
+    }
+
+    char* var_name = node->children[0]->data.identifier.name;
+    note_read(var_name, false);
+    NumberVector* vector = find_vector(var_name);
+    if (vector) {
+        note_vector_use();
+    } else if (find_runtime_symbol(&global_runtime_sym_table, var_name) < 0) {
+        fprintf(stderr, "Runtime Error: Undeclared variable '%s' in read at line %d, column %d%s.\n",
+                var_name, node->location.line, node->location.column, runtime_error_unit(node));
+        return;
+    }
+
+    // Input is not part of the recorded state, so this statement can never be replayed
+    if (active_access_log) active_access_log->consumed_input = true;
+    // A vector takes one integer per element, in order, up to the first failure
+    size_t count = vector ? vector->length : 1;
+    for (size_t i = 0; i < count; ++i) {
+        BigInt value;
+        switch (input_read_integer(&value)) {
+            case INPUT_OK:
+                if (vector) {
+                    vector_set(vector, i, &value);
+                    continue;
+                }
+                add_or_update_runtime_symbol(&global_runtime_sym_table, var_name, &value);
+                note_write(var_name);
+                if (trace_enabled) {
+                    printf("[DEBUG] Read '%s' := ", var_name);
+                    big_int_print(&value);
+                    printf(".\n");
+                }
+                continue;
+            case INPUT_END:
+                fprintf(stderr, "Runtime Error: No input left to read '%s' at line %d, column %d%s.\n",
+                        var_name, node->location.line, node->location.column, runtime_error_unit(node));
+                return;
+            case INPUT_MALFORMED:
+                fprintf(stderr, "Runtime Error: Malformed integer in input for '%s' at line %d, column %d%s.\n",
+                        var_name, node->location.line, node->location.column, runtime_error_unit(node));
+                return;
+            case INPUT_UNBOUND:
+                fprintf(stderr, "Runtime Error: No input source to read '%s' at line %d, column %d%s (use --input FILE).\n",
+                        var_name, node->location.line, node->location.column, runtime_error_unit(node));
+                return;
+        }
+    }
+    if (vector && trace_enabled) printf("[DEBUG] Read %zu elements into vector '%s'.\n", count, var_name);
+}
+
+
+// --- Parallel Loop Rendering ---
+
+static int big_int_bit_length(const BigInt* num) {
+    for (int i = NUM_LIMBS - 1; i >= 0; --i) {
+        if (num->limbs[i] != 0) return i * 64 + (64 - __builtin_clzll(num->limbs[i]));
+    }
+    return 0;
+}
+
+static int find_plan_variable(const char* const* names, int count, const char* name) {
+    for (int i = 0; i < count; ++i) {
+        if (strcmp(names[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+// Value of an <int_value> that no statement of the loop changes; false if undeclared
+static bool resolve_invariant_value(ASTNode* value_node, BigInt* out) {
+    if (!value_node || value_node->type != AST_INT_VALUE || value_node->num_children != 1) return false;
+    ASTNode* child = value_node->children[0];
+    if (child->type == AST_INTEGER_LITERAL) {
+        big_int_copy(out, &child->data.constant->value);
+        return true;
+    }
+    if (child->type != AST_IDENTIFIER) return false;
+    note_read(child->data.identifier.name, true);
+    return lookup_runtime_symbol(&global_runtime_sym_table, child->data.identifier.name, out);
+}
+
+static bool add_render_text(LoopRenderPlan* plan, const char* text, size_t length) {
+    RenderOp* last = plan->op_count > 0 ? &plan->ops[plan->op_count - 1] : NULL;
+    if (last && last->type == RENDER_OP_WRITE_TEXT) {
+        // Merge with the previous text so each iteration does fewer copies
+        last->text = (char*)realloc(last->text, last->text_length + length);
+        if (!last->text) {
+            fprintf(stderr, "Memory allocation failed for loop render text.\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(last->text + last->text_length, text, length);
+        last->text_length += length;
+        return true;
+    }
+    if (plan->op_count >= LOOP_RENDER_MAX_OPS) return false;
+    RenderOp* op = &plan->ops[plan->op_count++];
+    op->type = RENDER_OP_WRITE_TEXT;
+    op->text = (char*)malloc(length > 0 ? length : 1);
+    if (!op->text) {
+        fprintf(stderr, "Memory allocation failed for loop render text.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(op->text, text, length);
+    op->text_length = length;
+    return true;
+}
+
+// Builds the render plan of a loop body made only of += / -= by loop-invariant
+// amounts and writes. Returns false for anything else.
+static bool build_render_plan(ASTNode* body_node, LoopRenderPlan* plan, const char** names, int* entry_indexes) {
+    ASTNode** statements = &body_node;
+    int statement_count = 1;
+    if (body_node->type == AST_CODE_BLOCK) {
+        if (body_node->num_children != 1 || body_node->children[0]->type != AST_STATEMENT_LIST) return false;
+        statements = body_node->children[0]->children;
+        statement_count = body_node->children[0]->num_children;
+    }
+
+    // Updated variables first, so reads of them can be told apart from invariant reads
+    plan->op_count = 0;
+    plan->variable_count = 0;
+    for (int i = 0; i < statement_count; ++i) {
+        ASTNode* statement = statements[i];
+        if (statement->type == AST_WRITE_STATEMENT) continue;
+        if ((statement->type != AST_INCREMENT && statement->type != AST_DECREMENT) || statement->num_children != 2 ||
+            statement->children[0]->type != AST_IDENTIFIER) {
+            return false;
+        }
+        const char* name = statement->children[0]->data.identifier.name;
+        if (find_plan_variable(names, plan->variable_count, name) >= 0) continue;
+        if (plan->variable_count >= LOOP_RENDER_MAX_VARIABLES) return false;
+        int idx = find_runtime_symbol(&global_runtime_sym_table, name);
+        if (idx < 0) return false;
+        note_read(name, true);
+        names[plan->variable_count] = name;
+        entry_indexes[plan->variable_count] = idx;
+        big_int_copy(&plan->start_values[plan->variable_count], &global_runtime_sym_table.entries[idx].value);
+        big_int_zero(&plan->steps[plan->variable_count]);
+        plan->variable_count++;
+    }
+
+    bool writes = false;
+    for (int i = 0; i < statement_count; ++i) {
+        ASTNode* statement = statements[i];
+        if (statement->type == AST_WRITE_STATEMENT) {
+            if (statement->num_children != 1 || statement->children[0]->type != AST_OUTPUT_LIST) return false;
+            ASTNode* output_list = statement->children[0];
+            for (int j = 0; j < output_list->num_children; ++j) {
+                if (output_list->children[j]->num_children != 1) return false;
+                ASTNode* content = output_list->children[j]->children[0];
+                bool added = true;
+                if (content->type == AST_STRING_LITERAL) {
+                    added = add_render_text(plan, content->data.constant->text, content->data.constant->length);
+                } else if (content->type == AST_NEWLINE) {
+                    added = add_render_text(plan, "\n", 1);
+                } else if (content->type == AST_INT_VALUE && content->num_children == 1 &&
+                           content->children[0]->type == AST_IDENTIFIER &&
+                           find_plan_variable(names, plan->variable_count, content->children[0]->data.identifier.name) >= 0) {
+                    if (plan->op_count >= LOOP_RENDER_MAX_OPS) return false;
+                    RenderOp* op = &plan->ops[plan->op_count++];
+                    op->type = RENDER_OP_WRITE_VARIABLE;
+                    op->variable = find_plan_variable(names, plan->variable_count, content->children[0]->data.identifier.name);
+                } else {
+                    BigInt value;
+                    char str_buffer[MAX_BIGINT_STRING_LEN + 2];
+                    if (!resolve_invariant_value(content, &value)) return false;
+                    big_int_to_string(&value, str_buffer);
+                    added = add_render_text(plan, str_buffer, strlen(str_buffer));
+                }
+                if (!added) return false;
+                writes = true;
+            }
+        } else {
+            int variable = find_plan_variable(names, plan->variable_count, statement->children[0]->data.identifier.name);
+            ASTNode* operand = statement->children[1];
+            if (operand->type == AST_INT_VALUE && operand->num_children == 1 &&
+                operand->children[0]->type == AST_IDENTIFIER &&
+                find_plan_variable(names, plan->variable_count, operand->children[0]->data.identifier.name) >= 0) {
+                return false; // The amount itself changes inside the loop
+            }
+            if (plan->op_count >= LOOP_RENDER_MAX_OPS) return false;
+            RenderOp* op = &plan->ops[plan->op_count];
+            if (!resolve_invariant_value(operand, &op->delta)) return false;
+            if (statement->type == AST_DECREMENT) {
+                op->delta.sign = -op->delta.sign;
+                big_int_normalize(&op->delta);
+            }
+            op->type = RENDER_OP_ADD;
+            op->variable = variable;
+            plan->op_count++;
+            big_int_add(&plan->steps[variable], &plan->steps[variable], &op->delta);
+        }
+    }
+    return writes;
+}
+
+// Runs a loop through the parallel renderer when its output is a function of
+// the iteration index alone. Returns false, having changed nothing, otherwise.
+static bool try_render_loop(ASTNode* body_node, const BigInt* loop_count) {
+    if (trace_enabled) return false; // Per-iteration traces need the ordinary path
+    for (int i = 1; i < NUM_LIMBS; ++i) {
+        if (loop_count->limbs[i] != 0) return false;
+    }
+    if (loop_count->limbs[0] < LOOP_RENDER_MIN_ITERATIONS || loop_count->limbs[0] > (unsigned long long)LLONG_MAX) {
+        return false;
+    }
+    long long iterations = (long long)loop_count->limbs[0];
+
+    LoopRenderPlan plan;
+    const char* names[LOOP_RENDER_MAX_VARIABLES];
+    int entry_indexes[LOOP_RENDER_MAX_VARIABLES];
+    bool ok = build_render_plan(body_node, &plan, names, entry_indexes);
+
+    // Stay clear of BigInt wrap-around, where closed form and repeated addition disagree
+    for (int v = 0; ok && v < plan.variable_count; ++v) {
+        BigInt magnitude_sum;
+        big_int_zero(&magnitude_sum);
+        for (int i = 0; i < plan.op_count; ++i) {
+            if (plan.ops[i].type == RENDER_OP_ADD && plan.ops[i].variable == v) {
+                big_int_abs_add(&magnitude_sum, &magnitude_sum, &plan.ops[i].delta);
+            }
+        }
+        ok = big_int_bit_length(&plan.start_values[v]) < NUM_LIMBS * 64 - 8 &&
+             big_int_bit_length(&magnitude_sum) + big_int_bit_length(loop_count) < NUM_LIMBS * 64 - 8;
+    }
+    if (!ok) {
+        free_loop_render_plan(&plan);
+        return false;
+    }
+
+    render_loop(&plan, iterations);
+
+    for (int v = 0; v < plan.variable_count; ++v) {
+        RuntimeSymbolEntry* entry = &global_runtime_sym_table.entries[entry_indexes[v]];
+        BigInt total;
+        big_int_mul(&total, &plan.steps[v], loop_count);
+        big_int_add(&entry->value, &plan.start_values[v], &total);
+        if (entry->decimal) entry->decimal->valid = false;
+        note_write(names[v]);
+    }
+    free_loop_render_plan(&plan);
+    return true;
+}
+
+// --- Linear Loop Solving ---
+
+// Builds the plan of a loop body made only of := / += / -= whose operands are
+// literals or variables. Returns false for anything else, including writes.
+static bool build_linear_plan(ASTNode* body_node, LinearLoopPlan* plan, const char** names, int* entry_indexes) {
+    ASTNode** statements = &body_node;
+    int statement_count = 1;
+    if (body_node->type == AST_CODE_BLOCK) {
+        if (body_node->num_children != 1 || body_node->children[0]->type != AST_STATEMENT_LIST) return false;
+        statements = body_node->children[0]->children;
+        statement_count = body_node->children[0]->num_children;
+    }
+
+    // Updated variables first, so reads of them can be told apart from invariant reads
+    linear_loop_init(plan);
+    for (int i = 0; i < statement_count; ++i) {
+        ASTNode* statement = statements[i];
+        if ((statement->type != AST_ASSIGNMENT && statement->type != AST_INCREMENT && statement->type != AST_DECREMENT) ||
+            statement->num_children != 2 || statement->children[0]->type != AST_IDENTIFIER) {
+            return false;
+        }
+        const char* name = statement->children[0]->data.identifier.name;
+        if (find_plan_variable(names, plan->variable_count, name) >= 0) continue;
+        if (plan->variable_count >= LINEAR_LOOP_MAX_VARIABLES) return false;
+        int idx = find_runtime_symbol(&global_runtime_sym_table, name);
+        if (idx < 0) return false;
+        note_read(name, true);
+        names[plan->variable_count] = name;
+        entry_indexes[plan->variable_count] = idx;
+        linear_loop_add_variable(plan, &global_runtime_sym_table.entries[idx].value);
+    }
+
+    for (int i = 0; i < statement_count; ++i) {
+        ASTNode* statement = statements[i];
+        int target = find_plan_variable(names, plan->variable_count, statement->children[0]->data.identifier.name);
+        ASTNode* operand = statement->children[1];
+        int source = -1;
+        BigInt factor;
+        if (operand->type == AST_INT_VALUE && operand->num_children == 1 && operand->children[0]->type == AST_IDENTIFIER) {
+            source = find_plan_variable(names, plan->variable_count, operand->children[0]->data.identifier.name);
+        }
+        if (source >= 0) {
+            big_int_from_long_long(&factor, 1);
+        } else {
+            source = plan->variable_count; // The constant coordinate
+            if (!resolve_invariant_value(operand, &factor)) return false;
+        }
+        if (statement->type == AST_DECREMENT) {
+            factor.sign = -factor.sign;
+            big_int_normalize(&factor);
+        }
+        if (!linear_loop_append(plan, target, statement->type == AST_ASSIGNMENT, source, &factor)) return false;
+    }
+    return true;
+}
+
+// Runs a long loop whose body updates variables linearly in each other with
+// O(log N) matrix products. Returns false, having changed nothing, otherwise.
+static bool try_solve_linear_loop(ASTNode* body_node, const BigInt* loop_count) {
+    if (trace_enabled) return false; // Per-iteration traces need the ordinary path
+    bool long_loop = loop_count->limbs[0] >= LINEAR_LOOP_MIN_ITERATIONS;
+    for (int i = 1; i < NUM_LIMBS; ++i) {
+        if (loop_count->limbs[i] != 0) long_loop = true;
+    }
+    if (!long_loop) return false;
+
+    LinearLoopPlan plan;
+    const char* names[LINEAR_LOOP_MAX_VARIABLES];
+    int entry_indexes[LINEAR_LOOP_MAX_VARIABLES];
+    BigInt values[LINEAR_LOOP_MAX_VARIABLES];
+    if (!build_linear_plan(body_node, &plan, names, entry_indexes) || !linear_loop_solve(&plan, loop_count, values)) {
+        return false;
+    }
+
+    for (int v = 0; v < plan.variable_count; ++v) {
+        RuntimeSymbolEntry* entry = &global_runtime_sym_table.entries[entry_indexes[v]];
+        big_int_copy(&entry->value, &values[v]);
+        if (entry->decimal) entry->decimal->valid = false;
+        note_write(names[v]);
+    }
+    return true;
+}
+
+// Like evaluate_big_int_value, but a literal is used in place instead of being
+// copied into scratch, which matters for updates run on every loop iteration
+static const BigInt* evaluate_operand(ASTNode* node, BigInt* scratch) {
+    if (node && node->type == AST_INT_VALUE && node->num_children == 1 &&
+        node->children[0]->type == AST_INTEGER_LITERAL) {
+        return &node->children[0]->data.constant->value;
+    }
+    evaluate_big_int_value(node, scratch);
+    return scratch;
+}
+
+// --- Batched Updates ---
+
+// Shortest run of updates worth batching
+#define UPDATE_BATCH_MIN_RUN 4
+
+// Consecutive += / -= statements with small literal amounts on distinct variables
+typedef struct {
+    int start;                // Index of its first statement in the list
+    int length;               // Statements (lanes) in the run
+    int first_lane;           // Where its lanes start in the plan's lane arrays
+    unsigned long generation; // Environment its entries were resolved in
+} UpdateRun;
+
+struct UpdateBatchPlan {
+    int statement_count;      // Length of the list when the plan was built
+    int run_count;
+    int lane_count;
+    UpdateRun* runs;          // The arrays below live in the same allocation as the plan
+    BigInt* big_deltas;       // Signed amount of each lane
+    long long* deltas;        // The same, for the vector path
+    const char** names;       // Target of each lane (owned by the AST)
+    int* entries;             // Runtime entry of each lane, valid for its run's generation
+};
+
+static bool is_small_update(const ASTNode* statement) {
+    if ((statement->type != AST_INCREMENT && statement->type != AST_DECREMENT) || statement->num_children != 2 ||
+        statement->children[0]->type != AST_IDENTIFIER) {
+        return false;
+    }
+    const ASTNode* operand = statement->children[1];
+    if (operand->type != AST_INT_VALUE || operand->num_children != 1 ||
+        operand->children[0]->type != AST_INTEGER_LITERAL) {
+        return false;
+    }
+    const BigInt* amount = &operand->children[0]->data.constant->value;
+    for (int i = 1; i < NUM_LIMBS; ++i) {
+        if (amount->limbs[i] != 0) return false;
+    }
+    return amount->limbs[0] < (unsigned long long)BATCH_SMALL_LIMIT;
+}
+
+// Length of the run of small updates on distinct variables starting at start
+static int update_run_length(const ASTNode* list, int start) {
+    int length = 0;
+    while (start + length < list->num_children && length < BATCH_MAX_LANES &&
+           is_small_update(list->children[start + length])) {
+        const char* name = list->children[start + length]->children[0]->data.identifier.name;
+        for (int i = start; i < start + length; ++i) {
+            if (strcmp(list->children[i]->children[0]->data.identifier.name, name) == 0) return length;
+        }
+        length++;
+    }
+    return length;
+}
+
+static struct UpdateBatchPlan* build_update_plan(const ASTNode* list) {
+    int run_count = 0, lane_count = 0;
+    for (int i = 0; i < list->num_children;) {
+        int length = update_run_length(list, i);
+        if (length >= UPDATE_BATCH_MIN_RUN) {
+            run_count++;
+            lane_count += length;
+        }
+        i += length > 0 ? length : 1;
+    }
+
+    // Every array holds 8-byte aligned elements except the trailing ints
+    size_t size = sizeof(struct UpdateBatchPlan) + lane_count * (sizeof(BigInt) + sizeof(long long) + sizeof(char*) + sizeof(int)) +
+                  run_count * sizeof(UpdateRun);
+    struct UpdateBatchPlan* plan = (struct UpdateBatchPlan*)malloc(size);
+    if (!plan) {
+        fprintf(stderr, "Memory allocation failed for update batch plan.\n");
+        exit(EXIT_FAILURE);
+    }
+    plan->statement_count = list->num_children;
+    plan->run_count = run_count;
+    plan->lane_count = lane_count;
+    plan->big_deltas = (BigInt*)(plan + 1);
+    plan->deltas = (long long*)(plan->big_deltas + lane_count);
+    plan->names = (const char**)(plan->deltas + lane_count);
+    plan->runs = (UpdateRun*)(plan->names + lane_count);
+    plan->entries = (int*)(plan->runs + run_count);
+
+    int run = 0, lane = 0;
+    for (int i = 0; i < list->num_children;) {
+        int length = update_run_length(list, i);
+        if (length >= UPDATE_BATCH_MIN_RUN) {
+            plan->runs[run].start = i;
+            plan->runs[run].length = length;
+            plan->runs[run].first_lane = lane;
+            plan->runs[run].generation = 0;
+            run++;
+            for (int j = i; j < i + length; ++j, ++lane) {
+                const ASTNode* statement = list->children[j];
+                BigInt* amount = &plan->big_deltas[lane];
+                big_int_copy(amount, &statement->children[1]->children[0]->data.constant->value);
+                if (statement->type == AST_DECREMENT) {
+                    amount->sign = -amount->sign;
+                    big_int_normalize(amount);
+                }
+                plan->deltas[lane] = amount->sign < 0 ? -(long long)amount->limbs[0] : (long long)amount->limbs[0];
+                plan->names[lane] = statement->children[0]->data.identifier.name;
+            }
+        }
+        i += length > 0 ? length : 1;
+    }
+    return plan;
+}
+
+// Applies a run of updates with one vector add over the variables' values.
+// Lanes holding or producing large values are redone with BigInt. Returns false
+// (having changed nothing) if a target is not declared, so the statements run
+// one by one and report it.
+static bool run_update_batch(struct UpdateBatchPlan* plan, UpdateRun* run) {
+    RuntimeSymbolTable* table = &global_runtime_sym_table;
+    int* entries = plan->entries + run->first_lane;
+    if (run->generation != environment_generation) {
+        for (int l = 0; l < run->length; ++l) {
+            entries[l] = find_runtime_symbol(table, plan->names[run->first_lane + l]);
+            if (entries[l] < 0) return false;
+        }
+        run->generation = environment_generation;
+    }
+
+    long long values[BATCH_MAX_LANES];
+    long long deltas[BATCH_MAX_LANES];
+    unsigned long long slow = 0; // Lanes done with BigInt
+    for (int l = 0; l < run->length; ++l) {
+        const BigInt* value = &table->entries[entries[l]].value;
+        bool small = value->limbs[0] < (unsigned long long)BATCH_SMALL_LIMIT;
+        for (int i = 1; small && i < NUM_LIMBS; ++i) small = value->limbs[i] == 0;
+        if (small) {
+            values[l] = value->sign < 0 ? -(long long)value->limbs[0] : (long long)value->limbs[0];
+            deltas[l] = plan->deltas[run->first_lane + l];
+        } else {
+            values[l] = 0;
+            deltas[l] = 0;
+            slow |= 1ULL << l;
+        }
+    }
+    slow |= batch_add_small(values, deltas, run->length);
+
+    for (int l = 0; l < run->length; ++l) {
+        RuntimeSymbolEntry* entry = &table->entries[entries[l]];
+        const BigInt* amount = &plan->big_deltas[run->first_lane + l];
+        if (slow & (1ULL << l)) {
+            big_int_add(&entry->value, &entry->value, amount);
+        } else {
+            // Small values have no higher limbs to clear
+            entry->value.sign = values[l] < 0 ? -1 : 1;
+            entry->value.limbs[0] = values[l] < 0 ? 0ULL - (unsigned long long)values[l] : (unsigned long long)values[l];
+        }
+        if (entry->decimal && entry->decimal->valid && !decimal_cache_add(entry->decimal, amount, 1)) {
+            entry->decimal->valid = false;
+        }
+    }
+    return true;
+}
+
+// --- Statement Executor ---
+
+static void grow_exec_stack(ExecStack* stack) {
+    int new_capacity = stack->capacity * 2;
+    ExecFrame* frames;
+    if (stack->frames == stack->inline_frames) {
+        frames = (ExecFrame*)malloc(new_capacity * sizeof(ExecFrame));
+        if (frames) memcpy(frames, stack->inline_frames, stack->count * sizeof(ExecFrame));
+    } else {
+        frames = (ExecFrame*)realloc(stack->frames, new_capacity * sizeof(ExecFrame));
+    }
+    if (!frames) {
+        fprintf(stderr, "Memory allocation failed for interpreter frames.\n");
+        exit(EXIT_FAILURE);
+    }
+    stack->frames = frames;
+    stack->capacity = new_capacity;
+}
+
+static inline ExecFrame* push_frame(ExecStack* stack, ASTNode* node) {
+    if (stack->count >= stack->capacity) grow_exec_stack(stack);
+    ExecFrame* frame = &stack->frames[stack->count++];
+    frame->node = node;
+    return frame;
+}
+
+// Evaluates the count and either finishes the loop at once (skipped, or run by
+// the parallel renderer or the linear solver) or pushes a frame that iterates it
+static void begin_loop_statement(ExecStack* stack, ASTNode* node) {
+    // Loop statement structure: AST_LOOP_STATEMENT (with data.loop.count_expr and data.loop.body)
+    if (!node || node->type != AST_LOOP_STATEMENT || !node->data.loop.count_expr || !node->data.loop.body) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_LOOP_STATEMENT node structure. Missing count_expr or body.\n");
+        return;
+    }
+
+    ASTNode* count_expr_node = node->data.loop.count_expr;
+    ASTNode* body_node = node->data.loop.body;
+
+    // Evaluate the initial loop count. This will be the *effective* number of times the loop runs.
+    BigInt loop_count;
+    evaluate_big_int_value(count_expr_node, &loop_count);
+
+    BigInt zero;
+    big_int_zero(&zero);
+
+    // Check for negative loop count
+    if (loop_count.sign == -1) {
+        fprintf(stderr, "Runtime Error: Loop count cannot be negative at line %d, column %d%s. Skipping loop.\n",
+                node->location.line, node->location.column, runtime_error_unit(node));
+        return;
+    }
+
+    // If initial count is zero, skip the loop entirely
+    if (big_int_abs_compare(&loop_count, &zero) == 0) {
+        if (trace_enabled) printf("[DEBUG] Interpreting loop statement (count: 0, skipping loop).\n");
+        return;
+    }
+
+    if (trace_enabled) {
+        printf("[DEBUG] Interpreting loop statement (BigInt count: ");
+        big_int_print(&loop_count);
+        printf(").\n");
+    }
+
+    if (try_render_loop(body_node, &loop_count)) return;
+    if (try_solve_linear_loop(body_node, &loop_count)) return;
+
+    ExecFrame* frame = push_frame(stack, node);
+    big_int_copy(&frame->count, &loop_count);
+    big_int_zero(&frame->iteration);
+    frame->body_running = false;
+    frame->list = NULL;
+    if (metrics_segment) metrics_set_loop(stack->count, 0);
+}
+
+// Starts one run of a loop's block body; an invalid block leaves frame->list NULL
+static void begin_code_block(ExecFrame* frame, ASTNode* node) {
+    frame->list = NULL;
+    if (!node || node->type != AST_CODE_BLOCK || node->num_children != 1 || node->children[0]->type != AST_STATEMENT_LIST) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_CODE_BLOCK node structure.\n");
+        return;
+    }
+    if (trace_enabled) printf("[DEBUG] Entering code block.\n");
+
+    // Runs of small updates are taken in batches
+    ASTNode* list = node->children[0];
+    struct UpdateBatchPlan* plan = NULL;
+    if (!trace_enabled && !active_access_log) {
+        plan = list->data.update_plan;
+        if (!plan || plan->statement_count != list->num_children) {
+            free(plan);
+            plan = list->data.update_plan = build_update_plan(list);
+        }
+    }
+
+    frame->list = list;
+    frame->plan = plan;
+    frame->index = 0;
+    frame->next_run = 0;
+}
+
+// Steps the innermost loop until every frame is done. Statements that push
+// nothing run in place, and a block body is restarted without leaving the
+// frame; control only returns to the outer loop when a nested loop is pushed
+// or the frame finishes. Since pushing may move the frames, a frame's fields
+// are updated before anything is pushed and it is looked up again afterwards.
+static void run_exec_stack(ExecStack* stack) {
+    BigInt one;
+    big_int_from_long_long(&one, 1);
+
+    while (stack->count > 0) {
+        int depth = stack->count;
+        ExecFrame* frame = &stack->frames[depth - 1];
+        ASTNode* body_node = frame->node->data.loop.body;
+        bool pushed = false;
+
+        while (!pushed) {
+            if (frame->body_running) {
+                ASTNode* list = frame->list;
+                if (list) {
+                    // Continue the block where it stopped. The position lives in
+                    // locals and is stored back before a nested loop can push.
+                    struct UpdateBatchPlan* plan = frame->plan;
+                    int index = frame->index, next_run = frame->next_run;
+                    while (index < list->num_children) {
+                        if (plan && next_run < plan->run_count && plan->runs[next_run].start == index) {
+                            UpdateRun* run = &plan->runs[next_run++];
+                            if (run_update_batch(plan, run)) {
+                                if (metrics_segment) metrics_add_statements((uint64_t)run->length);
+                                index += run->length;
+                                continue;
+                            }
+                        }
+                        ASTNode* statement = list->children[index++];
+                        if (statement->type == AST_LOOP_STATEMENT) {
+                            frame->index = index;
+                            frame->next_run = next_run;
+                            begin_statement(stack, statement);
+                            if (stack->count != depth) break;
+                        } else {
+                            begin_statement(stack, statement);
+                        }
+                    }
+                    if (stack->count != depth) {
+                        pushed = true;
+                        continue;
+                    }
+                    frame->list = NULL;
+                    if (trace_enabled) printf("[DEBUG] Exiting code block.\n\n"); // Added newline for clarity
+                }
+                frame->body_running = false;
+                big_int_add(&frame->iteration, &frame->iteration, &one); // Increment internal counter for loop iterations
+                if (metrics_segment) metrics_set_loop(depth, frame->iteration.limbs[0]);
+                if (trace_enabled) {
+                    printf("[DEBUG] Loop iteration count: "); // Debug for loop
+                    big_int_print(&frame->iteration);
+                    printf(".\n");
+                }
+            }
+
+            if (body_node->type != AST_CODE_BLOCK && body_node->type != AST_LOOP_STATEMENT) {
+                // A simple body never pushes, so the remaining iterations run right here
+                BigInt iteration = frame->iteration;
+                while (big_int_abs_compare(&iteration, &frame->count) < 0) {
+                    begin_statement(stack, body_node);
+                    big_int_add(&iteration, &iteration, &one);
+                    if (metrics_segment) metrics_set_loop(depth, iteration.limbs[0]);
+                    if (trace_enabled) {
+                        printf("[DEBUG] Loop iteration count: ");
+                        big_int_print(&iteration);
+                        printf(".\n");
+                    }
+                }
+                frame->iteration = iteration;
+                break;
+            }
+
+            // Loop as long as iteration < count
+            if (big_int_abs_compare(&frame->iteration, &frame->count) >= 0) break;
+            frame->body_running = true;
+            if (body_node->type == AST_CODE_BLOCK) {
+                begin_code_block(frame, body_node);
+            } else {
+                begin_statement(stack, body_node);
+                if (stack->count != depth) pushed = true;
+            }
+        }
+        if (pushed) continue;
+
+        if (trace_enabled) {
+            printf("[DEBUG] Loop finished. Iterations completed: ");
+            big_int_print(&frame->iteration);
+            printf(".\n");
+        }
+        stack->count--;
+        if (metrics_segment) {
+            metrics_set_loop(stack->count, stack->count > 0 ? stack->frames[stack->count - 1].iteration.limbs[0] : 0);
+        }
+    }
+}
+
+// Evaluates an <int_value> AST node to its BigInt value
+static void evaluate_big_int_value(ASTNode* node, BigInt* result) {
+    if (!node || node->type != AST_INT_VALUE || node->num_children != 1) {
+        fprintf(stderr, "Interpreter Error: Invalid AST_INT_VALUE node structure. Expected one child.\n");
+        big_int_zero(result);
+        return;
+    }
+
+    ASTNode* child = node->children[0];
+    if (child->type == AST_INTEGER_LITERAL) {
+        big_int_copy(result, &child->data.constant->value);
+    } else if (child->type == AST_IDENTIFIER) {
+        char* var_name = child->data.identifier.name;
+        note_read(var_name, true);
+        if (!lookup_runtime_symbol(&global_runtime_sym_table, var_name, result)) {
+            if (find_vector(var_name)) {
+                note_vector_use();
+                fprintf(stderr, "Runtime Error: Vector '%s' used as a number at line %d, column %d%s.\n",
+                        var_name, node->location.line, node->location.column, runtime_error_unit(node));
+            } else {
+                fprintf(stderr, "Runtime Error: Undeclared variable '%s' used in expression at line %d, column %d%s.\n",
+                        var_name, node->location.line, node->location.column, runtime_error_unit(node));
+            }
+            big_int_zero(result); // Return 0 for undeclared variable
+        }
+    } else {
+        fprintf(stderr, "Interpreter Error: Invalid child type for AST_INT_VALUE: %d\n", child->type);
+        big_int_zero(result);
+    }
+}
@@ -1,47 +1,126 @@
-#ifndef INTERPRETER_H
-#define INTERPRETER_H
-
-#include "parser.h" // To access ASTNode structures and types
-#include "bigint.h"
-#include <stdbool.h> // For bool
-#include <stdio.h>   // For FILE, printf
-
-// --- Runtime Symbol Table (Environment) Declarations ---
-typedef struct {
-    char* name;
-    BigInt value; // Change to BigInt by value
-} RuntimeSymbolEntry;
-
-typedef struct {
-    RuntimeSymbolEntry* entries;
-    int count;
-    int capacity;
-} RuntimeSymbolTable;
-
-// Function declarations for managing the runtime symbol table
-void init_runtime_symbol_table(RuntimeSymbolTable* table);
-// Change value to const BigInt*
-void add_or_update_runtime_symbol(RuntimeSymbolTable* table, const char* name, const BigInt* value);
-// Change out_value to BigInt*
-bool lookup_runtime_symbol(RuntimeSymbolTable* table, const char* name, BigInt* out_value);
-void free_runtime_symbol_table(RuntimeSymbolTable* table);
-
-// --- Main Interpreter Function Declaration ---
-void interpret_program(ASTNode* root_node);
-
-// BigInt specific functions (some moved/renamed/added)
-void big_int_zero(BigInt *num);
-int big_int_abs_compare(const BigInt *a, const BigInt *b); // 0: a==b, 1: a>b, -1: a<b
-void big_int_abs_add(BigInt *result, const BigInt *a, const BigInt *b);
-void big_int_abs_sub(BigInt *result, const BigInt *a, const BigInt *b);
-void big_int_normalize(BigInt *num);
-void big_int_add(BigInt *result, const BigInt *a, const BigInt *b);
-void big_int_sub(BigInt *result, const BigInt *a, const BigInt *b);
-void big_int_copy(BigInt *dest, const BigInt *src);
-void big_int_from_long_long(BigInt *num, long long val); // New: Convert long long to BigInt
-bool big_int_to_long_long(const BigInt *num, long long* out_val); // New: Convert BigInt to long long, with overflow check
-void big_int_from_string(BigInt *num, const char *str); // Already declared, now implemented
-void big_int_to_string(const BigInt *num, char *str_buffer); // Already declared, now implemented
-void big_int_print(const BigInt *num); // Already declared, likely useful for debugging
-
-#endif // INTERPRETER_H
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include "parser.h" // To access ASTNode structures and types
+#include "bigint.h"
+#include <stdbool.h> // For bool
+#include <stdio.h>   // For FILE, printf
+
+// --- Runtime Symbol Table (Environment) Declarations ---
+// Longest decimal text kept in step by small updates; beyond it, writes convert the BigInt.
+// Every value of this many digits is below 2^384, so the text never has to mirror the
+// BigInt wrapping around: an update that would need another digit refills from the BigInt.
+#define DECIMAL_CACHE_DIGITS MAX_BIGINT_LITERAL_DIGITS
+// Largest |delta| of a += / -= that is applied to the decimal text directly
+#define DECIMAL_CACHE_MAX_STEP 1000000000000000000ULL
+
+// Decimal text of a variable that is written out. Small += / -= updates are
+// applied to the digits directly, so writing the variable is a plain copy.
+typedef struct {
+    char text[DECIMAL_CACHE_DIGITS + 1]; // Right-aligned digits, with room for a leading '-'
+    int start;                           // Index of the most significant digit
+    int sign;                            // 1 or -1 (zero is positive)
+    bool valid;                          // False once the value changed in a way not mirrored here
+} DecimalCache;
+
+// Sets the cache from a value (valid only if the value fits in DECIMAL_CACHE_DIGITS)
+void decimal_cache_fill(DecimalCache* cache, const BigInt* value);
+// Applies value += direction * delta to the digits; false if the cache must be refilled
+bool decimal_cache_add(DecimalCache* cache, const BigInt* delta, int direction);
+
+typedef struct {
+    char* name;
+    BigInt value; // Change to BigInt by value
+    DecimalCache* decimal; // Allocated the first time the variable is written out
+} RuntimeSymbolEntry;
+
+typedef struct {
+    RuntimeSymbolEntry* entries;
+    int count;
+    int capacity;
+    int* index;          // Open-addressing hash index into entries (-1 = empty slot)
+    int index_capacity;  // Number of slots in index (power of two, at least twice count)
+} RuntimeSymbolTable;
+
+// Function declarations for managing the runtime symbol table
+void init_runtime_symbol_table(RuntimeSymbolTable* table);
+// Change value to const BigInt*
+void add_or_update_runtime_symbol(RuntimeSymbolTable* table, const char* name, const BigInt* value);
+// Change out_value to BigInt*
+bool lookup_runtime_symbol(RuntimeSymbolTable* table, const char* name, BigInt* out_value);
+// Returns the entry index of a variable, or -1 if it is not declared
+int find_runtime_symbol(const RuntimeSymbolTable* table, const char* name);
+void free_runtime_symbol_table(RuntimeSymbolTable* table);
+
+// --- Variable Access Tracking ---
+// One variable a statement depended on (reads) or changed (writes)
+typedef struct {
+    char* name;
+    bool declared;    // Reads: declared at statement entry. Writes: declared afterwards.
+    bool value_used;  // Reads only: false if just the variable's existence mattered
+    BigInt value;     // Reads: value at statement entry. Writes: value afterwards.
+} VariableAccess;
+
+// Read and write sets of one top-level statement, filled while it executes
+typedef struct {
+    VariableAccess* reads;
+    int read_count;
+    int read_capacity;
+    VariableAccess* writes;
+    int write_count;
+    int write_capacity;
+    bool consumed_input; // Ran a read statement, so its effects depend on the input too
+    bool touched_vector; // Declared, used or changed a vector, which the log does not record
+} AccessLog;
+
+void access_log_clear(AccessLog* log);
+void access_log_free(AccessLog* log);
+
+// --- Main Interpreter Function Declaration ---
+void interpret_program(ASTNode* root_node);
+
+// Session-style execution: begin, feed top-level statements in order, end.
+// With a store open (store.h), end commits the variables to it first.
+void interpreter_begin(void);
+void interpret_top_level_statement(ASTNode* node);
+void interpreter_end(void);
+
+// Dependency tracking: while a log is set, interpret_top_level_statement records
+// into it what the statement read and wrote (NULL stops recording).
+void interpreter_set_access_log(AccessLog* log);
+// True if every variable in the log's read set still has its recorded entry state
+// (never for a statement that consumed input or touched a vector)
+bool interpreter_reads_match(const AccessLog* log);
+// Applies a statement's recorded writes to the environment instead of running it
+void interpreter_apply_writes(const AccessLog* log);
+// Current value of a variable (out_value may be NULL); false if it is not declared
+bool interpreter_get_variable(const char* name, BigInt* out_value);
+// Drops every variable, as if a new program were starting
+void interpreter_reset_environment(void);
+// Declarations of the listed names start at the matching value instead of 0
+// (count 0 restores plain declarations); the arrays must outlive their use
+void interpreter_set_bindings(char* const* names, const BigInt* values, int count);
+// Path the nodes of the script being run are located in. Runtime errors in
+// statements linked from an included file (units.h) name that file too:
+// runtime_error_unit gives " in 'FILE'" for them ("" otherwise), which the
+// messages put right after the line and column.
+void interpreter_set_script_path(const char* path);
+const char* runtime_error_unit(const ASTNode* node);
+
+// BigInt specific functions (some moved/renamed/added)
+void big_int_zero(BigInt *num);
+int big_int_abs_compare(const BigInt *a, const BigInt *b); // 0: a==b, 1: a>b, -1: a<b
+void big_int_abs_add(BigInt *result, const BigInt *a, const BigInt *b);
+void big_int_abs_sub(BigInt *result, const BigInt *a, const BigInt *b);
+void big_int_normalize(BigInt *num);
+void big_int_add(BigInt *result, const BigInt *a, const BigInt *b);
+void big_int_sub(BigInt *result, const BigInt *a, const BigInt *b);
+void big_int_mul(BigInt *result, const BigInt *a, const BigInt *b);
+void big_int_copy(BigInt *dest, const BigInt *src);
+void big_int_from_long_long(BigInt *num, long long val); // New: Convert long long to BigInt
+bool big_int_to_long_long(const BigInt *num, long long* out_val); // New: Convert BigInt to long long, with overflow check
+void big_int_from_string(BigInt *num, const char *str); // Already declared, now implemented
+void big_int_to_string(const BigInt *num, char *str_buffer); // Already declared, now implemented
+void big_int_print(const BigInt *num); // Already declared, likely useful for debugging
+
+#endif // INTERPRETER_H
@@ -5,24 +5,43 @@
 #include <ctype.h>
 #include "bigint.h"
 #include "lexer.h"
+#include "strscan.h"
+
+bool trace_enabled = true;
 
 // LEXER INITIALIZATION
 /*****************************************************************************/
 void init_lexer(LexContext* ctx, FILE* input, const char* filename) {
     ctx->input = input;
+    ctx->source = NULL;
+    ctx->source_length = 0;
+    ctx->source_pos = 0;
     ctx->buffer_pos = 0;
     ctx->buffer_size = 0;
     ctx->current_char = 0;
     ctx->lexeme_length = 0;
+    ctx->literal = NULL;
+    ctx->literal_capacity = 0;
     ctx->symbol_count = 0;
     ctx->keyword_count = 0;
+    ctx->report_errors = true;
+    ctx->intern_strings = true;
 
     ctx->location.line = 1;
     ctx->location.column = 0;
+    ctx->location.offset = 0;
     ctx->location.filename = filename;
 
-    // Initialize symbol table with zeros
-    memset(ctx->symbol_table, 0, sizeof(ctx->symbol_table));
+    // Allocate the symbol table and its hash index; both grow on demand
+    ctx->symbol_capacity = SYMBOL_TABLE_SIZE;
+    ctx->symbol_table = (SymbolEntry*)calloc(ctx->symbol_capacity, sizeof(SymbolEntry));
+    ctx->symbol_hash_capacity = SYMBOL_TABLE_SIZE * 2;
+    ctx->symbol_hash = (int*)malloc(ctx->symbol_hash_capacity * sizeof(int));
+    if (!ctx->symbol_table || !ctx->symbol_hash) {
+        fprintf(stderr, "Memory allocation failed for lexer symbol table.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(ctx->symbol_hash, -1, ctx->symbol_hash_capacity * sizeof(int));
 
     // Initialize the transition table for the FSM
     setup_transition_table(ctx);
@@ -34,6 +53,23 @@ void init_lexer(LexContext* ctx, FILE* input, const char* filename) {
     add_keyword(ctx, "newline", TOKEN_NEWLINE);
     add_keyword(ctx, "times", TOKEN_TIMES);
     add_keyword(ctx, "number", TOKEN_NUMBER);
+    add_keyword(ctx, "read", TOKEN_READ);
+    add_keyword(ctx, "vector", TOKEN_VECTOR);
+    add_keyword(ctx, "include", TOKEN_INCLUDE);
+}
+
+// Switches the lexer to an in-memory string, keeping the symbol table and the
+// transition table. The location keeps counting, so diagnostics stay unique
+// across consecutive inputs (e.g. REPL entries).
+void lexer_set_input_string(LexContext* ctx, const char* text, size_t length) {
+    ctx->input = NULL;
+    ctx->source = text;
+    ctx->source_length = length;
+    ctx->source_pos = 0;
+    ctx->buffer_pos = 0;
+    ctx->buffer_size = 0;
+    ctx->current_char = 0;
+    ctx->lexeme_length = 0;
 }
 
 // SETUP THE TRANSITION TABLE FUNCTION (FINITE STATE MACHINE LOGIC)
@@ -105,6 +141,7 @@ void setup_transition_table(LexContext* ctx) {
     }
 
     // STRING STATE TRANSITIONS: continues until another '"' is found
+    // (get_next_token hands this state to lex_string_literal, which scans it in bulk)
     ctx->transition_table[STATE_STRING][CHAR_QUOTE] = STATE_FINAL; // End of string
     ctx->transition_table[STATE_STRING][CHAR_EOF] = STATE_ERROR; // String left open
     // Any other character is part of the string
@@ -152,19 +189,31 @@ CharClass get_char_class(int c) {
     return CHAR_OTHER; // Unrecognized character
 }
 
+// Refills the (fully consumed) buffer; false at the end of the input
+static bool fill_buffer(LexContext* ctx) {
+    if (ctx->input) {
+        ctx->buffer_size = fread(ctx->buffer, 1, sizeof(ctx->buffer), ctx->input);
+    } else {
+        size_t remaining = ctx->source_length - ctx->source_pos;
+        size_t chunk = remaining < sizeof(ctx->buffer) ? remaining : sizeof(ctx->buffer);
+        memcpy(ctx->buffer, ctx->source + ctx->source_pos, chunk);
+        ctx->source_pos += chunk;
+        ctx->buffer_size = (int)chunk;
+    }
+    ctx->buffer_pos = 0;
+    return ctx->buffer_size > 0;
+}
+
 // Reads the next character from the input stream, using a buffer
 int next_char(LexContext* ctx) {
     // Fill buffer if empty
-    if (ctx->buffer_pos >= ctx->buffer_size) {
-        ctx->buffer_size = fread(ctx->buffer, 1, sizeof(ctx->buffer), ctx->input);
-        ctx->buffer_pos = 0;
-        if (ctx->buffer_size == 0) {
-            return EOF; // End of file
-        }
+    if (ctx->buffer_pos >= ctx->buffer_size && !fill_buffer(ctx)) {
+        return EOF; // End of file
     }
 
     // Get the next character and update location for error reporting
     int c = ctx->buffer[ctx->buffer_pos++];
+    ctx->location.offset++;
 
     if (c == '\n') {
         ctx->location.line++;
@@ -180,6 +229,7 @@ int next_char(LexContext* ctx) {
 void unget_char(LexContext* ctx) {
     if (ctx->buffer_pos > 0) {
         ctx->buffer_pos--;
+        ctx->location.offset--;
         // Adjust location accordingly
         if (ctx->buffer[ctx->buffer_pos] == '\n') {
             ctx->location.line--;
@@ -191,8 +241,27 @@ void unget_char(LexContext* ctx) {
     }
 }
 
+// FNV-1a hash of a symbol name, used by the symbol table index
+static unsigned int hash_symbol_name(const char* name) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; ++p) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+// Inserts a symbol table index into the hash index (name must not be present yet)
+static void index_symbol(LexContext* ctx, int symbol_idx) {
+    unsigned int mask = (unsigned int)ctx->symbol_hash_capacity - 1;
+    unsigned int slot = hash_symbol_name(ctx->symbol_table[symbol_idx].name) & mask;
+    while (ctx->symbol_hash[slot] != -1) {
+        slot = (slot + 1) & mask;
+    }
+    ctx->symbol_hash[slot] = symbol_idx;
+}
+
 // Adds a new symbol (identifier or keyword) to the symbol table
-// Returns the index of the symbol in the table, or -1 if table is full
+// Returns the index of the symbol in the table, or -1 if memory runs out
 int add_to_symbol_table(LexContext* ctx, const char* name, TokenType type, bool is_keyword) {
     // First, check if the symbol already exists to avoid duplicates
     int index = lookup_symbol(ctx, name);
@@ -200,30 +269,174 @@ int add_to_symbol_table(LexContext* ctx, const char* name, TokenType type, bool
         return index; // Return existing index
     }
 
-    // Add new symbol if space is available
-    if (ctx->symbol_count < SYMBOL_TABLE_SIZE) {
-        ctx->symbol_table[ctx->symbol_count].name = strdup(name); // Duplicate string
-        ctx->symbol_table[ctx->symbol_count].type = type;
-        ctx->symbol_table[ctx->symbol_count].is_keyword = is_keyword;
-        return ctx->symbol_count++; // Return new index and increment count
+    // Grow the table when full
+    if (ctx->symbol_count >= ctx->symbol_capacity) {
+        int new_capacity = ctx->symbol_capacity * 2;
+        SymbolEntry* new_table = (SymbolEntry*)realloc(ctx->symbol_table, new_capacity * sizeof(SymbolEntry));
+        if (!new_table) {
+            report_error(ctx, "Symbol table overflow");
+            return -1;
+        }
+        ctx->symbol_table = new_table;
+        ctx->symbol_capacity = new_capacity;
+    }
+    // Keep the hash index at most half full
+    if ((ctx->symbol_count + 1) * 2 > ctx->symbol_hash_capacity) {
+        int new_hash_capacity = ctx->symbol_hash_capacity * 2;
+        int* new_hash = (int*)malloc(new_hash_capacity * sizeof(int));
+        if (!new_hash) {
+            report_error(ctx, "Symbol table overflow");
+            return -1;
+        }
+        free(ctx->symbol_hash);
+        ctx->symbol_hash = new_hash;
+        ctx->symbol_hash_capacity = new_hash_capacity;
+        memset(ctx->symbol_hash, -1, new_hash_capacity * sizeof(int));
+        for (int i = 0; i < ctx->symbol_count; i++) {
+            index_symbol(ctx, i);
+        }
     }
 
-    // Symbol table full error
-    report_error(ctx, "Symbol table overflow");
-    return -1;
+    ctx->symbol_table[ctx->symbol_count].name = strdup(name); // Duplicate string
+    ctx->symbol_table[ctx->symbol_count].type = type;
+    ctx->symbol_table[ctx->symbol_count].is_keyword = is_keyword;
+    index_symbol(ctx, ctx->symbol_count);
+    return ctx->symbol_count++; // Return new index and increment count
 }
 
 // Looks up a symbol by name in the symbol table
 // Returns the index of the symbol, or -1 if not found
 int lookup_symbol(LexContext* ctx, const char* name) {
-    for (int i = 0; i < ctx->symbol_count; i++) {
+    unsigned int mask = (unsigned int)ctx->symbol_hash_capacity - 1;
+    unsigned int slot = hash_symbol_name(name) & mask;
+    while (ctx->symbol_hash[slot] != -1) {
+        int i = ctx->symbol_hash[slot];
         if (strcmp(ctx->symbol_table[i].name, name) == 0) {
             return i;
         }
+        slot = (slot + 1) & mask;
     }
     return -1; // Not found
 }
 
+// STRING LITERALS
+/*****************************************************************************/
+static void report_error_at(LexContext* ctx, SourceLocation location, const char* message);
+
+// Moves location over text[0, length) of the input, as next_char would byte by byte
+static void advance_location(SourceLocation* location, const char* text, size_t length) {
+    location->offset += (int)length;
+    const char* end = text + length;
+    const char* last_newline = NULL;
+    for (const char* p = text; (p = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL; ++p) {
+        location->line++;
+        last_newline = p;
+    }
+    if (last_newline) {
+        location->column = (int)(end - last_newline - 1);
+    } else {
+        location->column += (int)length;
+    }
+}
+
+// Appends to the contents of a literal being gathered across buffer refills
+static void append_literal(LexContext* ctx, size_t length, const char* piece, size_t count) {
+    if (length + count > ctx->literal_capacity) {
+        size_t capacity = ctx->literal_capacity ? ctx->literal_capacity : sizeof(ctx->buffer);
+        while (capacity < length + count) capacity *= 2;
+        char* grown = (char*)realloc(ctx->literal, capacity);
+        if (!grown) {
+            fprintf(stderr, "Memory allocation failed for string literal.\n");
+            exit(EXIT_FAILURE);
+        }
+        ctx->literal = grown;
+        ctx->literal_capacity = capacity;
+    }
+    memcpy(ctx->literal + length, piece, count);
+}
+
+// Shows a string literal in the token's lexeme as written, or shortened with
+// "..." (at a character boundary) when it does not fit
+static void set_string_lexeme(Token* token, const char* text, size_t length, bool closed) {
+    size_t room = MAX_LEXEME_LENGTH - 3; // Both quotes and the terminator
+    size_t shown = length;
+    bool shortened = length > room;
+    if (shortened) {
+        shown = room - 3;
+        while (shown > 0 && ((unsigned char)text[shown] & 0xC0) == 0x80) shown--;
+    }
+    size_t end = 0;
+    token->lexeme[end++] = '"';
+    if (shown > 0) memcpy(token->lexeme + end, text, shown);
+    end += shown;
+    if (shortened) {
+        memcpy(token->lexeme + end, "...", 3);
+        end += 3;
+    }
+    if (closed) token->lexeme[end++] = '"';
+    token->lexeme[end] = '\0';
+}
+
+// Lexes the rest of a string literal after its opening quote. The contents are
+// found and checked to be UTF-8 in bulk (strscan.h), straight in the input
+// buffer, and interned from there, so the AST shares them through the constant
+// pool (unless ctx->intern_strings is off); only a literal spanning buffer
+// refills is gathered in ctx->literal. The buffer is reused, so the pool keeps
+// a copy; tools/bench_strings.c weighs that copy against the scan. There is no
+// length limit.
+static Token lex_string_literal(LexContext* ctx, SourceLocation start) {
+    Token token;
+    token.location = start;
+    token.type = TOKEN_STRING;
+    SourceLocation contents_start = ctx->location;
+    StringScan scan;
+    string_scan_init(&scan);
+    const char* text = NULL;
+    size_t length = 0;
+    bool gathered = false;
+    for (;;) {
+        if (ctx->buffer_pos >= ctx->buffer_size && !fill_buffer(ctx)) {
+            report_error(ctx, "Unterminated string literal.");
+            token.type = TOKEN_ERROR;
+            set_string_lexeme(&token, text, length, false);
+            return token;
+        }
+        const char* piece = ctx->buffer + ctx->buffer_pos;
+        size_t available = (size_t)(ctx->buffer_size - ctx->buffer_pos);
+        size_t count = string_scan(&scan, piece, available);
+        advance_location(&ctx->location, piece, count);
+        ctx->buffer_pos += (int)count;
+        if (count < available && !gathered) {
+            // All of it is in the buffer
+            text = piece;
+            length = count;
+            break;
+        }
+        append_literal(ctx, length, piece, count);
+        length += count;
+        text = ctx->literal;
+        gathered = true;
+        if (count < available) break;
+    }
+    next_char(ctx); // The closing quote, still in the buffer
+
+    if (!string_scan_finish(&scan)) {
+        // Point at the first byte of the bad sequence, as next_char would after reading it
+        SourceLocation at = contents_start;
+        advance_location(&at, text, utf8_invalid_offset(text, length));
+        at.offset++;
+        at.column++;
+        report_error_at(ctx, at, "Invalid UTF-8 in string literal.");
+        token.type = TOKEN_ERROR;
+    } else if (ctx->intern_strings) {
+        token.value.string_constant = constant_pool_string(length > 0 ? text : "", length);
+    } else {
+        token.value.string_length = length; // No pool entry (or its lock) for a literal nothing keeps
+    }
+    set_string_lexeme(&token, text, length, true);
+    return token;
+}
+
 // RETURNS THE NEXT TOKEN (STATE TRANSITION LOGIC)
 /*****************************************************************************/
 Token get_next_token(LexContext* ctx) {
@@ -268,8 +481,6 @@ Token get_next_token(LexContext* ctx) {
                 // Specific error messages based on the previous state
                 if (prev_state == STATE_COMMENT) {
                     report_error(ctx, "Unterminated comment block.");
-                } else if (prev_state == STATE_STRING) {
-                    report_error(ctx, "Unterminated string literal.");
                 } else if (prev_state == STATE_COLON && char_class != CHAR_EQUALS) {
                     report_error(ctx, "Invalid operator: expected '=' after ':'.");
                 } else if (prev_state == STATE_PLUS && char_class != CHAR_EQUALS) {
@@ -283,6 +494,9 @@ Token get_next_token(LexContext* ctx) {
                 // Break from loop to signify an error token
                 break;
             }
+        } else if (state == STATE_STRING) {
+            // The opening quote: the rest of the literal is scanned in bulk
+            return lex_string_literal(ctx, token_start_location);
         } else {
             // If not a skipping state, add the current character to the lexeme buffer
             if (ctx->lexeme_length < MAX_LEXEME_LENGTH - 1) {
@@ -355,8 +569,9 @@ Token get_next_token(LexContext* ctx) {
             }
         }
     } else if (prev_state == STATE_INTEGER || (prev_state == STATE_DASH && char_class == CHAR_DIGIT)) { // Handle numbers starting with '-' too
-        // Check for integer literal length limit based on MAX_INT_LENGTH (from MAX_BIGINT_STRING_LEN)
-        if (ctx->lexeme_length > MAX_INT_LENGTH - 1) {
+        // Check for integer literal length limit based on MAX_INT_LENGTH (from MAX_BIGINT_LITERAL_DIGITS)
+        int digit_count = ctx->lexeme_length - (token.lexeme[0] == '-' ? 1 : 0);
+        if (digit_count > MAX_INT_LENGTH) {
             token.type = TOKEN_ERROR;
             report_error(ctx, "Integer literal exceeds maximum allowed digits.");
         } else {
@@ -364,8 +579,6 @@ Token get_next_token(LexContext* ctx) {
             // Convert the lexeme string to a BigInt value and store it
             big_int_from_string(&token.value.big_int_value, token.lexeme);
         }
-    } else if (prev_state == STATE_STRING) {
-        token.type = TOKEN_STRING;
     } else {
         token.type = TOKEN_ERROR; // Catch-all for unhandled states
     }
@@ -375,15 +588,19 @@ Token get_next_token(LexContext* ctx) {
 /***********************/
 // END OF GET_NEXT_TOKEN
 
-// Report lexical error to stderr
+// Report lexical error to stderr (or just record it, see report_errors)
 void report_error(LexContext* ctx, const char* message) {
+    report_error_at(ctx, ctx->location, message);
+}
+
+static void report_error_at(LexContext* ctx, SourceLocation location, const char* message) {
     snprintf(ctx->error_msg, sizeof(ctx->error_msg),
              "Lexical error at %s:%d:%d: %s",
-             ctx->location.filename,
-             ctx->location.line,
-             ctx->location.column,
+             location.filename,
+             location.line,
+             location.column,
              message);
-    fprintf(stderr, "%s\n", ctx->error_msg);
+    if (ctx->report_errors) fprintf(stderr, "%s\n", ctx->error_msg);
 }
 
 // Converts TokenType enum value to a human-readable string
@@ -398,6 +615,9 @@ const char* token_type_str(TokenType type) {
         case TOKEN_NEWLINE: return "KEYWORD_NEWLINE";
         case TOKEN_TIMES: return "KEYWORD_TIMES";
         case TOKEN_NUMBER: return "KEYWORD_NUMBER";
+        case TOKEN_READ: return "KEYWORD_READ";
+        case TOKEN_VECTOR: return "KEYWORD_VECTOR";
+        case TOKEN_INCLUDE: return "KEYWORD_INCLUDE";
         case TOKEN_INTEGER: return "IntConstant";
         case TOKEN_ASSIGN: return "AssignmentOp";
         case TOKEN_PLUS_ASSIGN: return "PlusAssignOp";
@@ -437,6 +657,14 @@ void free_lex_context(LexContext* ctx) {
     for (int i = 0; i < ctx->symbol_count; i++) {
         free(ctx->symbol_table[i].name);
     }
+    free(ctx->symbol_table);
+    free(ctx->symbol_hash);
+    free(ctx->literal);
+    ctx->literal = NULL;
+    ctx->literal_capacity = 0;
+    ctx->symbol_table = NULL;
+    ctx->symbol_hash = NULL;
+    ctx->symbol_count = 0;
 
     for (int i = 0; i < ctx->keyword_count; i++) {
         free(ctx->keywords[i]);
@@ -478,11 +706,11 @@ Token* lexer(FILE* inputFile, char* input_filename, int* num_tokens_out) {
 
         token = get_next_token(&ctx); // Get the next token from the input
         tokens[tokencount++] = token; // Store the token and increment count
-        print_token(token);           // Print the token (for debugging/output)
+        if (trace_enabled) print_token(token); // Print the token (for debugging/output)
 
     } while (token.type != TOKEN_EOF && token.type != TOKEN_ERROR); // Continue until EOF or an error token is found
 
-    printf("Lexical analysis completed.\n");
+    if (trace_enabled) printf("Lexical analysis completed.\n");
 
     // Set the output parameter with the total number of tokens (including EOF/ERROR)
     if (num_tokens_out) *num_tokens_out = tokencount;
@@ -0,0 +1,200 @@
+#include "linear_loop.h"
+#include "interpreter.h"
+#include <string.h>
+
+// Values checked by the solver stay below 2^BOUND_BITS, so no sum of them can wrap
+#define BOUND_BITS (NUM_LIMBS * 64 - 8)
+#define BOUND_LIMIT 0x1p376 // 2^BOUND_BITS
+
+typedef BigInt Matrix[LINEAR_LOOP_MAX_SIZE][LINEAR_LOOP_MAX_SIZE];
+// Magnitude bounds only decide whether to solve, so doubles are precise enough:
+// their rounding is far below the 2^8 margin between BOUND_LIMIT and wrap-around
+typedef double BoundMatrix[LINEAR_LOOP_MAX_SIZE][LINEAR_LOOP_MAX_SIZE];
+
+static int bit_length(const BigInt* num) {
+    for (int i = NUM_LIMBS - 1; i >= 0; --i) {
+        if (num->limbs[i] != 0) return i * 64 + (64 - __builtin_clzll(num->limbs[i]));
+    }
+    return 0;
+}
+
+static bool is_zero(const BigInt* num) {
+    return bit_length(num) == 0;
+}
+
+static double magnitude(const BigInt* num) {
+    double value = 0.0;
+    for (int i = NUM_LIMBS - 1; i >= 0; --i) value = value * 0x1p64 + (double)num->limbs[i];
+    return value;
+}
+
+// sum += |a| * |b|; false once the sum could reach 2^BOUND_BITS
+static bool bound_mul_add(BigInt* sum, const BigInt* a, const BigInt* b) {
+    if (is_zero(a) || is_zero(b)) return true;
+    if (bit_length(a) + bit_length(b) > BOUND_BITS) return false;
+    BigInt product;
+    big_int_mul(&product, a, b);
+    product.sign = 1;
+    big_int_abs_add(sum, sum, &product);
+    return bit_length(sum) <= BOUND_BITS;
+}
+
+// out = a * b + (add ? add : 0); false if an entry reaches BOUND_LIMIT (or is NaN)
+static bool bound_matrix_mul(BoundMatrix out, BoundMatrix a, BoundMatrix b, BoundMatrix add, int size) {
+    BoundMatrix result;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            double sum = add ? add[i][j] : 0.0;
+            for (int k = 0; k < size; ++k) sum += a[i][k] * b[k][j];
+            if (!(sum < BOUND_LIMIT)) return false;
+            result[i][j] = sum;
+        }
+    }
+    memcpy(out, result, sizeof(BoundMatrix));
+    return true;
+}
+
+static bool bound_matrix_apply(double* out, BoundMatrix m, const double* v, int size) {
+    for (int i = 0; i < size; ++i) {
+        double sum = 0.0;
+        for (int k = 0; k < size; ++k) sum += m[i][k] * v[k];
+        if (!(sum < BOUND_LIMIT)) return false;
+        out[i] = sum;
+    }
+    return true;
+}
+
+// True if no value of the first `iterations` runs of the body, statement by
+// statement, reaches BOUND_LIMIT. With A = |update|, the values entering
+// iteration t are at most A^t |start|, so all of them are at most
+// S |start| for S = sum of A^t over t <= iterations, and values inside an
+// iteration at most prefix_bound * S |start|. Every power of update the
+// solver forms, and every partial sum of its products, is covered by S too.
+static bool values_stay_bounded(const LinearLoopPlan* plan, const BigInt* iterations, int bits) {
+    int size = plan->variable_count + 1;
+    // power = A^(2^j), block = sum of A^t for t < 2^j; reach = A^m, total =
+    // sum of A^t for t < m, where m is the value of the bits below j
+    BoundMatrix power, block, reach, total, prefix;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            power[i][j] = magnitude(&plan->update[i][j]);
+            prefix[i][j] = magnitude(&plan->prefix_bound[i][j]);
+            block[i][j] = reach[i][j] = i == j ? 1.0 : 0.0;
+            total[i][j] = 0.0;
+        }
+    }
+    for (int bit = 0; bit < bits; ++bit) {
+        if ((iterations->limbs[bit / 64] >> (bit % 64)) & 1) {
+            if (!bound_matrix_mul(total, reach, block, total, size)) return false;
+            if (!bound_matrix_mul(reach, reach, power, NULL, size)) return false;
+        }
+        if (bit + 1 < bits) {
+            if (!bound_matrix_mul(block, power, block, block, size)) return false;
+            if (!bound_matrix_mul(power, power, power, NULL, size)) return false;
+        }
+    }
+
+    double start[LINEAR_LOOP_MAX_SIZE], entering[LINEAR_LOOP_MAX_SIZE], inside[LINEAR_LOOP_MAX_SIZE];
+    for (int i = 0; i < plan->variable_count; ++i) start[i] = magnitude(&plan->start_values[i]);
+    start[plan->variable_count] = 1.0;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) total[i][j] += reach[i][j]; // t = iterations itself
+    }
+    return bound_matrix_apply(entering, total, start, size) && bound_matrix_apply(inside, prefix, entering, size);
+}
+
+// sum += a * b, signed; exact because the bounds were checked first
+static void exact_mul_add(BigInt* sum, const BigInt* a, const BigInt* b) {
+    if (is_zero(a) || is_zero(b)) return;
+    BigInt product;
+    big_int_mul(&product, a, b);
+    big_int_add(sum, sum, &product);
+}
+
+static void exact_matrix_mul(Matrix out, const Matrix a, const Matrix b, int size) {
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            big_int_zero(&out[i][j]);
+            for (int k = 0; k < size; ++k) exact_mul_add(&out[i][j], &a[i][k], &b[k][j]);
+        }
+    }
+}
+
+static void exact_matrix_apply(BigInt* out, const Matrix m, const BigInt* v, int size) {
+    for (int i = 0; i < size; ++i) {
+        big_int_zero(&out[i]);
+        for (int k = 0; k < size; ++k) exact_mul_add(&out[i], &m[i][k], &v[k]);
+    }
+}
+
+void linear_loop_init(LinearLoopPlan* plan) {
+    plan->variable_count = 0;
+    for (int i = 0; i < LINEAR_LOOP_MAX_SIZE; ++i) {
+        for (int j = 0; j < LINEAR_LOOP_MAX_SIZE; ++j) {
+            big_int_from_long_long(&plan->update[i][j], i == j ? 1 : 0);
+            big_int_copy(&plan->prefix_bound[i][j], &plan->update[i][j]);
+        }
+    }
+}
+
+int linear_loop_add_variable(LinearLoopPlan* plan, const BigInt* start_value) {
+    big_int_copy(&plan->start_values[plan->variable_count], start_value);
+    return plan->variable_count++;
+}
+
+bool linear_loop_append(LinearLoopPlan* plan, int target, bool assign, int source, const BigInt* factor) {
+    int size = plan->variable_count + 1;
+    BigInt row[LINEAR_LOOP_MAX_SIZE];
+
+    // Bound the new row first, so computing it exactly cannot wrap
+    for (int j = 0; j < size; ++j) {
+        BigInt limit;
+        big_int_zero(&limit);
+        if (!assign) {
+            big_int_copy(&limit, &plan->update[target][j]);
+            limit.sign = 1;
+        }
+        if (!bound_mul_add(&limit, factor, &plan->update[source][j])) return false;
+    }
+
+    for (int j = 0; j < size; ++j) {
+        if (assign) {
+            big_int_zero(&row[j]);
+        } else {
+            big_int_copy(&row[j], &plan->update[target][j]);
+        }
+        exact_mul_add(&row[j], factor, &plan->update[source][j]);
+        if (big_int_abs_compare(&row[j], &plan->prefix_bound[target][j]) > 0) {
+            big_int_copy(&plan->prefix_bound[target][j], &row[j]);
+            plan->prefix_bound[target][j].sign = 1;
+        }
+    }
+    memcpy(plan->update[target], row, size * sizeof(BigInt));
+    return true;
+}
+
+bool linear_loop_solve(const LinearLoopPlan* plan, const BigInt* iterations, BigInt* values) {
+    int size = plan->variable_count + 1;
+    int bits = bit_length(iterations);
+    if (!values_stay_bounded(plan, iterations, bits)) return false;
+
+    // update^N by squaring, applied to (start, 1) bit by bit from the lowest;
+    // powers of one matrix commute, so the order of application is free
+    Matrix power, scratch;
+    BigInt vector[LINEAR_LOOP_MAX_SIZE], next[LINEAR_LOOP_MAX_SIZE];
+    memcpy(vector, plan->start_values, plan->variable_count * sizeof(BigInt));
+    big_int_from_long_long(&vector[plan->variable_count], 1);
+    memcpy(power, plan->update, sizeof(Matrix));
+    for (int bit = 0; bit < bits; ++bit) {
+        if ((iterations->limbs[bit / 64] >> (bit % 64)) & 1) {
+            exact_matrix_apply(next, power, vector, size);
+            memcpy(vector, next, size * sizeof(BigInt));
+        }
+        if (bit + 1 < bits) {
+            exact_matrix_mul(scratch, power, power, size);
+            memcpy(power, scratch, sizeof(Matrix));
+        }
+    }
+    memcpy(values, vector, plan->variable_count * sizeof(BigInt));
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef LINEAR_LOOP_H
+#define LINEAR_LOOP_H
+
+#include <stdbool.h>
+#include "bigint.h"
+
+// Loops shorter than this are cheaper to iterate than to solve
+#define LINEAR_LOOP_MIN_ITERATIONS 1024
+// Most distinct variables a solved loop body may update
+#define LINEAR_LOOP_MAX_VARIABLES 8
+// Matrix side: the updated variables plus the constant 1
+#define LINEAR_LOOP_MAX_SIZE (LINEAR_LOOP_MAX_VARIABLES + 1)
+
+// A loop body of := / += / -= statements whose operands are literals,
+// loop-invariant variables or updated variables. One iteration maps the
+// vector (values, 1) to update * (values, 1), so N iterations are update^N,
+// found with O(log N) matrix products.
+typedef struct {
+    int variable_count;
+    BigInt start_values[LINEAR_LOOP_MAX_VARIABLES];                 // Before the first iteration
+    BigInt update[LINEAR_LOOP_MAX_SIZE][LINEAR_LOOP_MAX_SIZE];      // Effect of the body so far
+    // Elementwise largest |update| seen after any statement (the identity
+    // included), which bounds the values met in the middle of an iteration
+    BigInt prefix_bound[LINEAR_LOOP_MAX_SIZE][LINEAR_LOOP_MAX_SIZE];
+} LinearLoopPlan;
+
+// Starts an empty body (update = prefix_bound = identity) over no variables
+void linear_loop_init(LinearLoopPlan* plan);
+// Adds an updated variable with its value before the loop; returns its index
+int linear_loop_add_variable(LinearLoopPlan* plan, const BigInt* start_value);
+// Appends one statement to the body: target := factor * source (assign) or
+// target += factor * source, where source is a variable index or
+// variable_count for the constant 1. All variables must be added first.
+// Returns false if the row no longer fits comfortably in a BigInt.
+bool linear_loop_append(LinearLoopPlan* plan, int target, bool assign, int source, const BigInt* factor);
+// Values after `iterations` runs of the body. Returns false, leaving values
+// untouched, unless every value met along the way (statement by statement)
+// stays well inside the BigInt range: past it the wrap-around of iterated
+// BigInt arithmetic and of the closed form would disagree.
+bool linear_loop_solve(const LinearLoopPlan* plan, const BigInt* iterations, BigInt* values);
+
+#endif // LINEAR_LOOP_H
@@ -0,0 +1,121 @@
+#include "loop_render.h"
+#include "interpreter.h"
+#include "output.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} ChunkBuffer;
+
+typedef struct {
+    const LoopRenderPlan* plan;
+    long long round_start;     // First iteration of the current round
+    long long iterations;
+    ChunkBuffer* buffers;      // One per task of a round
+} RenderRound;
+
+static void chunk_append(ChunkBuffer* buffer, const char* data, size_t length) {
+    if (length == 0) return;
+    if (buffer->length + length > buffer->capacity) {
+        size_t new_capacity = buffer->capacity == 0 ? 65536 : buffer->capacity;
+        while (new_capacity < buffer->length + length) new_capacity *= 2;
+        buffer->data = (char*)realloc(buffer->data, new_capacity);
+        if (!buffer->data) {
+            fprintf(stderr, "Memory allocation failed for loop output buffer.\n");
+            exit(EXIT_FAILURE);
+        }
+        buffer->capacity = new_capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+}
+
+static void render_chunk(void* context, int task_index) {
+    RenderRound* round = (RenderRound*)context;
+    const LoopRenderPlan* plan = round->plan;
+    ChunkBuffer* buffer = &round->buffers[task_index];
+    buffer->length = 0;
+
+    long long first = round->round_start + (long long)task_index * LOOP_RENDER_CHUNK_ITERATIONS;
+    if (first >= round->iterations) return;
+    long long count = round->iterations - first;
+    if (count > LOOP_RENDER_CHUNK_ITERATIONS) count = LOOP_RENDER_CHUNK_ITERATIONS;
+
+    // Closed form for the values entering iteration 'first'
+    BigInt values[LOOP_RENDER_MAX_VARIABLES];
+    DecimalCache decimals[LOOP_RENDER_MAX_VARIABLES];
+    BigInt first_big, offset;
+    big_int_from_long_long(&first_big, first);
+    for (int v = 0; v < plan->variable_count; ++v) {
+        big_int_mul(&offset, &plan->steps[v], &first_big);
+        big_int_add(&values[v], &plan->start_values[v], &offset);
+        decimals[v].valid = false;
+    }
+
+    for (long long it = 0; it < count; ++it) {
+        for (int i = 0; i < plan->op_count; ++i) {
+            const RenderOp* op = &plan->ops[i];
+            switch (op->type) {
+                case RENDER_OP_ADD:
+                    big_int_add(&values[op->variable], &values[op->variable], &op->delta);
+                    if (decimals[op->variable].valid && !decimal_cache_add(&decimals[op->variable], &op->delta, 1)) {
+                        decimals[op->variable].valid = false;
+                    }
+                    break;
+                case RENDER_OP_WRITE_VARIABLE: {
+                    DecimalCache* cache = &decimals[op->variable];
+                    if (!cache->valid) decimal_cache_fill(cache, &values[op->variable]);
+                    if (cache->valid) {
+                        int start = cache->start;
+                        if (cache->sign == -1) cache->text[--start] = '-';
+                        chunk_append(buffer, cache->text + start, DECIMAL_CACHE_DIGITS + 1 - start);
+                    } else {
+                        char str_buffer[MAX_BIGINT_STRING_LEN + 2];
+                        big_int_to_string(&values[op->variable], str_buffer);
+                        chunk_append(buffer, str_buffer, strlen(str_buffer));
+                    }
+                    break;
+                }
+                case RENDER_OP_WRITE_TEXT:
+                    chunk_append(buffer, op->text, op->text_length);
+                    break;
+            }
+        }
+    }
+}
+
+void render_loop(const LoopRenderPlan* plan, long long iterations) {
+    int tasks_per_round = parallel_thread_count() * LOOP_RENDER_TASKS_PER_THREAD;
+    ChunkBuffer* buffers = (ChunkBuffer*)calloc(tasks_per_round, sizeof(ChunkBuffer));
+    if (!buffers) {
+        fprintf(stderr, "Memory allocation failed for loop output buffers.\n");
+        exit(EXIT_FAILURE);
+    }
+    RenderRound round = { .plan = plan, .round_start = 0, .iterations = iterations, .buffers = buffers };
+    long long round_size = (long long)tasks_per_round * LOOP_RENDER_CHUNK_ITERATIONS;
+
+    for (round.round_start = 0; round.round_start < iterations; round.round_start += round_size) {
+        long long remaining = iterations - round.round_start;
+        int tasks = remaining >= round_size ? tasks_per_round
+                  : (int)((remaining + LOOP_RENDER_CHUNK_ITERATIONS - 1) / LOOP_RENDER_CHUNK_ITERATIONS);
+        parallel_for(tasks, render_chunk, &round);
+        for (int i = 0; i < tasks; ++i) {
+            if (buffers[i].length > 0) output_write(buffers[i].data, buffers[i].length);
+        }
+    }
+
+    for (int i = 0; i < tasks_per_round; ++i) free(buffers[i].data);
+    free(buffers);
+}
+
+void free_loop_render_plan(LoopRenderPlan* plan) {
+    for (int i = 0; i < plan->op_count; ++i) {
+        if (plan->ops[i].type == RENDER_OP_WRITE_TEXT) free(plan->ops[i].text);
+    }
+    plan->op_count = 0;
+}
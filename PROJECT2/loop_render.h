@@ -0,0 +1,47 @@
+#ifndef LOOP_RENDER_H
+#define LOOP_RENDER_H
+
+#include <stddef.h>
+#include "bigint.h"
+
+// Loops shorter than this are not worth splitting across threads
+#define LOOP_RENDER_MIN_ITERATIONS 16384
+// Iterations rendered by one task
+#define LOOP_RENDER_CHUNK_ITERATIONS 8192
+// Tasks per thread in each round; the output of a round is emitted before the next starts
+#define LOOP_RENDER_TASKS_PER_THREAD 4
+// Largest loop body (operations / distinct updated variables) that is rendered
+#define LOOP_RENDER_MAX_OPS 64
+#define LOOP_RENDER_MAX_VARIABLES 16
+
+typedef enum {
+    RENDER_OP_ADD,             // variable += delta
+    RENDER_OP_WRITE_VARIABLE,  // write the current value of a variable
+    RENDER_OP_WRITE_TEXT       // write fixed text (string, newline, literal or loop-invariant value)
+} RenderOpType;
+
+typedef struct {
+    RenderOpType type;
+    int variable;              // ADD / WRITE_VARIABLE: index into the plan's variables
+    BigInt delta;              // ADD: signed amount
+    char* text;                // WRITE_TEXT: owned by the plan
+    size_t text_length;
+} RenderOp;
+
+// A loop body that only adds loop-invariant amounts to variables and writes.
+// Every value at iteration k is start + k * step + (adds earlier in the body),
+// so any range of iterations can be rendered without running the ones before it.
+typedef struct {
+    RenderOp ops[LOOP_RENDER_MAX_OPS];
+    int op_count;
+    BigInt start_values[LOOP_RENDER_MAX_VARIABLES]; // Before the first iteration
+    BigInt steps[LOOP_RENDER_MAX_VARIABLES];        // Total change per iteration
+    int variable_count;
+} LoopRenderPlan;
+
+// Writes the output of iterations [0, iterations) through the output sink, in
+// order, rendering chunks of iterations in parallel. Variables are not updated.
+void render_loop(const LoopRenderPlan* plan, long long iterations);
+void free_loop_render_plan(LoopRenderPlan* plan);
+
+#endif // LOOP_RENDER_H
@@ -0,0 +1,100 @@
+#include "metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MetricsSegment* metrics_segment = NULL;
+
+static char segment_name[64];
+// Statements this thread has counted but not yet added to the segment
+static _Thread_local uint64_t pending_statements = 0;
+// CLOCK_REALTIME of the last memory sample (any thread may take the next one)
+static uint64_t last_memory_sample_ns = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void sample_memory(uint64_t now) {
+    __atomic_store_n(&last_memory_sample_ns, now, __ATOMIC_RELAXED);
+    struct mallinfo2 info = mallinfo2();
+    __atomic_store_n(&metrics_segment->memory_bytes, (uint64_t)(info.uordblks + info.hblkhd), __ATOMIC_RELAXED);
+}
+
+bool metrics_open(const char* script) {
+    snprintf(segment_name, sizeof(segment_name), "/%s%ld", METRICS_NAME_PREFIX, (long)getpid());
+    int fd = shm_open(segment_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Warning: Could not create metrics segment '%s'; running without metrics.\n", segment_name);
+        return false;
+    }
+    void* map = ftruncate(fd, sizeof(MetricsSegment)) == 0
+                    ? mmap(NULL, sizeof(MetricsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Warning: Could not map metrics segment '%s'; running without metrics.\n", segment_name);
+        shm_unlink(segment_name);
+        return false;
+    }
+
+    // The segment starts zeroed; the magic goes in last, once the header is complete
+    MetricsSegment* segment = (MetricsSegment*)map;
+    segment->pid = (int32_t)getpid();
+    segment->phase = METRICS_PHASE_STARTING;
+    snprintf(segment->script, sizeof(segment->script), "%s", script ? script : "<stdin>");
+    segment->started_ns = segment->updated_ns = now_ns();
+    metrics_segment = segment;
+    sample_memory(segment->started_ns);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(segment->magic, METRICS_MAGIC, sizeof(segment->magic));
+    atexit(metrics_close);
+    return true;
+}
+
+// The segment stays linked so a reader sees the final counts; the reader
+// unlinks it once it has shown the finished phase
+void metrics_close(void) {
+    if (!metrics_segment) return;
+    metrics_set_phase(METRICS_PHASE_FINISHED);
+    munmap(metrics_segment, sizeof(MetricsSegment));
+    metrics_segment = NULL;
+}
+
+void metrics_set_phase(MetricsPhase phase) {
+    if (!metrics_segment) return;
+    metrics_flush();
+    __atomic_store_n(&metrics_segment->phase, (int32_t)phase, __ATOMIC_RELAXED);
+}
+
+void metrics_add_statements(uint64_t count) {
+    pending_statements += count;
+    if (pending_statements >= METRICS_FLUSH_STATEMENTS) metrics_flush();
+}
+
+void metrics_flush(void) {
+    if (!metrics_segment) return;
+    if (pending_statements > 0) {
+        __atomic_fetch_add(&metrics_segment->statements, pending_statements, __ATOMIC_RELAXED);
+        pending_statements = 0;
+    }
+    uint64_t now = now_ns();
+    __atomic_store_n(&metrics_segment->updated_ns, now, __ATOMIC_RELAXED);
+    if (now - __atomic_load_n(&last_memory_sample_ns, __ATOMIC_RELAXED) >= METRICS_MEMORY_SAMPLE_NS) sample_memory(now);
+}
+
+void metrics_set_loop(int depth, uint64_t iteration) {
+    __atomic_store_n(&metrics_segment->loop_depth, (uint64_t)depth, __ATOMIC_RELAXED);
+    __atomic_store_n(&metrics_segment->loop_iteration, iteration, __ATOMIC_RELAXED);
+}
+
+void metrics_add_bytes_written(uint64_t count) {
+    __atomic_fetch_add(&metrics_segment->bytes_written, count, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,65 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Segments are POSIX shared memory objects named METRICS_NAME_PREFIX<pid>
+// (files under /dev/shm on Linux), read by tools/proglang_top.c
+#define METRICS_NAME_PREFIX "proglang-"
+#define METRICS_MAGIC "PLMETRC1"
+#define METRICS_SCRIPT_LENGTH 256
+// Statements a thread counts locally before adding them to the segment
+#define METRICS_FLUSH_STATEMENTS 4096
+// Least time between two samples of the memory in use
+#define METRICS_MEMORY_SAMPLE_NS 100000000ULL
+
+typedef enum {
+    METRICS_PHASE_STARTING = 0,
+    METRICS_PHASE_LEXING,
+    METRICS_PHASE_PARSING,
+    METRICS_PHASE_LINKING,
+    METRICS_PHASE_OPTIMIZING,
+    METRICS_PHASE_RUNNING,
+    METRICS_PHASE_FINISHED,
+    METRICS_PHASE_COUNT
+} MetricsPhase;
+
+// Layout of a segment. Only its interpreter writes it, field by field with
+// relaxed atomic stores and adds, so readers never block it and never see a
+// torn value, though fields may come from slightly different moments. While
+// statement lists run in parallel (regions, --bindings batches), the loop
+// fields follow whichever thread moved last.
+typedef struct {
+    char magic[8];
+    int32_t pid;
+    int32_t phase;                      // MetricsPhase
+    char script[METRICS_SCRIPT_LENGTH]; // Path of the script (truncated)
+    uint64_t started_ns;                // CLOCK_REALTIME at startup
+    uint64_t updated_ns;                // CLOCK_REALTIME of the last flush or phase change
+    uint64_t statements;                // Statements executed; a loop finished in closed form counts once
+    uint64_t loop_depth;                // Loops open in the running statement
+    uint64_t loop_iteration;            // Iterations the innermost open loop has completed
+    uint64_t bytes_written;             // Program output written to stdout
+    uint64_t memory_bytes;              // Heap in use (malloc'd and mmap'd), sampled
+} MetricsSegment;
+
+// The segment of this process, NULL unless metrics_open succeeded. Callers
+// test it before reporting, so disabled metrics cost one branch.
+extern MetricsSegment* metrics_segment;
+
+// Creates the segment for this process and marks it finished at exit (leaving
+// it for proglang-top to unlink); warns and returns false if shared memory is
+// unavailable
+bool metrics_open(const char* script);
+void metrics_close(void);
+void metrics_set_phase(MetricsPhase phase);
+// Counted per thread and added to the segment every METRICS_FLUSH_STATEMENTS;
+// parallel tasks call metrics_flush as they finish so no worker keeps a remainder
+void metrics_add_statements(uint64_t count);
+// Adds the calling thread's pending count now (and samples the memory in use)
+void metrics_flush(void);
+void metrics_set_loop(int depth, uint64_t iteration);
+void metrics_add_bytes_written(uint64_t count);
+
+#endif // METRICS_H
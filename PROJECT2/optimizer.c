@@ -0,0 +1,449 @@
+#include "optimizer.h"
+#include "interpreter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    DECLARED_NO,
+    DECLARED_MAYBE,  // Declared on some paths only (e.g. by a loop body)
+    DECLARED_YES
+} DeclaredState;
+
+// What is known about one variable at the current point of the program
+typedef struct {
+    char* name;                  // NULL for an empty slot
+    DeclaredState declared;
+    bool known;                  // value is the variable's value (only meaningful if declared for certain)
+    BigInt value;
+    const ASTNode* pending_list; // Statement list holding the last store to the variable nothing has seen yet
+    int pending_index;           // Position of that store in pending_list
+} VariableFacts;
+
+// Open-addressing table of VariableFacts by name. Variables not in it are undeclared.
+typedef struct {
+    VariableFacts* slots;
+    int capacity;                // Power of two, at least twice count
+    int count;
+} FactTable;
+
+typedef struct {
+    char** names;
+    int count;
+    int capacity;
+} NameList;
+
+static unsigned int hash_name(const char* name) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; ++p) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+static VariableFacts* probe_facts(VariableFacts* slots, int capacity, const char* name) {
+    unsigned int mask = (unsigned int)capacity - 1;
+    unsigned int slot = hash_name(name) & mask;
+    while (slots[slot].name && strcmp(slots[slot].name, name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return &slots[slot];
+}
+
+static VariableFacts* find_facts(FactTable* table, const char* name, bool create) {
+    if (create && (table->count + 1) * 2 > table->capacity) {
+        int new_capacity = table->capacity == 0 ? 64 : table->capacity * 2;
+        VariableFacts* new_slots = (VariableFacts*)calloc(new_capacity, sizeof(VariableFacts));
+        if (!new_slots) {
+            fprintf(stderr, "Memory allocation failed for optimizer facts.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < table->capacity; ++i) {
+            if (table->slots[i].name) *probe_facts(new_slots, new_capacity, table->slots[i].name) = table->slots[i];
+        }
+        free(table->slots);
+        table->slots = new_slots;
+        table->capacity = new_capacity;
+    }
+    if (table->capacity == 0) return NULL;
+
+    VariableFacts* facts = probe_facts(table->slots, table->capacity, name);
+    if (facts->name || !create) return facts->name ? facts : NULL;
+    facts->name = strdup(name);
+    if (!facts->name) {
+        fprintf(stderr, "Memory allocation failed for optimizer facts.\n");
+        exit(EXIT_FAILURE);
+    }
+    facts->declared = DECLARED_NO;
+    facts->known = false;
+    facts->pending_list = NULL;
+    table->count++;
+    return facts;
+}
+
+static void free_fact_table(FactTable* table) {
+    for (int i = 0; i < table->capacity; ++i) free(table->slots[i].name);
+    free(table->slots);
+}
+
+static void add_name(NameList* list, const char* name) {
+    for (int i = 0; i < list->count; ++i) {
+        if (strcmp(list->names[i], name) == 0) return;
+    }
+    if (list->count >= list->capacity) {
+        list->capacity = list->capacity == 0 ? 8 : list->capacity * 2;
+        list->names = (char**)realloc(list->names, list->capacity * sizeof(char*));
+        if (!list->names) {
+            fprintf(stderr, "Memory allocation failed for optimizer name list.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->names[list->count] = strdup(name);
+    if (!list->names[list->count]) {
+        fprintf(stderr, "Memory allocation failed for optimizer name list.\n");
+        exit(EXIT_FAILURE);
+    }
+    list->count++;
+}
+
+static void free_name_list(NameList* list) {
+    for (int i = 0; i < list->count; ++i) free(list->names[i]);
+    free(list->names);
+}
+
+// --- AST Helpers ---
+
+static bool is_literal(const ASTNode* value_node) {
+    return value_node && value_node->type == AST_INT_VALUE && value_node->num_children == 1 &&
+           value_node->children[0]->type == AST_INTEGER_LITERAL;
+}
+
+static const char* value_identifier(const ASTNode* value_node) {
+    if (!value_node || value_node->type != AST_INT_VALUE || value_node->num_children != 1 ||
+        value_node->children[0]->type != AST_IDENTIFIER) {
+        return NULL;
+    }
+    return value_node->children[0]->data.identifier.name;
+}
+
+static bool declared_for_certain(FactTable* facts, const char* name) {
+    VariableFacts* f = find_facts(facts, name, false);
+    return f && f->declared == DECLARED_YES;
+}
+
+static int count_statements(const ASTNode* node) {
+    if (!node) return 0;
+    if (node->type == AST_PROGRAM || node->type == AST_CODE_BLOCK || node->type == AST_STATEMENT_LIST) {
+        int count = 0;
+        for (int i = 0; i < node->num_children; ++i) count += count_statements(node->children[i]);
+        return count;
+    }
+    if (node->type == AST_LOOP_STATEMENT) return 1 + count_statements(node->data.loop.body);
+    return 1;
+}
+
+// Variables a statement may assign, update or declare
+static void collect_changes(const ASTNode* node, NameList* changed, NameList* declared) {
+    if (!node) return;
+    switch (node->type) {
+        case AST_DECLARATION:
+            add_name(declared, node->children[0]->data.identifier.name);
+            add_name(changed, node->children[0]->data.identifier.name);
+            break;
+        case AST_ASSIGNMENT:
+        case AST_INCREMENT:
+        case AST_DECREMENT:
+        case AST_READ_STATEMENT:
+            add_name(changed, node->children[0]->data.identifier.name);
+            break;
+        case AST_LOOP_STATEMENT:
+            collect_changes(node->data.loop.body, changed, declared);
+            break;
+        case AST_CODE_BLOCK:
+        case AST_STATEMENT_LIST:
+            for (int i = 0; i < node->num_children; ++i) collect_changes(node->children[i], changed, declared);
+            break;
+        default:
+            break;
+    }
+}
+
+// --- Constant Propagation ---
+
+// Replaces a variable operand by a literal if its value is known here
+static void propagate_value(ASTNode* value_node, FactTable* facts, OptimizerStats* stats) {
+    const char* name = value_identifier(value_node);
+    if (!name) return;
+    VariableFacts* f = find_facts(facts, name, false);
+    if (!f || f->declared != DECLARED_YES || !f->known) return;
+
+    ASTNode* literal = create_ast_node(AST_INTEGER_LITERAL, value_node->children[0]->location);
+    literal->data.constant = constant_pool_integer(&f->value);
+    free_ast_node(value_node->children[0]);
+    value_node->children[0] = literal;
+    stats->values_propagated++;
+}
+
+// --- Dead Stores ---
+
+// A variable was (or may have been) looked at, so its pending store is live
+static void forget_store(FactTable* facts, const char* name) {
+    VariableFacts* f = find_facts(facts, name, false);
+    if (f) f->pending_list = NULL;
+}
+
+static void forget_stores_in(const ASTNode* node, FactTable* facts) {
+    if (!node) return;
+    if (node->type == AST_IDENTIFIER) {
+        forget_store(facts, node->data.identifier.name);
+        return;
+    }
+    for (int i = 0; i < node->num_children; ++i) forget_stores_in(node->children[i], facts);
+    if (node->type == AST_LOOP_STATEMENT) {
+        forget_stores_in(node->data.loop.count_expr, facts);
+        forget_stores_in(node->data.loop.body, facts);
+    }
+}
+
+// Records a store that can be dropped if it turns out to be overwritten unseen.
+// Only direct members of a statement list qualify.
+static void note_store(VariableFacts* f, const ASTNode* list, int index) {
+    f->pending_list = list;
+    f->pending_index = index;
+}
+
+// --- Update Coalescing ---
+
+// Signed amount an INCREMENT / DECREMENT with a literal operand adds
+static void update_amount(const ASTNode* statement, BigInt* amount) {
+    big_int_copy(amount, &statement->children[1]->children[0]->data.constant->value);
+    if (statement->type == AST_DECREMENT) {
+        amount->sign = -amount->sign;
+        big_int_normalize(amount);
+    }
+}
+
+static bool is_zero(const BigInt* num) {
+    for (int i = 0; i < NUM_LIMBS; ++i) {
+        if (num->limbs[i] != 0) return false;
+    }
+    return true;
+}
+
+static bool fits_without_wrap(const BigInt* num) {
+    return (num->limbs[NUM_LIMBS - 1] >> 62) == 0;
+}
+
+// Folds statement into previous if both update the same declared variable by
+// literals. BigInt wraps around, so (x + a) + b only equals x + (a + b) when a
+// and b have the same sign and a + b does not wrap.
+static bool try_coalesce(ASTNode* previous, ASTNode* statement, FactTable* facts, OptimizerStats* stats) {
+    if (!previous || (statement->type != AST_INCREMENT && statement->type != AST_DECREMENT) ||
+        (previous->type != AST_INCREMENT && previous->type != AST_DECREMENT)) {
+        return false;
+    }
+    const char* name = statement->children[0]->data.identifier.name;
+    if (strcmp(name, previous->children[0]->data.identifier.name) != 0 || !declared_for_certain(facts, name)) {
+        return false;
+    }
+    propagate_value(statement->children[1], facts, stats);
+    if (!is_literal(previous->children[1]) || !is_literal(statement->children[1])) return false;
+
+    BigInt first, second, total;
+    update_amount(previous, &first);
+    update_amount(statement, &second);
+    if (!is_zero(&first) && !is_zero(&second) && first.sign != second.sign) return false;
+    if (!fits_without_wrap(&first) || !fits_without_wrap(&second)) return false;
+    big_int_add(&total, &first, &second);
+
+    previous->type = AST_INCREMENT;
+    // Pool entries are shared, so the literal is pointed at the sum rather than changed
+    previous->children[1]->children[0]->data.constant = constant_pool_integer(&total);
+    VariableFacts* f = find_facts(facts, name, false);
+    if (f->known) big_int_add(&f->value, &f->value, &second);
+    stats->updates_coalesced++;
+    return true;
+}
+
+// --- Statement Rewriting ---
+
+static void optimize_statement_list(ASTNode* list, FactTable* facts, int loop_depth, OptimizerStats* stats);
+
+// Rewrites one statement and advances the facts past it. list/index locate it
+// when it is a direct member of a statement list (list is NULL otherwise).
+static void optimize_statement(ASTNode* statement, FactTable* facts, ASTNode* list, int index,
+                               int loop_depth, OptimizerStats* stats) {
+    switch (statement->type) {
+        case AST_DECLARATION: {
+            const char* name = statement->children[0]->data.identifier.name;
+            forget_store(facts, name);
+            VariableFacts* f = find_facts(facts, name, true);
+            if (f->declared == DECLARED_NO) {
+                f->known = true;
+                big_int_zero(&f->value);
+            } else if (f->declared == DECLARED_MAYBE) {
+                f->known = false;
+            }
+            f->declared = DECLARED_YES; // A repeated declaration fails but leaves the variable declared
+            break;
+        }
+        case AST_ASSIGNMENT: {
+            const char* name = statement->children[0]->data.identifier.name;
+            ASTNode* rhs = statement->children[1];
+            propagate_value(rhs, facts, stats);
+            const char* rhs_name = value_identifier(rhs);
+            if (rhs_name) forget_store(facts, rhs_name);
+
+            VariableFacts* f = find_facts(facts, name, true);
+            if (f->declared != DECLARED_YES) {
+                f->known = false;
+                f->pending_list = NULL;
+                break;
+            }
+            if (rhs_name && strcmp(rhs_name, name) == 0) break; // x := x changes nothing
+            if (list && f->pending_list == list && list->children[f->pending_index]) {
+                free_ast_node(list->children[f->pending_index]);
+                list->children[f->pending_index] = NULL;
+                stats->dead_stores_removed++;
+            }
+            f->pending_list = NULL;
+            if (list && (!rhs_name || declared_for_certain(facts, rhs_name))) note_store(f, list, index);
+            f->known = is_literal(rhs);
+            if (f->known) big_int_copy(&f->value, &rhs->children[0]->data.constant->value);
+            break;
+        }
+        case AST_INCREMENT:
+        case AST_DECREMENT: {
+            const char* name = statement->children[0]->data.identifier.name;
+            ASTNode* operand = statement->children[1];
+            propagate_value(operand, facts, stats);
+            const char* operand_name = value_identifier(operand);
+            if (operand_name) forget_store(facts, operand_name);
+            forget_store(facts, name);
+
+            VariableFacts* f = find_facts(facts, name, true);
+            if (f->declared != DECLARED_YES) {
+                f->known = false;
+                break;
+            }
+            if (list && (!operand_name || declared_for_certain(facts, operand_name))) note_store(f, list, index);
+            if (f->known && is_literal(operand)) {
+                BigInt amount;
+                update_amount(statement, &amount);
+                big_int_add(&f->value, &f->value, &amount);
+            } else {
+                f->known = false;
+            }
+            break;
+        }
+        case AST_WRITE_STATEMENT: {
+            ASTNode* output_list = statement->children[0];
+            for (int i = 0; i < output_list->num_children; ++i) {
+                ASTNode* content = output_list->children[i]->children[0];
+                if (content->type != AST_INT_VALUE) continue;
+                // In a loop, writing a variable goes through its decimal cache,
+                // which is cheaper than converting a literal on every iteration
+                if (loop_depth == 0) propagate_value(content, facts, stats);
+                const char* name = value_identifier(content);
+                if (name) forget_store(facts, name);
+            }
+            break;
+        }
+        case AST_READ_STATEMENT: {
+            // A read that finds no integer leaves the variable as it was, so an
+            // earlier store stays live
+            const char* name = statement->children[0]->data.identifier.name;
+            forget_store(facts, name);
+            VariableFacts* f = find_facts(facts, name, false);
+            if (f) f->known = false;
+            break;
+        }
+        case AST_LOOP_STATEMENT: {
+            propagate_value(statement->data.loop.count_expr, facts, stats);
+
+            // Anything the body changes is unknown on entry to every iteration and after the loop
+            NameList changed = { NULL, 0, 0 };
+            NameList declared = { NULL, 0, 0 };
+            collect_changes(statement->data.loop.body, &changed, &declared);
+            DeclaredState* declared_before = (DeclaredState*)malloc((declared.count > 0 ? declared.count : 1) * sizeof(DeclaredState));
+            if (!declared_before) {
+                fprintf(stderr, "Memory allocation failed for optimizer loop facts.\n");
+                exit(EXIT_FAILURE);
+            }
+            for (int i = 0; i < changed.count; ++i) find_facts(facts, changed.names[i], true)->known = false;
+            for (int i = 0; i < declared.count; ++i) {
+                VariableFacts* f = find_facts(facts, declared.names[i], true);
+                declared_before[i] = f->declared;
+                if (f->declared == DECLARED_NO) f->declared = DECLARED_MAYBE;
+            }
+
+            ASTNode* body = statement->data.loop.body;
+            if (body->type == AST_CODE_BLOCK) {
+                optimize_statement_list(body->children[0], facts, loop_depth + 1, stats);
+            } else {
+                optimize_statement(body, facts, NULL, 0, loop_depth + 1, stats);
+            }
+
+            for (int i = 0; i < changed.count; ++i) find_facts(facts, changed.names[i], false)->known = false;
+            for (int i = 0; i < declared.count; ++i) {
+                // The body may not have run at all
+                if (declared_before[i] != DECLARED_YES) find_facts(facts, declared.names[i], false)->declared = DECLARED_MAYBE;
+            }
+            free(declared_before);
+            free_name_list(&changed);
+            free_name_list(&declared);
+            forget_stores_in(statement, facts);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void optimize_statement_list(ASTNode* list, FactTable* facts, int loop_depth, OptimizerStats* stats) {
+    int last = -1; // Last statement kept so far
+    for (int i = 0; i < list->num_children; ++i) {
+        ASTNode* statement = list->children[i];
+        if (try_coalesce(last >= 0 ? list->children[last] : NULL, statement, facts, stats)) {
+            free_ast_node(statement);
+            list->children[i] = NULL;
+            continue;
+        }
+        optimize_statement(statement, facts, list, i, loop_depth, stats);
+        last = i;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < list->num_children; ++i) {
+        if (list->children[i]) list->children[kept++] = list->children[i];
+    }
+    list->num_children = kept;
+}
+
+static void find_vector_declaration(ASTNode* node, int depth, void* context) {
+    (void)depth;
+    if (node->type == AST_VECTOR_DECLARATION) *(bool*)context = true;
+}
+
+void optimize_program(ASTNode* program, OptimizerStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!program || program->type != AST_PROGRAM || program->num_children != 1 ||
+        program->children[0]->type != AST_STATEMENT_LIST) {
+        return;
+    }
+    stats->statements_before = count_statements(program);
+
+    // The facts below are about numbers; a name may be a vector instead
+    bool has_vectors = false;
+    ast_walk(program, true, find_vector_declaration, &has_vectors);
+    if (has_vectors) {
+        stats->statements_after = stats->statements_before;
+        return;
+    }
+
+    FactTable facts = { NULL, 0, 0 };
+    optimize_statement_list(program->children[0], &facts, 0, stats);
+    free_fact_table(&facts);
+
+    stats->statements_after = count_statements(program);
+}
@@ -0,0 +1,26 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "parser.h"
+
+// What one optimizer run did
+typedef struct {
+    int statements_before;   // Statements in the program, nested ones included
+    int statements_after;
+    int values_propagated;   // Variable operands replaced by their known value
+    int updates_coalesced;   // += / -= statements folded into the one before
+    int dead_stores_removed; // Stores overwritten before anything saw them
+} OptimizerStats;
+
+// Rewrites a parsed program (AST_PROGRAM) in place:
+//  - constant propagation: operands naming a variable whose value is known at
+//    that point (declared for certain, last set from a literal) become literals
+//  - update coalescing: consecutive x += a; x -= b; become one x += (a - b)
+//  - dead-store elimination: a store to x followed, in the same statement list,
+//    by an assignment to x with nothing in between that reads or writes out x
+//    is dropped
+// Output, runtime errors and final values are unchanged; only traces differ.
+// Programs that declare vectors are left as they are.
+void optimize_program(ASTNode* program, OptimizerStats* stats);
+
+#endif // OPTIMIZER_H
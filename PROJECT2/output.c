@@ -0,0 +1,81 @@
+#include "output.h"
+#include "metrics.h"
+#include "compress.h"
+#include "digest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void stdout_write(void* context, const char* data, size_t length) {
+    (void)context;
+    fwrite(data, 1, length, stdout);
+    if (metrics_segment) metrics_add_bytes_written(length);
+}
+
+static const OutputSink stdout_sink = { .write = stdout_write, .context = NULL };
+// Where threads that have not redirected their output write (stdout, or a
+// compressor in front of it); set before any thread runs statements
+static const OutputSink* default_sink = &stdout_sink;
+// Per thread, so statements running concurrently can each collect their own
+// output; NULL for the default sink
+static _Thread_local const OutputSink* current_sink = NULL;
+
+static Compressor* stdout_compressor = NULL;
+static OutputSink compressed_sink;
+
+static void compressed_write(void* context, const char* data, size_t length) {
+    compressor_write((Compressor*)context, data, length);
+}
+
+static void finish_compression(void) {
+    default_sink = &stdout_sink;
+    compressor_finish(stdout_compressor);
+    stdout_compressor = NULL;
+}
+
+void output_compress_stdout(void) {
+    stdout_compressor = compressor_create(&stdout_sink);
+    compressed_sink.write = compressed_write;
+    compressed_sink.context = stdout_compressor;
+    default_sink = &compressed_sink;
+    // Runtime errors exit from deep inside the interpreter; the stream must
+    // still end properly (exit flushes stdio after this runs)
+    atexit(finish_compression);
+}
+
+static Digest stdout_digest;
+static OutputSink digest_sink;
+
+static void digest_write(void* context, const char* data, size_t length) {
+    digest_update((Digest*)context, data, length);
+}
+
+static void print_digest(void) {
+    default_sink = &stdout_sink;
+    printf("%016llx %llu\n", (unsigned long long)digest_value(&stdout_digest), (unsigned long long)stdout_digest.total);
+}
+
+void output_digest_stdout(void) {
+    digest_init(&stdout_digest);
+    digest_sink.write = digest_write;
+    digest_sink.context = &stdout_digest;
+    default_sink = &digest_sink;
+    atexit(print_digest);
+}
+
+void output_set_sink(const OutputSink* sink) {
+    current_sink = sink;
+}
+
+const OutputSink* output_get_sink(void) {
+    return current_sink ? current_sink : default_sink;
+}
+
+void output_write(const char* data, size_t length) {
+    const OutputSink* sink = current_sink ? current_sink : default_sink;
+    sink->write(sink->context, data, length);
+}
+
+void output_write_string(const char* text) {
+    output_write(text, strlen(text));
+}
@@ -0,0 +1,26 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+
+// Destination for program output (the text produced by write statements).
+// Trace/debug output is not routed through the sink.
+typedef struct {
+    void (*write)(void* context, const char* data, size_t length);
+    void* context;
+} OutputSink;
+
+// Redirects program output of the calling thread; NULL restores the default (stdout)
+void output_set_sink(const OutputSink* sink);
+// Sink the calling thread currently writes to
+const OutputSink* output_get_sink(void);
+void output_write(const char* data, size_t length);
+// From now on, compresses the output that would go to stdout (compress.h
+// stream format), ending the stream at exit. Trace output must be off.
+void output_compress_stdout(void);
+// From now on, hashes the output that would go to stdout instead of writing
+// it; at exit prints only its XXH64 (16 hex digits) and length in bytes
+void output_digest_stdout(void);
+void output_write_string(const char* text);
+
+#endif // OUTPUT_H
@@ -12,6 +12,7 @@ int** goto_table = NULL;
 int num_states = 0;
 bool nullable_status[NUM_NON_TERMINALS_DEFINED];
 ItemSetList canonical_collection; // Global canonical collection (not a pointer)
+int max_nesting_depth = DEFAULT_MAX_NESTING_DEPTH;
 
 
 // --- Helper Functions for TerminalSet Operations ---
@@ -174,26 +175,25 @@ ASTNode* create_ast_leaf_from_token(const Token* token) {
             node->data.identifier.name = strdup(token->lexeme);
             node->data.identifier.symbol_table_index = token->value.symbol_index; // Assuming this is set by lexer/symbol table
             break;
-        case TOKEN_INTEGER: // Changed to handle BigInt
+        case TOKEN_INTEGER:
             node = create_ast_node(AST_INTEGER_LITERAL, token->location);
-            // Lexer provides integer as string in lexeme. Convert it to BigInt.
-            // The lexer's Token union uses `big_int_value`, copy it directly.
-            big_int_copy(&node->data.integer, &token->value.big_int_value);
+            // The lexer already converted the lexeme; repeated literals share one pool entry
+            node->data.constant = constant_pool_integer(&token->value.big_int_value);
             break;
-        case TOKEN_STRING:
+        case TOKEN_STRING: {
             node = create_ast_node(AST_STRING_LITERAL, token->location);
-            // Copy string content without quotes
-            if (strlen(token->lexeme) >= 2) {
-                node->data.string_value = strndup(token->lexeme + 1, strlen(token->lexeme) - 2);
-            } else {
-                node->data.string_value = strdup(""); // Empty string if invalid
-            }
+            // The lexer interned the contents already
+            node->data.constant = token->value.string_constant;
             break;
+        }
         case TOKEN_NEWLINE: // Keep NEWLINE separate as it's a specific output action
             node = create_ast_node(AST_NEWLINE, token->location);
             break;
         // For other terminals which are keywords/punctuation that we might want to represent in AST for location/debugging
         case TOKEN_NUMBER:
+        case TOKEN_READ:
+        case TOKEN_VECTOR:
+        case TOKEN_INCLUDE:
         case TOKEN_WRITE:
         case TOKEN_REPEAT:
         case TOKEN_AND:
@@ -218,12 +218,56 @@ ASTNode* create_ast_leaf_from_token(const Token* token) {
 }
 
 
-// Recursive function to print the AST
-void print_ast_node(const ASTNode* node, int indent) {
-    if (!node) return;
+// --- Explicit-Stack Traversal ---
+
+// Entries kept inline before the walk stack moves to the heap
+#define AST_WALK_INLINE_ENTRIES 64
+
+typedef struct {
+    ASTNode* node;
+    int depth;
+} ASTWalkEntry;
+
+void ast_walk(ASTNode* root, bool loop_parts, ASTVisitor visit, void* context) {
+    ASTWalkEntry inline_entries[AST_WALK_INLINE_ENTRIES];
+    ASTWalkEntry* entries = inline_entries;
+    int count = 0, capacity = AST_WALK_INLINE_ENTRIES;
+
+    if (root) entries[count++] = (ASTWalkEntry){ root, 0 };
+    while (count > 0) {
+        ASTWalkEntry entry = entries[--count];
+        ASTNode* node = entry.node;
 
-    char str_buffer[MAX_BIGINT_STRING_LEN + 1]; // Buffer for printing BigInts
+        // Room for everything this node queues: its children plus a loop's count and body
+        int needed = count + node->num_children + 2;
+        if (needed > capacity) {
+            while (capacity < needed) capacity *= 2;
+            ASTWalkEntry* grown = entries == inline_entries ? (ASTWalkEntry*)malloc(capacity * sizeof(ASTWalkEntry))
+                                                            : (ASTWalkEntry*)realloc(entries, capacity * sizeof(ASTWalkEntry));
+            if (!grown) {
+                fprintf(stderr, "Memory allocation failed for AST walk stack.\n");
+                exit(EXIT_FAILURE);
+            }
+            if (entries == inline_entries) memcpy(grown, inline_entries, count * sizeof(ASTWalkEntry));
+            entries = grown;
+        }
+
+        // Pushed in reverse so they pop in order
+        if (loop_parts && node->type == AST_LOOP_STATEMENT) {
+            if (node->data.loop.body) entries[count++] = (ASTWalkEntry){ node->data.loop.body, entry.depth + 1 };
+            if (node->data.loop.count_expr) entries[count++] = (ASTWalkEntry){ node->data.loop.count_expr, entry.depth + 1 };
+        }
+        for (int i = node->num_children - 1; i >= 0; --i) {
+            if (node->children[i]) entries[count++] = (ASTWalkEntry){ node->children[i], entry.depth + 1 };
+        }
+        visit(node, entry.depth, context);
+    }
 
+    if (entries != inline_entries) free(entries);
+}
+
+static void print_visit(ASTNode* node, int depth, void* context) {
+    int indent = *(const int*)context + depth;
     for (int i = 0; i < indent; ++i) {
         printf("  "); // 2 spaces per indent level
     }
@@ -233,41 +277,77 @@ void print_ast_node(const ASTNode* node, int indent) {
         case AST_PROGRAM: printf("Program\n"); break;
         case AST_STATEMENT_LIST: printf("StatementList\n"); break;
         case AST_DECLARATION: printf("Declaration\n"); break;
+        case AST_VECTOR_DECLARATION: printf("VectorDeclaration\n"); break;
         case AST_ASSIGNMENT: printf("Assignment\n"); break;
         case AST_INCREMENT: printf("Increment\n"); break;
         case AST_DECREMENT: printf("Decrement\n"); break;
         case AST_WRITE_STATEMENT: printf("WriteStatement\n"); break;
+        case AST_READ_STATEMENT: printf("ReadStatement\n"); break;
+        case AST_INCLUDE_STATEMENT: printf("IncludeStatement\n"); break;
         case AST_OUTPUT_LIST: printf("OutputList\n"); break;
         case AST_LIST_ELEMENT: printf("ListElement\n"); break;
         case AST_LOOP_STATEMENT: printf("LoopStatement\n"); break;
         case AST_CODE_BLOCK: printf("CodeBlock\n"); break;
         case AST_IDENTIFIER: printf("Identifier: %s\n", node->data.identifier.name); break;
-        case AST_INTEGER_LITERAL:
-            big_int_to_string(&node->data.integer, str_buffer);
-            printf("Integer: %s\n", str_buffer);
-            break;
-        case AST_STRING_LITERAL: printf("String: \"%s\"\n", node->data.string_value); break;
+        case AST_INTEGER_LITERAL: printf("Integer: %s\n", node->data.constant->text); break;
+        case AST_STRING_LITERAL: printf("String: \"%s\"\n", node->data.constant->text); break;
         case AST_NEWLINE: printf("Newline\n"); break;
         case AST_INT_VALUE: printf("Int_Value\n"); break; // NEW
         case AST_KEYWORD: printf("Keyword: %s\n", node->data.keyword_lexeme); break; // NEW
         case AST_ERROR_NODE_TYPE: printf("ERROR_NODE\n"); break; // Updated from AST_ERROR
         default: printf("UNKNOWN_AST_NODE_TYPE (%d)\n", node->type); break;
     }
+}
 
-    // Recursively print children
-    for (int i = 0; i < node->num_children; ++i) {
-        print_ast_node(node->children[i], indent + 1);
-    }
+// Prints the tree rooted at node; a loop's count and body live in its data and are not printed
+void print_ast_node(const ASTNode* node, int indent) {
+    ast_walk((ASTNode*)node, false, print_visit, &indent);
 }
 
-// Recursive function to free AST nodes
-void free_ast_node(ASTNode* node) {
-    if (!node) return;
+// True if two trees have the same shape, node data and source locations
+bool ast_equal(const ASTNode* a, const ASTNode* b) {
+    if (!a || !b) return a == b;
+    if (a->type != b->type || a->num_children != b->num_children ||
+        a->location.line != b->location.line || a->location.column != b->location.column ||
+        a->location.offset != b->location.offset) {
+        return false;
+    }
+
+    switch (a->type) {
+        case AST_IDENTIFIER:
+            if (strcmp(a->data.identifier.name, b->data.identifier.name) != 0 ||
+                a->data.identifier.symbol_table_index != b->data.identifier.symbol_table_index) {
+                return false;
+            }
+            break;
+        case AST_INTEGER_LITERAL:
+        case AST_STRING_LITERAL:
+            // Interned, so equal literals share an entry
+            if (a->data.constant != b->data.constant) return false;
+            break;
+        case AST_KEYWORD:
+            if (strcmp(a->data.keyword_lexeme, b->data.keyword_lexeme) != 0) return false;
+            break;
+        case AST_LOOP_STATEMENT:
+            if (!ast_equal(a->data.loop.count_expr, b->data.loop.count_expr) ||
+                !ast_equal(a->data.loop.body, b->data.loop.body)) {
+                return false;
+            }
+            break;
+        default:
+            break;
+    }
 
-    // Free children first
-    for (int i = 0; i < node->num_children; ++i) {
-        free_ast_node(node->children[i]);
+    for (int i = 0; i < a->num_children; ++i) {
+        if (!ast_equal(a->children[i], b->children[i])) return false;
     }
+    return true;
+}
+
+// Frees one node; the walk has already queued its children, count and body
+static void free_visit(ASTNode* node, int depth, void* context) {
+    (void)depth;
+    (void)context;
     if (node->children) {
         free(node->children);
     }
@@ -279,17 +359,16 @@ void free_ast_node(ASTNode* node) {
                 free(node->data.identifier.name);
             }
             break;
-        case AST_STRING_LITERAL:
-            if (node->data.string_value) {
-                free(node->data.string_value);
-            }
-            break;
         case AST_KEYWORD:
             if (node->data.keyword_lexeme) {
                 free(node->data.keyword_lexeme);
             }
             break;
-        // No explicit free needed for BigInt, as it's stored by value
+        case AST_STATEMENT_LIST:
+            free(node->data.update_plan);
+            break;
+        // The count and body of a loop hang off its data and were queued by the walk
+        // Literals point into the constant pool, which owns them
         default:
             // No specific dynamically allocated data for other types
             break;
@@ -299,6 +378,11 @@ void free_ast_node(ASTNode* node) {
     free(node);
 }
 
+// Frees a whole tree
+void free_ast_node(ASTNode* node) {
+    ast_walk(node, true, free_visit, NULL);
+}
+
 // --- Semantic Action Functions ---
 // Each semantic action receives an array of ASTNode pointers corresponding
 // to the symbols on the right-hand side of the production rule.
@@ -316,13 +400,13 @@ ASTNode* semantic_action_passthrough(ASTNode** children) {
 
 // R0: S' -> Program EOF
 ASTNode* semantic_action_program(ASTNode** children) {
-    printf("[DEBUG SA] semantic_action_program called. children[0]->type: %d (expected AST_PROGRAM or AST_STATEMENT_LIST)\n", children[0]->type);
+    if (trace_enabled) printf("[DEBUG SA] semantic_action_program called. children[0]->type: %d (expected AST_PROGRAM or AST_STATEMENT_LIST)\n", children[0]->type);
     // children[0] is Program (which itself reduces to StatementList), children[1] is EOF.
     // We create a new AST_PROGRAM node as the true root, containing the StatementList.
     ASTNode* program_node = create_ast_node(AST_PROGRAM, children[0]->location);
     add_child_to_ast_node(program_node, children[0]); // Add the Program's AST (which is StatementList) as a child
 
-    printf("[DEBUG SA] Created AST_PROGRAM node (type %d) at address %p, with child type %d.\n", program_node->type, (void*)program_node, children[0]->type);
+    if (trace_enabled) printf("[DEBUG SA] Created AST_PROGRAM node (type %d) at address %p, with child type %d.\n", program_node->type, (void*)program_node, children[0]->type);
     return program_node;
 }
 
@@ -359,6 +443,15 @@ ASTNode* semantic_action_declaration(ASTNode** children) {
     return declaration_node;
 }
 
+// R25: <vector_declaration> -> vector IDENTIFIER ( <int_value> )
+ASTNode* semantic_action_vector_declaration(ASTNode** children) {
+    // children[0] is 'vector', children[1] is IDENTIFIER, children[3] is the length <int_value>
+    ASTNode* declaration_node = create_ast_node(AST_VECTOR_DECLARATION, children[1]->location);
+    add_child_to_ast_node(declaration_node, children[1]); // IDENTIFIER node
+    add_child_to_ast_node(declaration_node, children[3]); // <int_value> node
+    return declaration_node;
+}
+
 // R10: <assignment> -> IDENTIFIER := <int_value> // Changed to int_value
 ASTNode* semantic_action_assignment(ASTNode** children) {
     // children[0] is IDENTIFIER, children[1] is ':=', children[2] is <int_value>
@@ -395,6 +488,24 @@ ASTNode* semantic_action_write_statement(ASTNode** children) {
     return write_node;
 }
 
+// <read_statement> -> read IDENTIFIER
+ASTNode* semantic_action_read_statement(ASTNode** children) {
+    // children[0] is 'read' keyword, children[1] is IDENTIFIER; like a declaration,
+    // the statement is located at its IDENTIFIER
+    ASTNode* read_node = create_ast_node(AST_READ_STATEMENT, children[1]->location);
+    add_child_to_ast_node(read_node, children[1]); // IDENTIFIER node
+    return read_node;
+}
+
+// R27: <include_statement> -> include STRING
+ASTNode* semantic_action_include_statement(ASTNode** children) {
+    // children[0] is 'include' keyword, children[1] is the STRING path; the
+    // statement is located at its path, which diagnostics about the file point to
+    ASTNode* include_node = create_ast_node(AST_INCLUDE_STATEMENT, children[1]->location);
+    add_child_to_ast_node(include_node, children[1]); // STRING_LITERAL node
+    return include_node;
+}
+
 // R14: <loop_statement> -> repeat <int_value> times <statement>
 ASTNode* semantic_action_loop_statement_single(ASTNode** children) {
     // children[0] is 'repeat' (AST_KEYWORD), children[1] is <int_value>, children[2] is 'times' (AST_KEYWORD), children[3] is Statement
@@ -582,7 +693,7 @@ void compute_first_sets(const Grammar* grammar) {
     } while (changed);
 
     // Debugging print: Print computed FIRST sets
-    printf("\n--- Computed FIRST Sets ---\n");
+    if (trace_enabled) printf("\n--- Computed FIRST Sets ---\n");
     /*for (int i = 0; i < grammar->non_terminal_count; ++i) {
         if (grammar->non_terminals[i] != NULL) {
             printf("FIRST(%s): ", grammar->non_terminals[i]->name);
@@ -594,7 +705,7 @@ void compute_first_sets(const Grammar* grammar) {
             printf("\n");
         }
     }*/
-    printf("---------------------------\n");
+    if (trace_enabled) printf("---------------------------\n");
 }
 
 // Computes the FOLLOW set for all non-terminals
@@ -693,7 +804,7 @@ void compute_follow_sets(const Grammar* grammar) {
     } while (changed);
 
     // Debugging print: Print computed FOLLOW sets
-    printf("\n--- Computed FOLLOW Sets ---\n");
+    if (trace_enabled) printf("\n--- Computed FOLLOW Sets ---\n");
     /*for (int i = 0; i < grammar->non_terminal_count; ++i) {
         if (grammar->non_terminals[i] != NULL) {
             printf("FOLLOW(%s): ", grammar->non_terminals[i]->name);
@@ -705,7 +816,7 @@ void compute_follow_sets(const Grammar* grammar) {
             printf("\n");
         }
     }*/
-    printf("----------------------------\n");
+    if (trace_enabled) printf("----------------------------\n");
 }
 
 
@@ -837,7 +948,7 @@ void create_lr1_sets(const Grammar* grammar) {
         if (item->dot_pos == p->right_count) printf(".");
         printf(", %s\n", token_type_str(item->lookahead));
     }*/
-    printf("------------------------------\n");
+    if (trace_enabled) printf("------------------------------\n");
 
 
     int i = 0;
@@ -1071,7 +1182,7 @@ void build_parsing_tables(const Grammar* grammar, const ItemSetList* canonical_c
     }
 
     // Debugging: Print action table entry for State 0 and TOKEN_IDENTIFIER
-    printf("\n--- Debugging Action Table State 0, Token IDENTIFIER ---\n");
+    if (trace_enabled) printf("\n--- Debugging Action Table State 0, Token IDENTIFIER ---\n");
     /*if (0 < num_states && TOKEN_IDENTIFIER < NUM_TOKEN_TYPES) {
         ActionEntry dbg_action = action_table[0][TOKEN_IDENTIFIER];
         printf("Action[0][IDENTIFIER]: Type = %d (SHIFT=%d, REDUCE=%d, ACCEPT=%d, ERROR=%d), Target = %d\n",
@@ -1106,7 +1217,7 @@ void build_parsing_tables(const Grammar* grammar, const ItemSetList* canonical_c
     } else {
         printf("Debug state %d or token %s (%d) out of bounds.\n", debug_state, token_type_str(debug_token_type), debug_token_type);
     }*/
-    printf("----------------------------------------------------------\n");
+    if (trace_enabled) printf("----------------------------------------------------------\n");
 }
 
 // Frees the memory allocated for the parsing tables
@@ -1133,162 +1244,237 @@ void free_parsing_tables() {
 }
 
 
-// --- Main Parsing Function ---
-ASTNode* parse(const Grammar* grammar, Token* tokens, int num_tokens) {
-    // Parser stack: Stores state numbers and AST nodes
+// --- Push-style LR(1) Driver ---
 
-    StackEntry parse_stack[MAX_STATES + MAX_PRODUCTIONS]; // Max states + max symbols on RHS
-    int stack_ptr = 0;
+// Initial capacity of the parse stack; it grows on demand for deeply nested input.
+#define INITIAL_PARSE_STACK_CAPACITY (MAX_STATES + MAX_PRODUCTIONS)
 
+void lr_parser_init(LRParser* parser, const Grammar* grammar) {
+    parser->grammar = grammar;
+    parser->stack_capacity = INITIAL_PARSE_STACK_CAPACITY;
+    parser->stack = (StackEntry*)malloc(parser->stack_capacity * sizeof(StackEntry));
+    if (!parser->stack) {
+        fprintf(stderr, "Memory allocation failed for parse stack.\n");
+        exit(EXIT_FAILURE);
+    }
     // Push initial state (0) onto the stack
-    parse_stack[stack_ptr].state = 0;
-    parse_stack[stack_ptr].ast_node = NULL; // No AST node for initial state
-    stack_ptr++;
+    parser->stack[0].state = 0;
+    parser->stack[0].ast_node = NULL; // No AST node for initial state
+    parser->stack_ptr = 1;
+
+    parser->on_statement = NULL;
+    parser->statement_user_data = NULL;
+    parser->detach_statements = false;
+    parser->build_ast = true;
+    parser->report_errors = true;
+    parser->loop_depth = 0;
+    parser->result = NULL;
+    parser->error_msg[0] = '\0';
+}
 
-    int token_idx = 0;
-    Token current_token = tokens[token_idx]; // Start with the first token
+// Pushes a state/AST pair, growing the stack if needed
+static void lr_parser_push(LRParser* parser, int state, ASTNode* node) {
+    if (parser->stack_ptr >= parser->stack_capacity) {
+        int new_capacity = parser->stack_capacity * 2;
+        StackEntry* new_stack = (StackEntry*)realloc(parser->stack, new_capacity * sizeof(StackEntry));
+        if (!new_stack) {
+            fprintf(stderr, "Memory re-allocation failed for parse stack.\n");
+            exit(EXIT_FAILURE);
+        }
+        parser->stack = new_stack;
+        parser->stack_capacity = new_capacity;
+    }
+    parser->stack[parser->stack_ptr].state = state;
+    parser->stack[parser->stack_ptr].ast_node = node;
+    parser->stack_ptr++;
+}
 
-    printf("\n--- Starting Parsing ---\n");
+// Records a syntax error on the parser and reports it to stderr
+static ParseStatus lr_parser_fail(LRParser* parser, const char* message) {
+    snprintf(parser->error_msg, sizeof(parser->error_msg), "%s", message);
+    if (parser->report_errors) fprintf(stderr, "%s\n", parser->error_msg);
+    return PARSE_STATUS_ERROR;
+}
 
-    while (true) {
-        int current_state = parse_stack[stack_ptr - 1].state;
-        TokenType current_token_type = current_token.type;
-
-        // Basic check for out-of-bounds token type for action table lookup
-        if (current_token_type < 0 || current_token_type >= NUM_TOKEN_TYPES) { // Use NUM_TOKEN_TYPES
-             fprintf(stderr, "Parser Error: Invalid token type (%s, ID: %d) encountered at input line %d, column %d. This token is not a recognized terminal for parsing table lookup.\n",
-                     token_type_str(current_token_type), current_token_type, current_token.location.line, current_token.location.column);
-             return NULL;
-        }
+// Feeds one token into the driver: performs every reduction the token triggers,
+// then shifts it. Returns ACCEPT once production 0 (S' -> Program EOF) is reduced.
+ParseStatus lr_parser_feed(LRParser* parser, const Token* token) {
+    const Grammar* grammar = parser->grammar;
+    TokenType current_token_type = token->type;
+    char message[sizeof(parser->error_msg)];
+
+    // Basic check for out-of-bounds token type for action table lookup
+    if (current_token_type < 0 || current_token_type >= NUM_TOKEN_TYPES) { // Use NUM_TOKEN_TYPES
+        snprintf(message, sizeof(message), "Parser Error: Invalid token type (%s, ID: %d) encountered at input line %d, column %d. This token is not a recognized terminal for parsing table lookup.",
+                 token_type_str(current_token_type), current_token_type, token->location.line, token->location.column);
+        return lr_parser_fail(parser, message);
+    }
 
+    while (true) {
+        int current_state = parser->stack[parser->stack_ptr - 1].state;
         ActionEntry action = action_table[current_state][current_token_type];
 
-        /*printf("State: %d, Current Token: %s ('%s', Line:%d Col:%d) | Action: ",
-               current_state, token_type_str(current_token_type), current_token.lexeme,
-               current_token.location.line, current_token.location.column);*/
-
         switch (action.type) {
-            case ACTION_SHIFT: {
-                int next_state = action.target_state_or_production_id;
-                //printf("SHIFT %d\n", next_state);
-
-                // Create a leaf AST node for the shifted terminal if it's relevant.
-                ASTNode* shifted_node = create_ast_leaf_from_token(&current_token);
-
-                // Push next state and token's AST node onto stack
-                parse_stack[stack_ptr].state = next_state;
-                parse_stack[stack_ptr].ast_node = shifted_node; // Attach AST node (can be NULL for some terminals)
-                stack_ptr++;
-
-                // Advance input token
-                token_idx++;
-                if (token_idx < num_tokens) {
-                    current_token = tokens[token_idx];
-                } else {
-                    // This scenario means we ran out of tokens unexpectedly before reaching an explicit TOKEN_EOF.
-                    // For robustness, set current_token to EOF.
-                    current_token.type = TOKEN_EOF;
-                    strncpy(current_token.lexeme, "EOF", MAX_LEXEME_LENGTH);
-                    current_token.lexeme[MAX_LEXEME_LENGTH-1] = '\0';
-                    // Adjust location to be at the end of the last token, or just indicate EOF
-                    if (num_tokens > 0) {
-                        current_token.location = (SourceLocation){ .line = tokens[num_tokens-1].location.line, .column = tokens[num_tokens-1].location.column + strlen(tokens[num_tokens-1].lexeme), .filename = tokens[num_tokens-1].location.filename };
-                    } else {
-                        current_token.location = (SourceLocation){ .line = 1, .column = 0, .filename = grammar->terminals[TOKEN_EOF]->name }; // Or a dummy filename
-                    }
+            case ACTION_SHIFT:
+                if (current_token_type == TOKEN_REPEAT && ++parser->loop_depth > max_nesting_depth) {
+                    snprintf(message, sizeof(message), "Parser Error: Loops nested deeper than %d at line %d, column %d.",
+                             max_nesting_depth, token->location.line, token->location.column);
+                    return lr_parser_fail(parser, message);
                 }
-                break;
-            }
+                // Create a leaf AST node for the shifted terminal and push it with the next state
+                lr_parser_push(parser, action.target_state_or_production_id,
+                               parser->build_ast ? create_ast_leaf_from_token(token) : NULL);
+                // Nothing follows EOF, so it doubles as the lookahead for reducing S' -> Program EOF
+                if (current_token_type == TOKEN_EOF) break;
+                return PARSE_STATUS_CONTINUE;
+
             case ACTION_REDUCE: {
                 int prod_id = action.target_state_or_production_id;
-                const Production* p = &grammar->productions[prod_id]; // Use const Production*
-                //printf("REDUCE by %s -> ", p->left_symbol->name);
-                for (int k = 0; k < p->right_count; ++k) {
-                    //printf("%s ", p->right_symbols[k]->name);
-                }
-                //printf(" (Production %d)\n", prod_id);
-
-                // Pop RHS symbols from stack and collect their AST nodes for semantic action
-                ASTNode** children_ast_nodes = NULL;
-                if (p->right_count > 0) {
-                    children_ast_nodes = (ASTNode**)malloc(p->right_count * sizeof(ASTNode*));
-                    if (!children_ast_nodes) {
-                        fprintf(stderr, "Memory allocation failed for children_ast_nodes during reduction.\n");
-                        exit(EXIT_FAILURE);
-                    }
-                    for (int k = 0; k < p->right_count; ++k) {
-                        // Pop from the end of the stack, in reverse order of RHS
-                        children_ast_nodes[p->right_count - 1 - k] = parse_stack[stack_ptr - 1 - k].ast_node;
+                const Production* p = &grammar->productions[prod_id];
+                if (p->left_symbol->id == NT_LOOP_STATEMENT) parser->loop_depth--;
+
+                if (!parser->build_ast) {
+                    // Recognition only: the table lookups are all there is to a reduction
+                    parser->stack_ptr -= p->right_count;
+                    if (prod_id == 0) return PARSE_STATUS_ACCEPT;
+                    int goto_state = goto_table[parser->stack[parser->stack_ptr - 1].state][p->left_symbol->id];
+                    if (goto_state == -1) {
+                        snprintf(message, sizeof(message), "Parser Error: No GOTO entry for state %d on non-terminal %s (ID: %d).",
+                                 parser->stack[parser->stack_ptr - 1].state, p->left_symbol->name, p->left_symbol->id);
+                        return lr_parser_fail(parser, message);
                     }
+                    lr_parser_push(parser, goto_state, NULL);
+                    break;
                 }
 
-                stack_ptr -= p->right_count; // Pop states and AST nodes for RHS
+                // Pop RHS symbols from stack and collect their AST nodes for semantic action.
+                // The RHS entries are contiguous at the top of the stack, in RHS order.
+                ASTNode* children_ast_nodes[MAX_PRODUCTIONS];
+                for (int k = 0; k < p->right_count; ++k) {
+                    children_ast_nodes[k] = parser->stack[parser->stack_ptr - p->right_count + k].ast_node;
+                }
+                parser->stack_ptr -= p->right_count;
 
                 // Call semantic action to get AST node for LHS
                 ASTNode* lhs_ast_node = NULL;
-                //printf("  Calling semantic action for production %d (%s -> ...)\n", prod_id, p->left_symbol->name);
                 if (p->semantic_action) {
                     lhs_ast_node = p->semantic_action(children_ast_nodes);
-                } else {
-                    // Fallback: if no semantic action, just pass through the first child if it exists
-                    if (children_ast_nodes && p->right_count > 0) {
-                         lhs_ast_node = children_ast_nodes[0];
-                    }
-                }
-                if (lhs_ast_node) {
-                    //printf("  Semantic action returned ASTNode of type %d.\n", lhs_ast_node->type);
-                } else {
-                    //printf("  Semantic action returned NULL.\n");
-                }
-
-                if (children_ast_nodes) {
-                    // Free the temporary array of child pointers.
-                    // The AST nodes themselves are owned by the new lhs_ast_node or will be freed during general cleanup.
-                    free(children_ast_nodes);
+                } else if (p->right_count > 0) {
+                    // Fallback: if no semantic action, just pass through the first child
+                    lhs_ast_node = children_ast_nodes[0];
                 }
 
                 // --- Check for ACCEPTANCE after reduction of the augmented start symbol ---
-                if (prod_id == 0) { // If production 0 (S' -> Program EOF) was just reduced
-                    //printf("ACCEPT (via S' reduction)\n");
-                    // The lhs_ast_node for production 0 should be the final AST_PROGRAM node
-                    // It's already pushed onto the stack correctly in the next steps.
-                    // Instead of pushing and then immediately returning, we just return it.
-                    // This node represents the complete AST.
-                    return lhs_ast_node;
+                if (prod_id == 0) {
+                    parser->result = lhs_ast_node;
+                    return PARSE_STATUS_ACCEPT;
                 }
 
+                // A StatementList reduced directly on top of state 0 has just gained a
+                // complete top-level statement (always its last RHS symbol).
+                if (p->left_symbol->id == NT_STATEMENT_LIST && parser->stack_ptr == 1 && parser->on_statement) {
+                    ASTNode* statement = children_ast_nodes[p->right_count - 1];
+                    if (parser->detach_statements && lhs_ast_node && lhs_ast_node->num_children > 0 &&
+                        lhs_ast_node->children[lhs_ast_node->num_children - 1] == statement) {
+                        lhs_ast_node->num_children--; // Ownership moves to the callback
+                    }
+                    parser->on_statement(statement, parser->statement_user_data);
+                }
 
                 // Push GoTo state for LHS non-terminal
-                int state_after_pop = parse_stack[stack_ptr - 1].state;
+                int state_after_pop = parser->stack[parser->stack_ptr - 1].state;
                 // Ensure non-terminal ID is within bounds for goto_table lookup
                 if (p->left_symbol->id >= NUM_NON_TERMINALS_DEFINED) {
-                    fprintf(stderr, "Parser Error: Non-terminal ID (%d) out of bounds for GOTO table lookup.\n", p->left_symbol->id);
-                    return NULL;
+                    snprintf(message, sizeof(message), "Parser Error: Non-terminal ID (%d) out of bounds for GOTO table lookup.", p->left_symbol->id);
+                    return lr_parser_fail(parser, message);
                 }
                 int goto_state = goto_table[state_after_pop][p->left_symbol->id];
-
                 if (goto_state == -1) {
-                    fprintf(stderr, "Parser Error: No GOTO entry for state %d on non-terminal %s (ID: %d).\n",
-                            state_after_pop, p->left_symbol->name, p->left_symbol->id);
-                    return NULL;
+                    snprintf(message, sizeof(message), "Parser Error: No GOTO entry for state %d on non-terminal %s (ID: %d).",
+                             state_after_pop, p->left_symbol->name, p->left_symbol->id);
+                    return lr_parser_fail(parser, message);
                 }
-
-                parse_stack[stack_ptr].state = goto_state;
-                parse_stack[stack_ptr].ast_node = lhs_ast_node; // Attach LHS AST node
-                stack_ptr++;
-                break;
+                lr_parser_push(parser, goto_state, lhs_ast_node);
+                break; // Keep reducing with the same lookahead
             }
             case ACTION_ACCEPT: // This case should now ideally not be hit.
-                fprintf(stderr, "Internal Parser Error: ACTION_ACCEPT type should have been converted to REDUCE for S' rule and handled explicitly.\n");
-                return NULL; // Should be handled by REDUCE of Production 0
+                return lr_parser_fail(parser, "Internal Parser Error: ACTION_ACCEPT type should have been converted to REDUCE for S' rule and handled explicitly.");
             case ACTION_ERROR:
             default:
-                fprintf(stderr, "\nParser Error: No valid action for state %d on token %s ('%s') at line %d, column %d.\\n",
-                        current_state, token_type_str(current_token_type), current_token.lexeme,
-                        current_token.location.line, current_token.location.column);
-                return NULL; // Parsing failed
+                snprintf(message, sizeof(message), "\nParser Error: No valid action for state %d on token %s ('%s') at line %d, column %d.",
+                         current_state, token_type_str(current_token_type), token->lexeme,
+                         token->location.line, token->location.column);
+                return lr_parser_fail(parser, message);
+        }
+    }
+}
+
+// Replaces the parse stack with a previously saved one (e.g. the stack at a
+// statement boundary), so parsing can resume mid-input from that point.
+void lr_parser_restore(LRParser* parser, const StackEntry* entries, int count) {
+    lr_parser_reset(parser);
+    parser->stack_ptr = 0;
+    for (int i = 0; i < count; ++i) {
+        lr_parser_push(parser, entries[i].state, entries[i].ast_node);
+    }
+}
+
+// Returns the driver to state 0 so another input can be parsed against the same
+// tables without reallocating the stack. Partial ASTs left by an error are freed.
+void lr_parser_reset(LRParser* parser) {
+    for (int i = 1; i < parser->stack_ptr; ++i) {
+        free_ast_node(parser->stack[i].ast_node);
+    }
+    parser->stack[0].state = 0;
+    parser->stack[0].ast_node = NULL;
+    parser->stack_ptr = 1;
+    parser->loop_depth = 0;
+    parser->result = NULL;
+    parser->error_msg[0] = '\0';
+}
+
+// Releases the parse stack together with any partial AST still sitting on it
+void lr_parser_free(LRParser* parser) {
+    if (parser->stack) {
+        for (int i = 0; i < parser->stack_ptr; ++i) {
+            free_ast_node(parser->stack[i].ast_node);
+        }
+        free(parser->stack);
+        parser->stack = NULL;
+    }
+    parser->stack_ptr = 0;
+    parser->stack_capacity = 0;
+}
+
+// --- Main Parsing Function ---
+// Runs the push-style driver over a complete token array.
+ASTNode* parse(const Grammar* grammar, Token* tokens, int num_tokens) {
+    LRParser parser;
+    lr_parser_init(&parser, grammar);
+
+    if (trace_enabled) printf("\n--- Starting Parsing ---\n");
+
+    ParseStatus status = PARSE_STATUS_CONTINUE;
+    for (int token_idx = 0; token_idx < num_tokens && status == PARSE_STATUS_CONTINUE; ++token_idx) {
+        status = lr_parser_feed(&parser, &tokens[token_idx]);
+    }
+
+    if (status == PARSE_STATUS_CONTINUE) {
+        // We ran out of tokens before reaching an explicit TOKEN_EOF.
+        // For robustness, synthesize one at the end of the last token.
+        Token eof_token;
+        eof_token.type = TOKEN_EOF;
+        strncpy(eof_token.lexeme, "EOF", MAX_LEXEME_LENGTH);
+        eof_token.lexeme[MAX_LEXEME_LENGTH - 1] = '\0';
+        if (num_tokens > 0) {
+            eof_token.location = (SourceLocation){ .line = tokens[num_tokens-1].location.line, .column = tokens[num_tokens-1].location.column + (int)strlen(tokens[num_tokens-1].lexeme), .filename = tokens[num_tokens-1].location.filename };
+        } else {
+            eof_token.location = (SourceLocation){ .line = 1, .column = 0, .filename = grammar->terminals[TOKEN_EOF]->name }; // Or a dummy filename
         }
+        status = lr_parser_feed(&parser, &eof_token);
     }
-    // This line should technically not be reached, but included for completeness.
-    return NULL; // Should be handled by ACCEPT or ERROR
+
+    ASTNode* result = (status == PARSE_STATUS_ACCEPT) ? parser.result : NULL;
+    lr_parser_free(&parser);
+    return result;
 }
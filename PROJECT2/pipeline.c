@@ -0,0 +1,362 @@
+#include "pipeline.h"
+#include "lexer.h"
+#include "interpreter.h"
+#include "units.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+// --- Bounded lock-free single-producer/single-consumer queue ---
+// head is only advanced by the consumer and tail only by the producer, so each
+// index has a single writer; acquire/release ordering publishes the slot contents.
+// A side that finds the queue full (or empty) spins briefly, then parks on the
+// condition variable. The other side only takes the lock to wake it when the
+// waiter count says someone is parked, so the fast path stays lock-free.
+typedef struct {
+    void* slots[PIPELINE_QUEUE_CAPACITY];
+    _Alignas(64) atomic_size_t head; // Next slot to pop (consumer-owned)
+    _Alignas(64) atomic_size_t tail; // Next slot to push (producer-owned)
+    _Alignas(64) atomic_int waiters; // Threads parked (or about to park) on changed
+    pthread_mutex_t lock;
+    pthread_cond_t changed; // Signalled when head or tail moves, or on stop
+} SpscQueue;
+
+static void spsc_init(SpscQueue* queue) {
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->waiters, 0);
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+}
+
+static void spsc_destroy(SpscQueue* queue) {
+    pthread_cond_destroy(&queue->changed);
+    pthread_mutex_destroy(&queue->lock);
+}
+
+// Wakes every thread parked on the queue
+static void spsc_wake(SpscQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// Called after moving head or tail. The sequentially consistent store before
+// this load pairs with the waiter's increment before its re-check, so either
+// the waiter sees the new index or this sees the waiter.
+static void spsc_notify(SpscQueue* queue) {
+    if (atomic_load(&queue->waiters) > 0) spsc_wake(queue);
+}
+
+static bool spsc_full(SpscQueue* queue, size_t tail) {
+    return tail - atomic_load(&queue->head) >= PIPELINE_QUEUE_CAPACITY;
+}
+
+static bool spsc_empty(SpscQueue* queue, size_t head) {
+    return head == atomic_load(&queue->tail);
+}
+
+// Blocks until blocked(queue, index) is false or the pipeline is stopped:
+// PIPELINE_SPIN_LIMIT yields first, then sleeps on the condition variable.
+// Returns false if stopped.
+static bool spsc_wait(SpscQueue* queue, size_t index, bool (*blocked)(SpscQueue*, size_t), atomic_bool* stop) {
+    for (int spin = 0; blocked(queue, index); ++spin) {
+        if (atomic_load(stop)) return false;
+        if (spin < PIPELINE_SPIN_LIMIT) {
+            sched_yield();
+            continue;
+        }
+        pthread_mutex_lock(&queue->lock);
+        atomic_fetch_add(&queue->waiters, 1);
+        while (blocked(queue, index) && !atomic_load(stop)) {
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        }
+        atomic_fetch_sub(&queue->waiters, 1);
+        pthread_mutex_unlock(&queue->lock);
+        spin = 0;
+    }
+    return true;
+}
+
+// Pushes an item, waiting while the queue is full. Returns false if the
+// pipeline was stopped before space became available.
+static bool spsc_push(SpscQueue* queue, void* item, atomic_bool* stop) {
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    if (!spsc_wait(queue, tail, spsc_full, stop)) return false;
+    queue->slots[tail & (PIPELINE_QUEUE_CAPACITY - 1)] = item;
+    atomic_store(&queue->tail, tail + 1);
+    spsc_notify(queue);
+    return true;
+}
+
+// Pops an item, waiting while the queue is empty. Returns NULL if the
+// pipeline was stopped and nothing is left to consume.
+static void* spsc_pop(SpscQueue* queue, atomic_bool* stop) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    if (!spsc_wait(queue, head, spsc_empty, stop)) return NULL;
+    void* item = queue->slots[head & (PIPELINE_QUEUE_CAPACITY - 1)];
+    atomic_store(&queue->head, head + 1);
+    spsc_notify(queue);
+    return item;
+}
+
+// Non-blocking pop used to drain leftovers after the threads have been joined
+static void* spsc_try_pop(SpscQueue* queue) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&queue->tail, memory_order_acquire)) return NULL;
+    void* item = queue->slots[head & (PIPELINE_QUEUE_CAPACITY - 1)];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return item;
+}
+
+// --- Batches passed between stages ---
+typedef struct {
+    Token tokens[PIPELINE_TOKEN_BATCH_SIZE];
+    int count;
+    bool last; // Ends with TOKEN_EOF or TOKEN_ERROR
+} TokenBatch;
+
+typedef struct {
+    ASTNode* statements[PIPELINE_STATEMENT_BATCH_SIZE];
+    int count;
+    bool last; // Program accepted, no more statements follow
+} StatementBatch;
+
+typedef struct {
+    const Grammar* grammar;
+    FILE* input;
+    const char* filename;
+    UnitParser parse_unit;
+    void* parse_context;
+
+    SpscQueue token_queue;     // lexer -> parser
+    SpscQueue statement_queue; // parser -> interpreter
+
+    atomic_bool stop;   // Raised by a failing stage; makes the other stages bail out
+    atomic_bool failed; // True once any stage reported an error
+
+    StatementBatch* pending; // Parser-side batch being filled
+    bool includes_seen;      // Parser side: an include token went by, so statements need linking
+    bool link_failed;        // Parser side: a statement could not be linked
+} Pipeline;
+
+static void* alloc_batch(size_t size) {
+    void* batch = malloc(size);
+    if (!batch) {
+        fprintf(stderr, "Memory allocation failed for pipeline batch.\n");
+        exit(EXIT_FAILURE);
+    }
+    return batch;
+}
+
+static void free_statement_batch(StatementBatch* batch) {
+    if (!batch) return;
+    for (int i = 0; i < batch->count; ++i) {
+        free_ast_node(batch->statements[i]);
+    }
+    free(batch);
+}
+
+static void pipeline_abort(Pipeline* pipeline) {
+    atomic_store_explicit(&pipeline->failed, true, memory_order_release);
+    atomic_store(&pipeline->stop, true);
+    // Parked stages re-check stop once woken
+    spsc_wake(&pipeline->token_queue);
+    spsc_wake(&pipeline->statement_queue);
+}
+
+// --- Stage 1: lexer thread ---
+static void* lexer_stage(void* arg) {
+    Pipeline* pipeline = (Pipeline*)arg;
+    LexContext* ctx = (LexContext*)alloc_batch(sizeof(LexContext));
+    init_lexer(ctx, pipeline->input, pipeline->filename);
+
+    bool done = false;
+    while (!done && !atomic_load_explicit(&pipeline->stop, memory_order_acquire)) {
+        TokenBatch* batch = (TokenBatch*)alloc_batch(sizeof(TokenBatch));
+        batch->count = 0;
+        batch->last = false;
+        while (batch->count < PIPELINE_TOKEN_BATCH_SIZE) {
+            Token* token = &batch->tokens[batch->count++];
+            *token = get_next_token(ctx);
+            if (token->type == TOKEN_EOF || token->type == TOKEN_ERROR) {
+                batch->last = true;
+                done = true;
+                break;
+            }
+        }
+        if (!spsc_push(&pipeline->token_queue, batch, &pipeline->stop)) {
+            free(batch);
+            break;
+        }
+    }
+
+    free_lex_context(ctx);
+    free(ctx);
+    return NULL;
+}
+
+// --- Stage 2: parser thread ---
+static bool flush_statements(Pipeline* pipeline, bool last) {
+    StatementBatch* batch = pipeline->pending;
+    batch->last = last;
+    pipeline->pending = NULL;
+    if (!spsc_push(&pipeline->statement_queue, batch, &pipeline->stop)) {
+        free_statement_batch(batch);
+        return false;
+    }
+    return true;
+}
+
+static void add_statement(Pipeline* pipeline, ASTNode* statement) {
+    if (!pipeline->pending) {
+        pipeline->pending = (StatementBatch*)alloc_batch(sizeof(StatementBatch));
+        pipeline->pending->count = 0;
+    }
+    pipeline->pending->statements[pipeline->pending->count++] = statement;
+    if (pipeline->pending->count == PIPELINE_STATEMENT_BATCH_SIZE) {
+        flush_statements(pipeline, false);
+    }
+}
+
+static void collect_statement(ASTNode* statement, void* user_data) {
+    Pipeline* pipeline = (Pipeline*)user_data;
+    if (pipeline->link_failed) {
+        free_ast_node(statement);
+        return;
+    }
+    if (!pipeline->includes_seen) {
+        add_statement(pipeline, statement);
+        return;
+    }
+    // Linked here rather than on the interpreter thread, so reading and
+    // parsing included files overlaps execution like the script's own text
+    ASTNode* list = create_ast_node(AST_STATEMENT_LIST, statement->location);
+    add_child_to_ast_node(list, statement);
+    if (units_link_list(list, pipeline->filename, pipeline->parse_unit, pipeline->parse_context, NULL)) {
+        for (int i = 0; i < list->num_children; ++i) add_statement(pipeline, list->children[i]);
+        list->num_children = 0;
+    } else {
+        pipeline->link_failed = true;
+    }
+    free_ast_node(list);
+}
+
+static void* parser_stage(void* arg) {
+    Pipeline* pipeline = (Pipeline*)arg;
+    LRParser parser;
+    lr_parser_init(&parser, pipeline->grammar);
+    parser.on_statement = collect_statement;
+    parser.statement_user_data = pipeline;
+    parser.detach_statements = true; // The interpreter thread owns and frees executed statements
+
+    ParseStatus status = PARSE_STATUS_CONTINUE;
+    while (status == PARSE_STATUS_CONTINUE) {
+        TokenBatch* batch = (TokenBatch*)spsc_pop(&pipeline->token_queue, &pipeline->stop);
+        if (!batch) break; // Stopped by another stage
+
+        for (int i = 0; i < batch->count && status == PARSE_STATUS_CONTINUE; ++i) {
+            if (batch->tokens[i].type == TOKEN_ERROR) {
+                fprintf(stderr, "Lexical analysis failed or encountered errors. Aborting parsing.\n");
+                status = PARSE_STATUS_ERROR;
+                break;
+            }
+            if (batch->tokens[i].type == TOKEN_INCLUDE) pipeline->includes_seen = true;
+            status = lr_parser_feed(&parser, &batch->tokens[i]);
+            if (pipeline->link_failed) status = PARSE_STATUS_ERROR; // Already reported
+        }
+        if (status == PARSE_STATUS_CONTINUE && batch->last) {
+            // EOF was consumed without the start production being reduced
+            fprintf(stderr, "Parser Error: Unexpected end of input.\n");
+            status = PARSE_STATUS_ERROR;
+        }
+        free(batch);
+    }
+
+    if (status == PARSE_STATUS_ACCEPT) {
+        // All statements were detached, so only the empty program shell remains
+        free_ast_node(parser.result);
+        if (!pipeline->pending) {
+            pipeline->pending = (StatementBatch*)alloc_batch(sizeof(StatementBatch));
+            pipeline->pending->count = 0;
+        }
+        flush_statements(pipeline, true);
+    } else {
+        pipeline_abort(pipeline);
+        free_statement_batch(pipeline->pending);
+        pipeline->pending = NULL;
+    }
+    lr_parser_free(&parser);
+    return NULL;
+}
+
+// --- Stage 3: interpreter (runs on the calling thread) ---
+bool run_pipeline(const Grammar* grammar, FILE* input, const char* filename, UnitParser parse_unit,
+                  void* parse_context) {
+    Pipeline* pipeline = (Pipeline*)alloc_batch(sizeof(Pipeline));
+    pipeline->grammar = grammar;
+    pipeline->input = input;
+    pipeline->filename = filename;
+    pipeline->parse_unit = parse_unit;
+    pipeline->parse_context = parse_context;
+    pipeline->pending = NULL;
+    pipeline->includes_seen = false;
+    pipeline->link_failed = false;
+    spsc_init(&pipeline->token_queue);
+    spsc_init(&pipeline->statement_queue);
+    atomic_init(&pipeline->stop, false);
+    atomic_init(&pipeline->failed, false);
+
+    pthread_t lexer_thread, parser_thread;
+    if (pthread_create(&lexer_thread, NULL, lexer_stage, pipeline) != 0) {
+        fprintf(stderr, "Error: Could not start lexer thread.\n");
+        spsc_destroy(&pipeline->token_queue);
+        spsc_destroy(&pipeline->statement_queue);
+        free(pipeline);
+        return false;
+    }
+    if (pthread_create(&parser_thread, NULL, parser_stage, pipeline) != 0) {
+        fprintf(stderr, "Error: Could not start parser thread.\n");
+        pipeline_abort(pipeline);
+        pthread_join(lexer_thread, NULL);
+        free(spsc_try_pop(&pipeline->token_queue));
+        spsc_destroy(&pipeline->token_queue);
+        spsc_destroy(&pipeline->statement_queue);
+        free(pipeline);
+        return false;
+    }
+
+    interpreter_begin();
+    bool finished = false;
+    while (!finished) {
+        StatementBatch* batch = (StatementBatch*)spsc_pop(&pipeline->statement_queue, &pipeline->stop);
+        if (!batch) break; // An earlier stage failed
+        for (int i = 0; i < batch->count; ++i) {
+            // A syntax error further down the input stops execution promptly
+            if (atomic_load_explicit(&pipeline->failed, memory_order_acquire)) break;
+            interpret_top_level_statement(batch->statements[i]);
+        }
+        finished = batch->last;
+        free_statement_batch(batch);
+    }
+    interpreter_end();
+
+    if (!finished) pipeline_abort(pipeline);
+    pthread_join(parser_thread, NULL);
+    pthread_join(lexer_thread, NULL);
+
+    // Release anything left in flight after an abort
+    void* leftover;
+    while ((leftover = spsc_try_pop(&pipeline->token_queue)) != NULL) free(leftover);
+    while ((leftover = spsc_try_pop(&pipeline->statement_queue)) != NULL) free_statement_batch((StatementBatch*)leftover);
+
+    bool ok = finished && !atomic_load(&pipeline->failed);
+    spsc_destroy(&pipeline->token_queue);
+    spsc_destroy(&pipeline->statement_queue);
+    free(pipeline);
+    return ok;
+}
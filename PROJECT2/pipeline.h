@@ -0,0 +1,27 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "parser.h"
+#include "units.h"
+
+// Number of tokens the lexer thread hands to the parser thread at once
+#define PIPELINE_TOKEN_BATCH_SIZE 256
+// Number of top-level statements the parser thread hands to the interpreter at once
+#define PIPELINE_STATEMENT_BATCH_SIZE 64
+// Slots in each bounded queue between two stages (must be a power of two)
+#define PIPELINE_QUEUE_CAPACITY 64
+// Yields a stage makes on a full or empty queue before it sleeps until woken
+#define PIPELINE_SPIN_LIMIT 64
+
+// Runs lexing, parsing and execution concurrently on three threads connected by
+// bounded single-producer/single-consumer queues (lock-free unless a stage has to
+// wait). The parsing tables must already be built. The parser thread links the
+// includes of each statement (units.h) with parse_unit before handing it on; a
+// Link Error stops the run like a syntax error does. Returns true if the whole
+// input was lexed, parsed, linked and run.
+bool run_pipeline(const Grammar* grammar, FILE* input, const char* filename, UnitParser parse_unit,
+                  void* parse_context);
+
+#endif // PIPELINE_H
@@ -0,0 +1,250 @@
+#include "rdparser.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    const Token* tokens;
+    int count;
+    int pos;
+    int loop_depth;    // repeat statements being parsed; bounded by max_nesting_depth
+} RDParser;
+
+// --- Token Access ---
+
+static const Token* rd_peek(const RDParser* rd) {
+    // Past the end only happens on arrays without EOF; the last token stands in for it
+    return &rd->tokens[rd->pos < rd->count ? rd->pos : rd->count - 1];
+}
+
+static const Token* rd_advance(RDParser* rd) {
+    const Token* token = rd_peek(rd);
+    if (rd->pos < rd->count) rd->pos++;
+    return token;
+}
+
+static void rd_error(const RDParser* rd, const char* expected) {
+    const Token* token = rd_peek(rd);
+    fprintf(stderr, "Parser Error: Unexpected token %s ('%s') at line %d, column %d; expected %s.\n",
+            token_type_str(token->type), token->lexeme, token->location.line, token->location.column, expected);
+}
+
+// Consumes a token of the given type; reports an error naming `expected` otherwise
+static const Token* rd_expect(RDParser* rd, TokenType type, const char* expected) {
+    if (rd_peek(rd)->type != type) {
+        rd_error(rd, expected);
+        return NULL;
+    }
+    return rd_advance(rd);
+}
+
+// --- Productions ---
+
+static ASTNode* rd_statement(RDParser* rd);
+
+// <int_value> -> INTEGER | IDENTIFIER
+static ASTNode* rd_int_value(RDParser* rd) {
+    const Token* token = rd_peek(rd);
+    if (token->type != TOKEN_INTEGER && token->type != TOKEN_IDENTIFIER) {
+        rd_error(rd, "an integer or identifier");
+        return NULL;
+    }
+    rd_advance(rd);
+    ASTNode* int_value_node = create_ast_node(AST_INT_VALUE, token->location);
+    add_child_to_ast_node(int_value_node, create_ast_leaf_from_token(token));
+    return int_value_node;
+}
+
+// <list_element> -> <int_value> | STRING | newline
+static ASTNode* rd_list_element(RDParser* rd) {
+    const Token* token = rd_peek(rd);
+    ASTNode* element;
+    if (token->type == TOKEN_STRING || token->type == TOKEN_NEWLINE) {
+        element = create_ast_leaf_from_token(rd_advance(rd));
+    } else if (token->type == TOKEN_INTEGER || token->type == TOKEN_IDENTIFIER) {
+        element = rd_int_value(rd);
+    } else {
+        rd_error(rd, "an integer, identifier, string or newline");
+        return NULL;
+    }
+    ASTNode* list_element_node = create_ast_node(AST_LIST_ELEMENT, element->location);
+    add_child_to_ast_node(list_element_node, element);
+    return list_element_node;
+}
+
+// <write_statement> -> write <list_element> (and <list_element>)*
+static ASTNode* rd_write_statement(RDParser* rd) {
+    const Token* write_token = rd_advance(rd);
+    ASTNode* element = rd_list_element(rd);
+    if (!element) return NULL;
+    ASTNode* output_list = create_ast_node(AST_OUTPUT_LIST, element->location);
+    add_child_to_ast_node(output_list, element);
+    while (rd_peek(rd)->type == TOKEN_AND) {
+        rd_advance(rd);
+        if (!(element = rd_list_element(rd))) {
+            free_ast_node(output_list);
+            return NULL;
+        }
+        add_child_to_ast_node(output_list, element);
+    }
+    ASTNode* write_node = create_ast_node(AST_WRITE_STATEMENT, write_token->location);
+    add_child_to_ast_node(write_node, output_list);
+    return write_node;
+}
+
+// <assignment> / <increment> / <decrement> -> IDENTIFIER (:= | += | -=) <int_value>
+static ASTNode* rd_update(RDParser* rd) {
+    const Token* identifier = rd_advance(rd);
+    ASTNodeType type;
+    switch (rd_peek(rd)->type) {
+        case TOKEN_ASSIGN: type = AST_ASSIGNMENT; break;
+        case TOKEN_PLUS_ASSIGN: type = AST_INCREMENT; break;
+        case TOKEN_MINUS_ASSIGN: type = AST_DECREMENT; break;
+        default:
+            rd_error(rd, "':=', '+=' or '-='");
+            return NULL;
+    }
+    rd_advance(rd);
+    ASTNode* value = rd_int_value(rd);
+    if (!value) return NULL;
+    ASTNode* node = create_ast_node(type, identifier->location);
+    add_child_to_ast_node(node, create_ast_leaf_from_token(identifier));
+    add_child_to_ast_node(node, value);
+    return node;
+}
+
+// <statement_list> -> <statement>+, ending before `end` (EOF or '}')
+static ASTNode* rd_statement_list(RDParser* rd, TokenType end) {
+    ASTNode* statement = rd_statement(rd);
+    if (!statement) return NULL;
+    ASTNode* stmt_list = create_ast_node(AST_STATEMENT_LIST, statement->location);
+    add_child_to_ast_node(stmt_list, statement);
+    while (rd_peek(rd)->type != end) {
+        if (!(statement = rd_statement(rd))) {
+            free_ast_node(stmt_list);
+            return NULL;
+        }
+        add_child_to_ast_node(stmt_list, statement);
+    }
+    return stmt_list;
+}
+
+// <loop_statement> -> repeat <int_value> times (<statement> | { <statement_list> })
+static ASTNode* rd_loop_statement(RDParser* rd) {
+    const Token* repeat_token = rd_advance(rd);
+    ASTNode* count = rd_int_value(rd);
+    if (!count) return NULL;
+    if (!rd_expect(rd, TOKEN_TIMES, "'times'")) {
+        free_ast_node(count);
+        return NULL;
+    }
+
+    ASTNode* body;
+    if (rd_peek(rd)->type == TOKEN_OPENB) {
+        const Token* open = rd_advance(rd);
+        ASTNode* stmt_list = rd_statement_list(rd, TOKEN_CLOSEB);
+        if (!stmt_list) {
+            free_ast_node(count);
+            return NULL;
+        }
+        rd_advance(rd); // '}', the only token that ends a block's list
+        body = create_ast_node(AST_CODE_BLOCK, open->location);
+        add_child_to_ast_node(body, stmt_list);
+    } else if (!(body = rd_statement(rd))) {
+        free_ast_node(count);
+        return NULL;
+    }
+
+    ASTNode* loop_node = create_ast_node(AST_LOOP_STATEMENT, repeat_token->location);
+    loop_node->data.loop.count_expr = count;
+    loop_node->data.loop.body = body;
+    return loop_node;
+}
+
+// <statement> -> <declaration> ; | <vector_declaration> ; | <assignment> ; | <increment> ;
+//              | <decrement> ; | <write_statement> ; | <read_statement> ; | <loop_statement>
+static ASTNode* rd_statement(RDParser* rd) {
+    ASTNode* statement;
+    switch (rd_peek(rd)->type) {
+        case TOKEN_REPEAT: {
+            if (rd->loop_depth >= max_nesting_depth) {
+                const Token* token = rd_peek(rd);
+                fprintf(stderr, "Parser Error: Loops nested deeper than %d at line %d, column %d.\n",
+                        max_nesting_depth, token->location.line, token->location.column);
+                return NULL;
+            }
+            rd->loop_depth++;
+            statement = rd_loop_statement(rd);
+            rd->loop_depth--;
+            return statement;
+        }
+        case TOKEN_NUMBER: {
+            rd_advance(rd);
+            const Token* identifier = rd_expect(rd, TOKEN_IDENTIFIER, "an identifier");
+            if (!identifier) return NULL;
+            statement = create_ast_node(AST_DECLARATION, identifier->location);
+            add_child_to_ast_node(statement, create_ast_leaf_from_token(identifier));
+            break;
+        }
+        case TOKEN_VECTOR: {
+            rd_advance(rd);
+            const Token* identifier = rd_expect(rd, TOKEN_IDENTIFIER, "an identifier");
+            if (!identifier || !rd_expect(rd, TOKEN_LPAREN, "'('")) return NULL;
+            ASTNode* length = rd_int_value(rd);
+            if (!length) return NULL;
+            if (!rd_expect(rd, TOKEN_RPAREN, "')'")) {
+                free_ast_node(length);
+                return NULL;
+            }
+            statement = create_ast_node(AST_VECTOR_DECLARATION, identifier->location);
+            add_child_to_ast_node(statement, create_ast_leaf_from_token(identifier));
+            add_child_to_ast_node(statement, length);
+            break;
+        }
+        case TOKEN_READ: {
+            rd_advance(rd);
+            const Token* identifier = rd_expect(rd, TOKEN_IDENTIFIER, "an identifier");
+            if (!identifier) return NULL;
+            statement = create_ast_node(AST_READ_STATEMENT, identifier->location);
+            add_child_to_ast_node(statement, create_ast_leaf_from_token(identifier));
+            break;
+        }
+        case TOKEN_INCLUDE: {
+            rd_advance(rd);
+            const Token* path = rd_expect(rd, TOKEN_STRING, "a file name string");
+            if (!path) return NULL;
+            statement = create_ast_node(AST_INCLUDE_STATEMENT, path->location);
+            add_child_to_ast_node(statement, create_ast_leaf_from_token(path));
+            break;
+        }
+        case TOKEN_IDENTIFIER:
+            statement = rd_update(rd);
+            break;
+        case TOKEN_WRITE:
+            statement = rd_write_statement(rd);
+            break;
+        default:
+            rd_error(rd, "a statement");
+            return NULL;
+    }
+    if (!statement) return NULL;
+    if (!rd_expect(rd, TOKEN_EOL, "';'")) {
+        free_ast_node(statement);
+        return NULL;
+    }
+    return statement;
+}
+
+// --- Entry Point ---
+
+ASTNode* rd_parse(const Token* tokens, int num_tokens) {
+    if (!tokens || num_tokens <= 0) return NULL;
+    RDParser rd = { .tokens = tokens, .count = num_tokens, .pos = 0, .loop_depth = 0 };
+
+    if (trace_enabled) printf("\n--- Starting Parsing (recursive descent) ---\n");
+
+    ASTNode* stmt_list = rd_statement_list(&rd, TOKEN_EOF);
+    if (!stmt_list) return NULL;
+    ASTNode* program_node = create_ast_node(AST_PROGRAM, stmt_list->location);
+    add_child_to_ast_node(program_node, stmt_list);
+    return program_node;
+}
@@ -0,0 +1,15 @@
+#ifndef RDPARSER_H
+#define RDPARSER_H
+
+#include "parser.h"
+
+// Hand-written recursive-descent parser for the same language as the LR(1)
+// grammar. It builds exactly the AST the LR driver's semantic actions build
+// (same node types, children, data and locations) but needs no grammar,
+// FIRST/FOLLOW sets or tables, and allocates no nodes for keywords or
+// punctuation. On a syntax error, or loops nested deeper than max_nesting_depth
+// (which bounds its recursion), it reports the offending token to stderr and
+// returns NULL. The token array must end with TOKEN_EOF.
+ASTNode* rd_parse(const Token* tokens, int num_tokens);
+
+#endif // RDPARSER_H
@@ -0,0 +1,110 @@
+#include "reexec.h"
+#include "output.h"
+#include "input.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} OutputBuffer;
+
+static void buffer_append(OutputBuffer* buffer, const char* data, size_t length) {
+    if (buffer->length + length > buffer->capacity) {
+        size_t new_capacity = buffer->capacity == 0 ? 4096 : buffer->capacity;
+        while (new_capacity < buffer->length + length) new_capacity *= 2;
+        buffer->data = (char*)realloc(buffer->data, new_capacity);
+        if (!buffer->data) {
+            fprintf(stderr, "Memory allocation failed for re-execution output.\n");
+            exit(EXIT_FAILURE);
+        }
+        buffer->capacity = new_capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+}
+
+static void capture_write(void* context, const char* data, size_t length) {
+    buffer_append((OutputBuffer*)context, data, length);
+}
+
+void reexec_session_init(ReexecSession* session) {
+    memset(session, 0, sizeof(*session));
+}
+
+void reexec_session_run(ReexecSession* session, const IncrementalParser* ip) {
+    ASTNode* program = incremental_parser_program(ip);
+    int count = program ? program->children[0]->num_children : 0;
+    ASTNode** statements = program ? program->children[0]->children : NULL;
+
+    StatementRecord* records = (StatementRecord*)calloc(count > 0 ? count : 1, sizeof(StatementRecord));
+    if (!records) {
+        fprintf(stderr, "Memory allocation failed for statement records.\n");
+        exit(EXIT_FAILURE);
+    }
+    OutputBuffer output = { .data = NULL, .length = 0, .capacity = 0 };
+    OutputSink capture = { .write = capture_write, .context = &output };
+
+    session->last_executed = 0;
+    session->last_replayed = 0;
+    interpreter_reset_environment();
+    input_rewind(); // Every run reads the input from the start
+    output_set_sink(&capture);
+
+    int old = 0;          // Cursor into the previous run's records (reused statements keep their order)
+    bool in_prefix = true; // Still inside the unchanged prefix, where entry state cannot differ
+    for (int i = 0; i < count; ++i) {
+        StatementRecord* record = &records[i];
+        StatementRecord* previous = NULL;
+        record->id = ip->spans[i].id;
+        if (record->id < session->known_ids) {
+            while (old < session->record_count && session->records[old].id != record->id) old++;
+            if (old < session->record_count) previous = &session->records[old];
+        }
+        // A read may see different input than last time, and vector effects are not
+        // recorded, so the prefix ends at either
+        in_prefix = in_prefix && previous && old == i && !previous->access.consumed_input &&
+                    !previous->access.touched_vector;
+
+        record->output_offset = output.length;
+        if (previous && (in_prefix || interpreter_reads_match(&previous->access))) {
+            // Same statement, same inputs: replay its effects and output
+            interpreter_apply_writes(&previous->access);
+            buffer_append(&output, session->output + previous->output_offset, previous->output_length);
+            record->access = previous->access;
+            memset(&previous->access, 0, sizeof(previous->access));
+            session->last_replayed++;
+        } else {
+            interpreter_set_access_log(&record->access);
+            interpret_top_level_statement(statements[i]);
+            interpreter_set_access_log(NULL);
+            session->last_executed++;
+        }
+        record->output_length = output.length - record->output_offset;
+    }
+    output_set_sink(NULL);
+
+    for (int i = 0; i < session->record_count; ++i) {
+        access_log_free(&session->records[i].access);
+    }
+    free(session->records);
+    free(session->output);
+    session->records = records;
+    session->record_count = count;
+    session->record_capacity = count;
+    session->known_ids = ip->next_id;
+    session->output = output.data;
+    session->output_length = output.length;
+    session->output_capacity = output.capacity;
+}
+
+void reexec_session_free(ReexecSession* session) {
+    for (int i = 0; i < session->record_count; ++i) {
+        access_log_free(&session->records[i].access);
+    }
+    free(session->records);
+    free(session->output);
+    memset(session, 0, sizeof(*session));
+}
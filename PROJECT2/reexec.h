@@ -0,0 +1,43 @@
+#ifndef REEXEC_H
+#define REEXEC_H
+
+#include <stddef.h>
+#include "incremental.h"
+#include "interpreter.h"
+
+// What one top-level statement did the last time it ran
+typedef struct {
+    unsigned long id;         // StatementSpan id of the statement
+    AccessLog access;         // Read set with entry state, write set with final values
+    size_t output_offset;     // Its program output within the session's output buffer
+    size_t output_length;
+} StatementRecord;
+
+// Re-executes an incrementally parsed program after edits. Each statement's
+// write set is a checkpoint delta, so the state before any statement can be
+// rebuilt without running what came before it. Statements before the first
+// edited one are never re-run; later unchanged statements are skipped too when
+// every variable they read still has the value it had last time. Statements
+// that read input always run again, against input rewound for every run, and
+// so do statements involving vectors.
+typedef struct {
+    StatementRecord* records;
+    int record_count;
+    int record_capacity;
+    unsigned long known_ids;  // Statement ids below this were present in the previous run
+
+    char* output;             // Complete program output of the last run
+    size_t output_length;
+    size_t output_capacity;
+
+    int last_executed;        // Statements actually run by the last call
+    int last_replayed;        // Statements whose recorded effects were replayed instead
+} ReexecSession;
+
+void reexec_session_init(ReexecSession* session);
+// Brings the session up to date with the parser's current program. Program
+// output is collected in session->output rather than written anywhere.
+void reexec_session_run(ReexecSession* session, const IncrementalParser* ip);
+void reexec_session_free(ReexecSession* session);
+
+#endif // REEXEC_H
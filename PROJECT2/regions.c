@@ -0,0 +1,298 @@
+#include "regions.h"
+#include "interpreter.h"
+#include "output.h"
+#include "metrics.h"
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} RegionBuffer;
+
+typedef struct {
+    ASTNode** statements;
+    RegionBuffer* buffers;     // One per statement of the batch
+} RegionBatch;
+
+// --- Effects Analysis ---
+
+static bool contains_name(const char* const* names, int count, const char* name) {
+    for (int i = 0; i < count; ++i) {
+        if (strcmp(names[i], name) == 0) return true;
+    }
+    return false;
+}
+
+static void add_name(const char*** names, int* count, int* capacity, const char* name) {
+    if (contains_name(*names, *count, name)) return;
+    if (*count >= *capacity) {
+        *capacity = *capacity == 0 ? 8 : *capacity * 2;
+        *names = (const char**)realloc((void*)*names, *capacity * sizeof(const char*));
+        if (!*names) {
+            fprintf(stderr, "Memory allocation failed for statement effects.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    (*names)[(*count)++] = name;
+}
+
+static void add_read(StatementEffects* effects, const char* name) {
+    add_name(&effects->reads, &effects->read_count, &effects->read_capacity, name);
+}
+
+static void add_mutate(StatementEffects* effects, const char* name) {
+    add_name(&effects->mutates, &effects->mutate_count, &effects->mutate_capacity, name);
+}
+
+static const char* value_identifier(const ASTNode* value_node) {
+    if (!value_node || value_node->type != AST_INT_VALUE || value_node->num_children != 1 ||
+        value_node->children[0]->type != AST_IDENTIFIER) {
+        return NULL;
+    }
+    return value_node->children[0]->data.identifier.name;
+}
+
+static void collect_effects(const ASTNode* node, StatementEffects* effects) {
+    if (!node) return;
+    const char* name;
+    switch (node->type) {
+        case AST_DECLARATION:
+            effects->declares = true;
+            if (node->num_children == 1) add_mutate(effects, node->children[0]->data.identifier.name);
+            break;
+        case AST_VECTOR_DECLARATION:
+            effects->declares = true;
+            if (node->num_children != 2) break;
+            add_mutate(effects, node->children[0]->data.identifier.name);
+            if ((name = value_identifier(node->children[1]))) add_read(effects, name);
+            break;
+        case AST_ASSIGNMENT:
+            if (node->num_children != 2) break;
+            add_mutate(effects, node->children[0]->data.identifier.name);
+            if ((name = value_identifier(node->children[1]))) add_read(effects, name);
+            break;
+        case AST_INCREMENT:
+        case AST_DECREMENT:
+            if (node->num_children != 2) break;
+            add_read(effects, node->children[0]->data.identifier.name);
+            add_mutate(effects, node->children[0]->data.identifier.name);
+            if ((name = value_identifier(node->children[1]))) add_read(effects, name);
+            break;
+        case AST_READ_STATEMENT:
+            effects->reads_input = true;
+            if (node->num_children == 1) add_mutate(effects, node->children[0]->data.identifier.name);
+            break;
+        case AST_WRITE_STATEMENT:
+            if (node->num_children != 1) break;
+            for (int i = 0; i < node->children[0]->num_children; ++i) {
+                const ASTNode* element = node->children[0]->children[i];
+                if (element->num_children == 1 && (name = value_identifier(element->children[0]))) {
+                    add_read(effects, name);
+                    add_mutate(effects, name);
+                }
+            }
+            break;
+        case AST_LOOP_STATEMENT:
+            if ((name = value_identifier(node->data.loop.count_expr))) add_read(effects, name);
+            collect_effects(node->data.loop.body, effects);
+            break;
+        case AST_CODE_BLOCK:
+        case AST_STATEMENT_LIST:
+            for (int i = 0; i < node->num_children; ++i) collect_effects(node->children[i], effects);
+            break;
+        default:
+            break;
+    }
+}
+
+void analyze_statement_effects(const ASTNode* statement, StatementEffects* effects) {
+    effects->read_count = 0;
+    effects->mutate_count = 0;
+    effects->declares = false;
+    effects->reads_input = false;
+    collect_effects(statement, effects);
+}
+
+void free_statement_effects(StatementEffects* effects) {
+    free((void*)effects->reads);
+    free((void*)effects->mutates);
+    memset(effects, 0, sizeof(*effects));
+}
+
+// True if running a and b in either order (or at once) could behave differently
+static bool effects_conflict(const StatementEffects* a, const StatementEffects* b) {
+    for (int i = 0; i < a->mutate_count; ++i) {
+        if (contains_name(b->reads, b->read_count, a->mutates[i]) ||
+            contains_name(b->mutates, b->mutate_count, a->mutates[i])) {
+            return true;
+        }
+    }
+    for (int i = 0; i < a->read_count; ++i) {
+        if (contains_name(b->mutates, b->mutate_count, a->reads[i])) return true;
+    }
+    return false;
+}
+
+static void merge_effects(StatementEffects* into, const StatementEffects* from) {
+    for (int i = 0; i < from->read_count; ++i) add_read(into, from->reads[i]);
+    for (int i = 0; i < from->mutate_count; ++i) add_mutate(into, from->mutates[i]);
+}
+
+// --- Runtime Checks ---
+
+// Current value of an <int_value>; false if it names an undeclared variable
+static bool current_value(const ASTNode* value_node, BigInt* out) {
+    if (!value_node || value_node->type != AST_INT_VALUE || value_node->num_children != 1) return false;
+    const ASTNode* child = value_node->children[0];
+    if (child->type == AST_INTEGER_LITERAL) {
+        big_int_copy(out, &child->data.constant->value);
+        return true;
+    }
+    return child->type == AST_IDENTIFIER && interpreter_get_variable(child->data.identifier.name, out);
+}
+
+// Loop counts are the only values that can make a well-formed statement over
+// declared variables report an error, so none may be negative or change while it runs
+static bool loop_counts_safe(const ASTNode* node, const StatementEffects* effects) {
+    if (!node) return true;
+    if (node->type == AST_LOOP_STATEMENT) {
+        BigInt count;
+        const char* name = value_identifier(node->data.loop.count_expr);
+        if (name && contains_name(effects->mutates, effects->mutate_count, name)) return false;
+        if (!current_value(node->data.loop.count_expr, &count) || count.sign == -1) return false;
+        return loop_counts_safe(node->data.loop.body, effects);
+    }
+    if (node->type == AST_CODE_BLOCK || node->type == AST_STATEMENT_LIST) {
+        for (int i = 0; i < node->num_children; ++i) {
+            if (!loop_counts_safe(node->children[i], effects)) return false;
+        }
+    }
+    return true;
+}
+
+// True if the statement cannot print a runtime error, whose place on stderr
+// would otherwise depend on scheduling. Vectors are not variables to
+// interpreter_get_variable, so statements involving one always run alone.
+static bool runs_silently(const ASTNode* statement, const StatementEffects* effects) {
+    for (int i = 0; i < effects->read_count; ++i) {
+        if (!interpreter_get_variable(effects->reads[i], NULL)) return false;
+    }
+    for (int i = 0; i < effects->mutate_count; ++i) {
+        if (!interpreter_get_variable(effects->mutates[i], NULL)) return false;
+    }
+    return loop_counts_safe(statement, effects);
+}
+
+static double magnitude_as_double(const BigInt* num) {
+    double result = 0.0;
+    for (int i = NUM_LIMBS - 1; i >= 0; --i) {
+        result = result * 18446744073709551616.0 + (double)num->limbs[i];
+    }
+    return result;
+}
+
+// Rough number of simple statements executed by running node
+static double estimate_work(const ASTNode* node) {
+    if (!node) return 0.0;
+    if (node->type == AST_LOOP_STATEMENT) {
+        BigInt count;
+        if (!current_value(node->data.loop.count_expr, &count) || count.sign == -1) return 1.0;
+        return 1.0 + magnitude_as_double(&count) * estimate_work(node->data.loop.body);
+    }
+    if (node->type == AST_CODE_BLOCK || node->type == AST_STATEMENT_LIST) {
+        double work = 0.0;
+        for (int i = 0; i < node->num_children; ++i) work += estimate_work(node->children[i]);
+        return work;
+    }
+    return 1.0;
+}
+
+// --- Batch Execution ---
+
+static void region_write(void* context, const char* data, size_t length) {
+    RegionBuffer* buffer = (RegionBuffer*)context;
+    if (length == 0) return;
+    if (buffer->length + length > buffer->capacity) {
+        size_t new_capacity = buffer->capacity == 0 ? 4096 : buffer->capacity;
+        while (new_capacity < buffer->length + length) new_capacity *= 2;
+        buffer->data = (char*)realloc(buffer->data, new_capacity);
+        if (!buffer->data) {
+            fprintf(stderr, "Memory allocation failed for region output buffer.\n");
+            exit(EXIT_FAILURE);
+        }
+        buffer->capacity = new_capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+}
+
+static void run_region(void* context, int task_index) {
+    RegionBatch* batch = (RegionBatch*)context;
+    OutputSink sink = { .write = region_write, .context = &batch->buffers[task_index] };
+    const OutputSink* previous = output_get_sink();
+    output_set_sink(&sink);
+    interpret_top_level_statement(batch->statements[task_index]);
+    output_set_sink(previous);
+    // Worker threads would otherwise keep a partial count past the region
+    if (metrics_segment) metrics_flush();
+}
+
+static void run_batch(ASTNode** statements, int count) {
+    RegionBuffer buffers[REGION_MAX_BATCH];
+    memset(buffers, 0, sizeof(buffers));
+    RegionBatch batch = { .statements = statements, .buffers = buffers };
+    parallel_for(count, run_region, &batch);
+    for (int i = 0; i < count; ++i) {
+        if (buffers[i].length > 0) output_write(buffers[i].data, buffers[i].length);
+        free(buffers[i].data);
+    }
+}
+
+void interpret_statement_regions(ASTNode* statement_list) {
+    ASTNode** statements = statement_list->children;
+    int count = statement_list->num_children;
+    if (parallel_thread_count() == 1) {
+        for (int i = 0; i < count; ++i) interpret_top_level_statement(statements[i]);
+        return;
+    }
+
+    StatementEffects batch_effects, effects;
+    memset(&batch_effects, 0, sizeof(batch_effects));
+    memset(&effects, 0, sizeof(effects));
+
+    int i = 0;
+    while (i < count) {
+        // Gather the longest run of statements independent of each other
+        int end = i;
+        int heavy = 0;
+        batch_effects.read_count = 0;
+        batch_effects.mutate_count = 0;
+        while (end < count && end - i < REGION_MAX_BATCH) {
+            analyze_statement_effects(statements[end], &effects);
+            if (effects.declares || effects.reads_input || effects_conflict(&effects, &batch_effects) ||
+                !runs_silently(statements[end], &effects)) {
+                break;
+            }
+            merge_effects(&batch_effects, &effects);
+            if (estimate_work(statements[end]) >= REGION_MIN_WORK) heavy++;
+            end++;
+        }
+
+        if (end == i) {
+            interpret_top_level_statement(statements[i++]);
+        } else if (heavy >= 2) {
+            run_batch(statements + i, end - i);
+            i = end;
+        } else {
+            // Not worth the buffering; the statement that ended the run starts the next one
+            for (; i < end; ++i) interpret_top_level_statement(statements[i]);
+        }
+    }
+
+    free_statement_effects(&batch_effects);
+    free_statement_effects(&effects);
+}
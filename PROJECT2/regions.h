@@ -0,0 +1,34 @@
+#ifndef REGIONS_H
+#define REGIONS_H
+
+#include "parser.h"
+
+// Estimated statement executions below which a statement is not worth a thread of its own
+#define REGION_MIN_WORK 100000.0
+// Most top-level statements run side by side in one batch
+#define REGION_MAX_BATCH 64
+
+// Variables one top-level statement touches, found from its AST alone
+typedef struct {
+    const char** reads;    // Variables whose value it uses
+    int read_count;
+    int read_capacity;
+    const char** mutates;  // Variables it assigns, updates or writes out (writing fills the decimal cache)
+    int mutate_count;
+    int mutate_capacity;
+    bool declares;         // Contains a declaration (which changes the shape of the environment)
+    bool reads_input;      // Contains a read statement (input is consumed in statement order)
+} StatementEffects;
+
+void analyze_statement_effects(const ASTNode* statement, StatementEffects* effects);
+void free_statement_effects(StatementEffects* effects);
+
+// Executes a top-level statement list. Consecutive statements that touch
+// disjoint variables and cannot report runtime errors are gathered into
+// batches; a batch holding at least two heavy statements runs on the thread
+// pool, each statement writing into its own buffer, and the buffers are
+// emitted in statement order, so output and final state match sequential
+// execution exactly. Only for quiet runs without dependency tracking.
+void interpret_statement_regions(ASTNode* statement_list);
+
+#endif // REGIONS_H
@@ -0,0 +1,192 @@
+#include "repl.h"
+#include "lexer.h"
+#include "interpreter.h"
+#include "units.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h> // For isatty
+
+// Name entries are located in; includes are taken relative to the current directory
+#define REPL_SOURCE_NAME "<repl>"
+
+// Statements collected from one entry; they only run once the whole entry parsed
+typedef struct {
+    ASTNode** statements;
+    int count;
+    int capacity;
+} StatementBuffer;
+
+// Tracks whether the text entered so far forms a complete entry
+typedef struct {
+    int brace_depth;
+    bool in_string;
+    bool in_comment;
+    char last_significant; // Last non-whitespace character outside strings/comments (0 if none)
+} EntryScanState;
+
+static void buffer_statement(ASTNode* statement, void* user_data) {
+    StatementBuffer* buffer = (StatementBuffer*)user_data;
+    if (buffer->count >= buffer->capacity) {
+        buffer->capacity = buffer->capacity == 0 ? 8 : buffer->capacity * 2;
+        buffer->statements = (ASTNode**)realloc(buffer->statements, buffer->capacity * sizeof(ASTNode*));
+        if (!buffer->statements) {
+            fprintf(stderr, "Memory allocation failed for REPL statement buffer.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    buffer->statements[buffer->count++] = statement;
+}
+
+static void scan_entry_text(EntryScanState* state, const char* text, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        if (state->in_comment) {
+            if (c == '*') state->in_comment = false;
+        } else if (state->in_string) {
+            if (c == '"') {
+                state->in_string = false;
+                state->last_significant = c;
+            }
+        } else if (c == '*') {
+            state->in_comment = true;
+        } else if (c == '"') {
+            state->in_string = true;
+            state->last_significant = c;
+        } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            if (c == '{') state->brace_depth++;
+            if (c == '}') state->brace_depth--;
+            state->last_significant = c;
+        }
+    }
+}
+
+// A statement ends with ';' and a block with '}', once every brace is closed
+static bool entry_is_complete(const EntryScanState* state) {
+    return !state->in_string && !state->in_comment && state->brace_depth <= 0 &&
+           (state->last_significant == ';' || state->last_significant == '}');
+}
+
+// Lexes, parses and links one entry, then executes its statements. Tokens are
+// fed straight into the driver, so no token array is built.
+static bool run_entry(LexContext* lex, LRParser* parser, StatementBuffer* buffer, const char* text, size_t length,
+                      UnitParser parse_unit, void* parse_context) {
+    lexer_set_input_string(lex, text, length);
+    buffer->count = 0;
+
+    ParseStatus status = PARSE_STATUS_CONTINUE;
+    while (status == PARSE_STATUS_CONTINUE) {
+        Token token = get_next_token(lex);
+        if (token.type == TOKEN_ERROR) {
+            status = PARSE_STATUS_ERROR; // The lexer has already reported the problem
+            break;
+        }
+        status = lr_parser_feed(parser, &token);
+        if (status == PARSE_STATUS_CONTINUE && token.type == TOKEN_EOF) {
+            fprintf(stderr, "Parser Error: Unexpected end of entry.\n");
+            status = PARSE_STATUS_ERROR;
+        }
+    }
+
+    // The entry's statements, with the files they include spliced in; none run
+    // unless all of them link
+    ASTNode* list = create_ast_node(AST_STATEMENT_LIST, lex->location);
+    for (int i = 0; i < buffer->count; ++i) {
+        add_child_to_ast_node(list, buffer->statements[i]);
+    }
+    buffer->count = 0;
+    if (status == PARSE_STATUS_ACCEPT) {
+        free_ast_node(parser->result); // Statements were detached; only the program shell is left
+        if (units_link_list(list, REPL_SOURCE_NAME, parse_unit, parse_context, NULL)) {
+            for (int i = 0; i < list->num_children; ++i) {
+                interpret_top_level_statement(list->children[i]);
+            }
+        } else {
+            status = PARSE_STATUS_ERROR; // The Link Error is already reported
+        }
+    }
+    free_ast_node(list);
+    lr_parser_reset(parser);
+    return status == PARSE_STATUS_ACCEPT;
+}
+
+bool run_repl(const Grammar* grammar, FILE* input, UnitParser parse_unit, void* parse_context) {
+    bool interactive = isatty(fileno(input)) != 0;
+    bool ok = true;
+
+    LexContext* lex = (LexContext*)malloc(sizeof(LexContext));
+    if (!lex) {
+        fprintf(stderr, "Memory allocation failed for REPL lexer context.\n");
+        return false;
+    }
+    init_lexer(lex, NULL, REPL_SOURCE_NAME);
+    interpreter_set_script_path(REPL_SOURCE_NAME);
+
+    StatementBuffer buffer = { .statements = NULL, .count = 0, .capacity = 0 };
+    LRParser parser;
+    lr_parser_init(&parser, grammar);
+    parser.on_statement = buffer_statement;
+    parser.statement_user_data = &buffer;
+    parser.detach_statements = true;
+
+    interpreter_begin();
+
+    char* line = NULL;
+    size_t line_capacity = 0;
+    ssize_t line_length;
+    char* entry = NULL;
+    size_t entry_length = 0;
+    size_t entry_capacity = 0;
+    EntryScanState scan = {0};
+
+    if (interactive) {
+        printf("> ");
+        fflush(stdout);
+    }
+    while ((line_length = getline(&line, &line_capacity, input)) != -1) {
+        if (entry_length + (size_t)line_length + 1 > entry_capacity) {
+            entry_capacity = (entry_length + (size_t)line_length + 1) * 2;
+            entry = (char*)realloc(entry, entry_capacity);
+            if (!entry) {
+                fprintf(stderr, "Memory allocation failed for REPL entry.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        memcpy(entry + entry_length, line, (size_t)line_length);
+        entry_length += (size_t)line_length;
+        scan_entry_text(&scan, line, (size_t)line_length);
+
+        if (scan.last_significant == 0 && !scan.in_comment) {
+            // Blank line (or a finished comment): nothing to run, but keep line numbers in step
+            for (size_t i = 0; i < entry_length; ++i) {
+                if (entry[i] == '\n') lex->location.line++;
+            }
+            entry_length = 0;
+        } else if (entry_is_complete(&scan)) {
+            ok = run_entry(lex, &parser, &buffer, entry, entry_length, parse_unit, parse_context) && ok;
+            entry_length = 0;
+            memset(&scan, 0, sizeof(scan));
+        }
+
+        if (interactive) {
+            printf(entry_length == 0 ? "> " : "... ");
+            fflush(stdout);
+        }
+    }
+    // Input ended in the middle of an entry: run what we have so the error is reported
+    if (scan.last_significant != 0) {
+        ok = run_entry(lex, &parser, &buffer, entry, entry_length, parse_unit, parse_context) && ok;
+    }
+    if (interactive) printf("\n");
+
+    interpreter_end();
+
+    free(line);
+    free(entry);
+    free(buffer.statements);
+    lr_parser_free(&parser);
+    free_lex_context(lex);
+    free(lex);
+    return ok;
+}
@@ -0,0 +1,17 @@
+#ifndef REPL_H
+#define REPL_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "parser.h"
+#include "units.h"
+
+// Interactive read-eval-print loop. Each complete entry (a statement, or a block
+// once its braces are balanced) is lexed and parsed against the prebuilt tables
+// and executed against a runtime symbol table that persists for the whole session.
+// Includes are linked per entry (units.h) with parse_unit, relative to the current
+// directory. The parsing tables must already be built. Returns false if any entry
+// failed.
+bool run_repl(const Grammar* grammar, FILE* input, UnitParser parse_unit, void* parse_context);
+
+#endif // REPL_H
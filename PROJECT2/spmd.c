@@ -0,0 +1,774 @@
+#include "spmd.h"
+#include "interpreter.h"
+#include "batch_update.h"
+#include "output.h"
+#include "threadpool.h"
+#include "metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+#if SPMD_LANES > BATCH_MAX_LANES || SPMD_LANES > 64
+#error "SPMD lanes must fit one batch_add_small call and a 64-bit lane mask"
+#endif
+
+// --- Binding Table ---
+
+static bool is_integer_text(const char* text) {
+    const char* digits = text[0] == '-' ? text + 1 : text;
+    size_t count = strspn(digits, "0123456789");
+    return count > 0 && count <= MAX_BIGINT_LITERAL_DIGITS && digits[count] == '\0';
+}
+
+bool binding_table_load(const char* path, BindingTable* table) {
+    memset(table, 0, sizeof(*table));
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open bindings file '%s'\n", path);
+        return false;
+    }
+
+    const char* separators = " \t\r\n\v\f,";
+    char* line = NULL;
+    size_t line_capacity = 0;
+    int line_number = 0, row_capacity = 0;
+    bool ok = true;
+    while (ok && getline(&line, &line_capacity, file) >= 0) {
+        line_number++;
+        char* save = NULL;
+        char* token = strtok_r(line, separators, &save);
+        if (!token) continue; // Blank line
+
+        if (!table->names) {
+            int capacity = 8;
+            table->names = (char**)malloc(capacity * sizeof(char*));
+            for (; token; token = strtok_r(NULL, separators, &save)) {
+                if (table->column_count == capacity) {
+                    capacity *= 2;
+                    table->names = (char**)realloc(table->names, capacity * sizeof(char*));
+                }
+                if (!table->names || !(table->names[table->column_count++] = strdup(token))) {
+                    fprintf(stderr, "Memory allocation failed for binding names.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            continue;
+        }
+
+        if (table->row_count == row_capacity) {
+            row_capacity = row_capacity == 0 ? 64 : row_capacity * 2;
+            table->values = (BigInt*)realloc(table->values, (size_t)row_capacity * table->column_count * sizeof(BigInt));
+            if (!table->values) {
+                fprintf(stderr, "Memory allocation failed for binding values.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        BigInt* row = table->values + (size_t)table->row_count * table->column_count;
+        int column = 0;
+        for (; token; token = strtok_r(NULL, separators, &save), ++column) {
+            if (column >= table->column_count) break;
+            if (!is_integer_text(token)) {
+                fprintf(stderr, "Error: Bindings file '%s' line %d: '%s' is not an integer of at most %d digits\n",
+                        path, line_number, token, MAX_BIGINT_LITERAL_DIGITS);
+                ok = false;
+                break;
+            }
+            big_int_from_string(&row[column], token);
+        }
+        if (ok && (column != table->column_count || token)) {
+            fprintf(stderr, "Error: Bindings file '%s' line %d: expected %d values\n", path, line_number,
+                    table->column_count);
+            ok = false;
+        }
+        table->row_count++;
+    }
+    free(line);
+    fclose(file);
+
+    if (ok && !table->names) {
+        fprintf(stderr, "Error: Bindings file '%s' has no header line\n", path);
+        ok = false;
+    }
+    if (!ok) binding_table_free(table);
+    return ok;
+}
+
+void binding_table_free(BindingTable* table) {
+    for (int i = 0; i < table->column_count; ++i) free(table->names[i]);
+    free(table->names);
+    free(table->values);
+    memset(table, 0, sizeof(*table));
+}
+
+// --- Compilation ---
+
+typedef enum {
+    SPMD_OP_DECLARE,
+    SPMD_OP_ASSIGN,
+    SPMD_OP_ADD,         // += (sign 1) or -= (sign -1)
+    SPMD_OP_WRITE_TEXT,  // String, newline or literal: the same text on every lane
+    SPMD_OP_WRITE_VALUE, // A variable's value
+    SPMD_OP_LOOP,        // Evaluates the count; jump is its LOOP_END
+    SPMD_OP_LOOP_END     // jump is its LOOP
+} SpmdOpType;
+
+// An <int_value>: a variable column, or a literal
+typedef struct {
+    int column;              // -1 for a literal
+    const BigInt* literal;
+    bool small;              // The literal is below BATCH_SMALL_LIMIT in magnitude...
+    long long small_value;   // ...and this is its value
+    const ASTNode* node;     // Located for undeclared-variable errors
+} SpmdOperand;
+
+typedef struct {
+    SpmdOpType type;
+    int column;              // Target variable
+    int binding;             // DECLARE: table column with the initial value, or -1
+    int sign;                // ADD
+    SpmdOperand operand;     // ASSIGN, ADD, WRITE_VALUE, LOOP
+    const char* text;        // WRITE_TEXT (owned by the constant pool)
+    size_t length;
+    int jump;                // LOOP / LOOP_END
+    const ASTNode* node;     // The statement, for error locations
+} SpmdOp;
+
+typedef struct {
+    SpmdOp* ops;
+    int op_count;
+    int op_capacity;
+    const char** names;      // Variable of each column (owned by the AST)
+    int variable_count;
+    int variable_capacity;
+} SpmdProgram;
+
+typedef struct {
+    SpmdProgram* program;
+    const BindingTable* table;
+    int* open_loops;         // Op index of every LOOP whose body is being compiled...
+    int* open_depths;        // ...and its depth in the walk
+    int open_count;
+    bool supported;
+} CompileContext;
+
+static int variable_column(SpmdProgram* program, const char* name) {
+    for (int i = 0; i < program->variable_count; ++i) {
+        if (strcmp(program->names[i], name) == 0) return i;
+    }
+    if (program->variable_count == program->variable_capacity) {
+        program->variable_capacity = program->variable_capacity == 0 ? 16 : program->variable_capacity * 2;
+        program->names = (const char**)realloc((void*)program->names, program->variable_capacity * sizeof(const char*));
+        if (!program->names) {
+            fprintf(stderr, "Memory allocation failed for SPMD variables.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    program->names[program->variable_count] = name;
+    return program->variable_count++;
+}
+
+static SpmdOp* append_op(SpmdProgram* program, SpmdOpType type, const ASTNode* node) {
+    if (program->op_count == program->op_capacity) {
+        program->op_capacity = program->op_capacity == 0 ? 64 : program->op_capacity * 2;
+        program->ops = (SpmdOp*)realloc(program->ops, program->op_capacity * sizeof(SpmdOp));
+        if (!program->ops) {
+            fprintf(stderr, "Memory allocation failed for SPMD ops.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    SpmdOp* op = &program->ops[program->op_count++];
+    memset(op, 0, sizeof(*op));
+    op->type = type;
+    op->node = node;
+    op->binding = -1;
+    return op;
+}
+
+// Fits value into out if its magnitude is at most limit (quietly, unlike big_int_to_long_long)
+static bool fits_below(const BigInt* value, unsigned long long limit, long long* out) {
+    for (int i = 1; i < NUM_LIMBS; ++i) {
+        if (value->limbs[i] != 0) return false;
+    }
+    if (value->limbs[0] > limit || (value->sign == -1 && value->limbs[0] == 0)) return false;
+    *out = value->sign == -1 ? -(long long)value->limbs[0] : (long long)value->limbs[0];
+    return true;
+}
+
+static bool is_small(const BigInt* value, long long* out) {
+    return fits_below(value, BATCH_SMALL_LIMIT - 1, out);
+}
+
+static bool compile_operand(SpmdProgram* program, const ASTNode* value_node, SpmdOperand* operand) {
+    if (!value_node || value_node->type != AST_INT_VALUE || value_node->num_children != 1) return false;
+    const ASTNode* child = value_node->children[0];
+    operand->node = value_node;
+    if (child->type == AST_IDENTIFIER) {
+        operand->column = variable_column(program, child->data.identifier.name);
+        return true;
+    }
+    if (child->type != AST_INTEGER_LITERAL) return false;
+    const BigInt* value = &child->data.constant->value;
+    operand->column = -1;
+    operand->literal = value;
+    long long small;
+    operand->small = is_small(value, &small);
+    operand->small_value = operand->small ? small : 0;
+    return true;
+}
+
+// Emits the LOOP_END of every loop whose body ends before a statement at depth
+static void close_loops(CompileContext* ctx, int depth) {
+    while (ctx->open_count > 0 && ctx->open_depths[ctx->open_count - 1] >= depth) {
+        int loop = ctx->open_loops[--ctx->open_count];
+        SpmdOp* end = append_op(ctx->program, SPMD_OP_LOOP_END, ctx->program->ops[loop].node);
+        end->jump = loop;
+        ctx->program->ops[loop].jump = ctx->program->op_count - 1;
+    }
+}
+
+// Statements arrive in execution order (pre-order), a loop's body right after it
+static void compile_visit(ASTNode* node, int depth, void* context) {
+    CompileContext* ctx = (CompileContext*)context;
+    SpmdProgram* program = ctx->program;
+    SpmdOp* op;
+    switch (node->type) {
+        case AST_DECLARATION:
+        case AST_ASSIGNMENT:
+        case AST_INCREMENT:
+        case AST_DECREMENT:
+        case AST_WRITE_STATEMENT:
+        case AST_LOOP_STATEMENT:
+            close_loops(ctx, depth);
+            break;
+        case AST_READ_STATEMENT:
+            ctx->supported = false; // Input is consumed in row order, so each row must run whole
+            return;
+        case AST_VECTOR_DECLARATION:
+            ctx->supported = false; // Lanes hold numbers only
+            break;
+        default:
+            return;
+    }
+    if (!ctx->supported) {
+        // The rows run whole, but declared names still count as used by the bindings
+        if (node->type == AST_DECLARATION || node->type == AST_VECTOR_DECLARATION) {
+            variable_column(program, node->children[0]->data.identifier.name);
+        }
+        return;
+    }
+
+    switch (node->type) {
+        case AST_DECLARATION: {
+            op = append_op(program, SPMD_OP_DECLARE, node);
+            const char* name = node->children[0]->data.identifier.name;
+            op->column = variable_column(program, name);
+            for (int i = 0; i < ctx->table->column_count; ++i) {
+                if (strcmp(ctx->table->names[i], name) == 0) op->binding = i;
+            }
+            break;
+        }
+        case AST_ASSIGNMENT:
+        case AST_INCREMENT:
+        case AST_DECREMENT:
+            op = append_op(program, node->type == AST_ASSIGNMENT ? SPMD_OP_ASSIGN : SPMD_OP_ADD, node);
+            op->column = variable_column(program, node->children[0]->data.identifier.name);
+            op->sign = node->type == AST_DECREMENT ? -1 : 1;
+            if (!compile_operand(program, node->children[1], &op->operand)) ctx->supported = false;
+            break;
+        case AST_WRITE_STATEMENT: {
+            const ASTNode* output_list = node->children[0];
+            for (int i = 0; i < output_list->num_children; ++i) {
+                const ASTNode* content = output_list->children[i]->children[0];
+                if (content->type == AST_STRING_LITERAL) {
+                    op = append_op(program, SPMD_OP_WRITE_TEXT, node);
+                    op->text = content->data.constant->text;
+                    op->length = content->data.constant->length;
+                } else if (content->type == AST_NEWLINE) {
+                    op = append_op(program, SPMD_OP_WRITE_TEXT, node);
+                    op->text = "\n";
+                    op->length = 1;
+                } else if (content->num_children == 1 && content->children[0]->type == AST_INTEGER_LITERAL) {
+                    op = append_op(program, SPMD_OP_WRITE_TEXT, node);
+                    op->text = content->children[0]->data.constant->text;
+                    op->length = content->children[0]->data.constant->length;
+                } else {
+                    op = append_op(program, SPMD_OP_WRITE_VALUE, node);
+                    if (!compile_operand(program, content, &op->operand)) ctx->supported = false;
+                }
+            }
+            break;
+        }
+        case AST_LOOP_STATEMENT: {
+            op = append_op(program, SPMD_OP_LOOP, node);
+            if (!compile_operand(program, node->data.loop.count_expr, &op->operand)) ctx->supported = false;
+            ctx->open_loops = (int*)realloc(ctx->open_loops, (ctx->open_count + 1) * sizeof(int));
+            ctx->open_depths = (int*)realloc(ctx->open_depths, (ctx->open_count + 1) * sizeof(int));
+            if (!ctx->open_loops || !ctx->open_depths) {
+                fprintf(stderr, "Memory allocation failed for SPMD loops.\n");
+                exit(EXIT_FAILURE);
+            }
+            ctx->open_loops[ctx->open_count] = program->op_count - 1;
+            ctx->open_depths[ctx->open_count++] = depth;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static bool compile_program(ASTNode* root, const BindingTable* table, SpmdProgram* program) {
+    memset(program, 0, sizeof(*program));
+    CompileContext ctx = { .program = program, .table = table, .supported = true };
+    ast_walk(root, true, compile_visit, &ctx);
+    close_loops(&ctx, 0);
+    free(ctx.open_loops);
+    free(ctx.open_depths);
+    return ctx.supported;
+}
+
+static void free_program(SpmdProgram* program) {
+    free(program->ops);
+    free((void*)program->names);
+}
+
+// --- Lane Execution ---
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} LaneBuffer;
+
+// One variable across the lanes of a batch
+typedef struct {
+    long long small[SPMD_LANES]; // Values of lanes not spilled, below BATCH_SMALL_LIMIT in magnitude
+    BigInt* big;                 // SPMD_LANES values, allocated on the first spill
+    uint64_t declared;           // Lanes where the variable exists
+    uint64_t spilled;            // Lanes whose value lives in big
+} LaneColumn;
+
+// An open loop: which lanes reached it and how many iterations each has left
+typedef struct {
+    uint64_t outer_mask;
+    long long remaining[SPMD_LANES];
+} LaneLoop;
+
+typedef struct {
+    const SpmdProgram* program;
+    const BindingTable* table;
+    int first_row;
+    int lane_count;
+    LaneColumn* columns;
+    LaneLoop* loops;
+    int loop_count;
+    int loop_capacity;
+    unsigned long long steps;    // Estimated statement executions so far
+    bool bailed;                 // Over budget: the rows must be run by the regular interpreter
+    LaneBuffer out[SPMD_LANES];  // Program output of each row
+    LaneBuffer err[SPMD_LANES];  // Runtime errors of each row
+} LaneBatch;
+
+#define FOR_EACH_LANE(lane, mask) \
+    for (uint64_t lane##_bits = (mask); lane##_bits; lane##_bits &= lane##_bits - 1) \
+        for (int lane = __builtin_ctzll(lane##_bits), lane##_once = 1; lane##_once; lane##_once = 0)
+
+static void buffer_append(LaneBuffer* buffer, const char* data, size_t length) {
+    if (buffer->length + length > buffer->capacity) {
+        size_t new_capacity = buffer->capacity == 0 ? 256 : buffer->capacity;
+        while (new_capacity < buffer->length + length) new_capacity *= 2;
+        buffer->data = (char*)realloc(buffer->data, new_capacity);
+        if (!buffer->data) {
+            fprintf(stderr, "Memory allocation failed for SPMD output buffer.\n");
+            exit(EXIT_FAILURE);
+        }
+        buffer->capacity = new_capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+}
+
+// Appends the same runtime error about a variable to every lane of mask
+static void report(LaneBatch* batch, uint64_t mask, const char* format, const char* name, const ASTNode* node) {
+    if (!mask) return;
+    char message[512];
+    int length = snprintf(message, sizeof(message), format, name, node->location.line, node->location.column,
+                          runtime_error_unit(node));
+    if (length >= (int)sizeof(message)) length = sizeof(message) - 1;
+    FOR_EACH_LANE(lane, mask) buffer_append(&batch->err[lane], message, (size_t)length);
+}
+
+static BigInt* column_big(LaneColumn* column) {
+    if (!column->big) {
+        column->big = (BigInt*)malloc(SPMD_LANES * sizeof(BigInt));
+        if (!column->big) {
+            fprintf(stderr, "Memory allocation failed for SPMD spill values.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return column->big;
+}
+
+static void store_big(LaneColumn* column, int lane, const BigInt* value) {
+    big_int_copy(&column_big(column)[lane], value);
+    column->spilled |= 1ULL << lane;
+}
+
+static void load_big(const LaneColumn* column, int lane, BigInt* out) {
+    if ((column->spilled >> lane) & 1) {
+        big_int_copy(out, &column->big[lane]);
+    } else {
+        big_int_from_long_long(out, column->small[lane]);
+    }
+}
+
+// Evaluates an operand on the lanes of mask, as evaluate_big_int_value would:
+// undeclared variables are reported and read as 0. Small values go to small[];
+// returns the lanes that have one (the others hold a BigInt, see operand_big).
+static uint64_t load_operand(LaneBatch* batch, const SpmdOperand* operand, uint64_t mask, long long* small) {
+    if (operand->column < 0) {
+        if (!operand->small) return 0;
+        FOR_EACH_LANE(lane, mask) small[lane] = operand->small_value;
+        return mask;
+    }
+    const LaneColumn* column = &batch->columns[operand->column];
+    uint64_t undeclared = mask & ~column->declared;
+    report(batch, undeclared, "Runtime Error: Undeclared variable '%s' used in expression at line %d, column %d%s.\n",
+           batch->program->names[operand->column], operand->node);
+    FOR_EACH_LANE(lane, mask) small[lane] = (undeclared >> lane) & 1 ? 0 : column->small[lane];
+    return mask & ~(column->declared & column->spilled);
+}
+
+static void operand_big(const LaneBatch* batch, const SpmdOperand* operand, int lane, BigInt* out) {
+    if (operand->column < 0) {
+        big_int_copy(out, operand->literal);
+    } else {
+        load_big(&batch->columns[operand->column], lane, out);
+    }
+}
+
+static void run_declare(LaneBatch* batch, const SpmdOp* op, uint64_t mask) {
+    LaneColumn* column = &batch->columns[op->column];
+    report(batch, mask & column->declared, "Runtime Error: Variable '%s' already declared at line %d, column %d%s.\n",
+           batch->program->names[op->column], op->node);
+    uint64_t fresh = mask & ~column->declared;
+    column->declared |= fresh;
+    column->spilled &= ~fresh;
+    FOR_EACH_LANE(lane, fresh) {
+        column->small[lane] = 0;
+        if (op->binding < 0) continue;
+        const BigInt* value = &batch->table->values[(size_t)(batch->first_row + lane) * batch->table->column_count + op->binding];
+        long long small;
+        if (is_small(value, &small)) {
+            column->small[lane] = small;
+        } else {
+            store_big(column, lane, value);
+        }
+    }
+}
+
+static void run_assign(LaneBatch* batch, const SpmdOp* op, uint64_t mask) {
+    long long values[SPMD_LANES];
+    uint64_t small = load_operand(batch, &op->operand, mask, values);
+    LaneColumn* column = &batch->columns[op->column];
+    report(batch, mask & ~column->declared, "Runtime Error: Undeclared variable '%s' in assignment at line %d, column %d%s.\n",
+           batch->program->names[op->column], op->node);
+    uint64_t live = mask & column->declared;
+    FOR_EACH_LANE(lane, live & small) column->small[lane] = values[lane];
+    column->spilled &= ~(live & small);
+    FOR_EACH_LANE(lane, live & ~small) {
+        BigInt value;
+        operand_big(batch, &op->operand, lane, &value);
+        store_big(column, lane, &value);
+    }
+}
+
+static void run_add(LaneBatch* batch, const SpmdOp* op, uint64_t mask) {
+    long long values[SPMD_LANES];
+    uint64_t small = load_operand(batch, &op->operand, mask, values);
+    LaneColumn* column = &batch->columns[op->column];
+    report(batch, mask & ~column->declared,
+           op->sign > 0 ? "Runtime Error: Undeclared variable '%s' in increment at line %d, column %d%s.\n"
+                        : "Runtime Error: Undeclared variable '%s' in decrement at line %d, column %d%s.\n",
+           batch->program->names[op->column], op->node);
+    uint64_t live = mask & column->declared;
+
+    // Both sides small: one vector add over all lanes, the others adding 0.
+    // Sums stay exact in 64 bits; lanes that leave the small range spill.
+    uint64_t fast = live & small & ~column->spilled;
+    if (fast) {
+        long long deltas[SPMD_LANES];
+        for (int lane = 0; lane < SPMD_LANES; ++lane) {
+            deltas[lane] = (fast >> lane) & 1 ? op->sign * values[lane] : 0;
+        }
+        uint64_t outside = batch_add_small(column->small, deltas, SPMD_LANES) & fast;
+        FOR_EACH_LANE(lane, outside) {
+            BigInt value;
+            big_int_from_long_long(&value, column->small[lane]);
+            store_big(column, lane, &value);
+        }
+    }
+    FOR_EACH_LANE(lane, live & ~fast) {
+        BigInt value, amount;
+        load_big(column, lane, &value);
+        if ((small >> lane) & 1) {
+            big_int_from_long_long(&amount, values[lane]);
+        } else {
+            operand_big(batch, &op->operand, lane, &amount);
+        }
+        if (op->sign > 0) {
+            big_int_add(&value, &value, &amount);
+        } else {
+            big_int_sub(&value, &value, &amount);
+        }
+        store_big(column, lane, &value);
+    }
+}
+
+static void run_write_value(LaneBatch* batch, const SpmdOp* op, uint64_t mask) {
+    long long values[SPMD_LANES];
+    uint64_t small = load_operand(batch, &op->operand, mask, values);
+    char text[MAX_BIGINT_STRING_LEN + 2];
+    FOR_EACH_LANE(lane, mask) {
+        if ((small >> lane) & 1) {
+            // Right-aligned digits of a value below 2^61
+            char* end = text + sizeof(text);
+            char* p = end;
+            unsigned long long magnitude = values[lane] < 0 ? 0ULL - (unsigned long long)values[lane] : (unsigned long long)values[lane];
+            do {
+                *--p = (char)('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude);
+            if (values[lane] < 0) *--p = '-';
+            buffer_append(&batch->out[lane], p, (size_t)(end - p));
+        } else {
+            BigInt value;
+            operand_big(batch, &op->operand, lane, &value);
+            big_int_to_string(&value, text);
+            buffer_append(&batch->out[lane], text, strlen(text));
+        }
+    }
+}
+
+// Starts a loop on the lanes of mask; returns the lanes that run its body
+// (0 if none, or if the batch went over budget)
+static uint64_t run_loop(LaneBatch* batch, int pc, uint64_t mask) {
+    const SpmdOp* op = &batch->program->ops[pc];
+    long long values[SPMD_LANES];
+    uint64_t small = load_operand(batch, &op->operand, mask, values);
+
+    if (batch->loop_count == batch->loop_capacity) {
+        batch->loop_capacity = batch->loop_capacity == 0 ? 8 : batch->loop_capacity * 2;
+        batch->loops = (LaneLoop*)realloc(batch->loops, batch->loop_capacity * sizeof(LaneLoop));
+        if (!batch->loops) {
+            fprintf(stderr, "Memory allocation failed for SPMD loops.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    LaneLoop* loop = &batch->loops[batch->loop_count];
+    memset(loop->remaining, 0, sizeof(loop->remaining));
+    loop->outer_mask = mask;
+
+    uint64_t negative = 0;
+    long long most = 0;
+    FOR_EACH_LANE(lane, mask) {
+        if ((small >> lane) & 1) {
+            if (values[lane] < 0) negative |= 1ULL << lane;
+            else loop->remaining[lane] = values[lane];
+        } else {
+            BigInt count;
+            long long value;
+            operand_big(batch, &op->operand, lane, &count);
+            if (count.sign == -1) {
+                negative |= 1ULL << lane;
+            } else if (!fits_below(&count, LLONG_MAX, &value)) {
+                batch->bailed = true; // Far too many iterations to step through
+                return 0;
+            } else {
+                loop->remaining[lane] = value;
+            }
+        }
+        if (loop->remaining[lane] > most) most = loop->remaining[lane];
+    }
+    if (negative) {
+        char message[512];
+        int length = snprintf(message, sizeof(message), "Runtime Error: Loop count cannot be negative at line %d, column %d%s. Skipping loop.\n",
+                              op->node->location.line, op->node->location.column, runtime_error_unit(op->node));
+        if (length >= (int)sizeof(message)) length = sizeof(message) - 1;
+        FOR_EACH_LANE(lane, negative) buffer_append(&batch->err[lane], message, (size_t)length);
+    }
+
+    // Every op of the body, nested loops' included, on every iteration: an upper bound
+    unsigned long long body_ops = (unsigned long long)(op->jump - pc);
+    if ((unsigned long long)most > SPMD_MAX_BATCH_STEPS ||
+        batch->steps + (unsigned long long)most * body_ops > SPMD_MAX_BATCH_STEPS) {
+        batch->bailed = true;
+        return 0;
+    }
+    batch->steps += (unsigned long long)most * body_ops;
+
+    uint64_t running = 0;
+    FOR_EACH_LANE(lane, mask) {
+        if (loop->remaining[lane] > 0) {
+            loop->remaining[lane]--;
+            running |= 1ULL << lane;
+        }
+    }
+    if (running) batch->loop_count++;
+    return running;
+}
+
+static void run_batch_lanes(LaneBatch* batch) {
+    const SpmdProgram* program = batch->program;
+    uint64_t mask = batch->lane_count == 64 ? ~0ULL : (1ULL << batch->lane_count) - 1;
+    int pc = 0;
+    uint64_t executed = 0; // Statements run, one per lane of each op
+    while (pc < program->op_count && !batch->bailed) {
+        const SpmdOp* op = &program->ops[pc];
+        if (op->type != SPMD_OP_LOOP_END) executed += (uint64_t)__builtin_popcountll(mask);
+        switch (op->type) {
+            case SPMD_OP_DECLARE:
+                run_declare(batch, op, mask);
+                break;
+            case SPMD_OP_ASSIGN:
+                run_assign(batch, op, mask);
+                break;
+            case SPMD_OP_ADD:
+                run_add(batch, op, mask);
+                break;
+            case SPMD_OP_WRITE_TEXT:
+                FOR_EACH_LANE(lane, mask) buffer_append(&batch->out[lane], op->text, op->length);
+                break;
+            case SPMD_OP_WRITE_VALUE:
+                run_write_value(batch, op, mask);
+                break;
+            case SPMD_OP_LOOP: {
+                uint64_t running = run_loop(batch, pc, mask);
+                if (!running) {
+                    pc = op->jump + 1;
+                    continue;
+                }
+                mask = running;
+                break;
+            }
+            case SPMD_OP_LOOP_END: {
+                LaneLoop* loop = &batch->loops[batch->loop_count - 1];
+                uint64_t running = 0;
+                FOR_EACH_LANE(lane, loop->outer_mask) {
+                    if (loop->remaining[lane] > 0) {
+                        loop->remaining[lane]--;
+                        running |= 1ULL << lane;
+                    }
+                }
+                if (running) {
+                    mask = running;
+                    pc = op->jump + 1;
+                    continue;
+                }
+                mask = loop->outer_mask;
+                batch->loop_count--;
+                break;
+            }
+        }
+        pc++;
+    }
+    if (metrics_segment) metrics_add_statements(executed);
+}
+
+// --- Driver ---
+
+typedef struct {
+    const SpmdProgram* program;
+    const BindingTable* table;
+    LaneBatch* batches;
+    int first_batch;          // Index of batches[0] among all batches of the table
+} SpmdWave;
+
+static void run_batch_task(void* context, int task_index) {
+    SpmdWave* wave = (SpmdWave*)context;
+    LaneBatch* batch = &wave->batches[task_index];
+    memset(batch, 0, sizeof(*batch));
+    batch->program = wave->program;
+    batch->table = wave->table;
+    batch->first_row = (wave->first_batch + task_index) * SPMD_LANES;
+    batch->lane_count = wave->table->row_count - batch->first_row;
+    if (batch->lane_count > SPMD_LANES) batch->lane_count = SPMD_LANES;
+    batch->columns = (LaneColumn*)calloc(wave->program->variable_count > 0 ? wave->program->variable_count : 1,
+                                         sizeof(LaneColumn));
+    if (!batch->columns) {
+        fprintf(stderr, "Memory allocation failed for SPMD columns.\n");
+        exit(EXIT_FAILURE);
+    }
+    run_batch_lanes(batch);
+    for (int i = 0; i < wave->program->variable_count; ++i) free(batch->columns[i].big);
+    free(batch->columns);
+    free(batch->loops);
+    if (metrics_segment) metrics_flush(); // Counted on a worker thread
+}
+
+static void write_row_header(int row) {
+    char header[64];
+    int length = snprintf(header, sizeof(header), "--- Row %d ---\n", row + 1);
+    output_write(header, (size_t)length);
+}
+
+// Runs one row with the regular interpreter
+static void run_row(ASTNode* program, const BindingTable* table, int row) {
+    write_row_header(row);
+    fflush(stdout);
+    interpreter_set_bindings(table->names, table->values + (size_t)row * table->column_count, table->column_count);
+    interpret_program(program);
+    interpreter_set_bindings(NULL, NULL, 0);
+}
+
+void run_spmd(ASTNode* program, const BindingTable* table) {
+    SpmdProgram compiled;
+    bool lanes = compile_program(program, table, &compiled);
+    for (int i = 0; i < table->column_count; ++i) {
+        bool declared = false;
+        for (int v = 0; v < compiled.variable_count && !declared; ++v) {
+            declared = strcmp(compiled.names[v], table->names[i]) == 0;
+        }
+        if (!declared) fprintf(stderr, "Warning: Bound variable '%s' is not used by the program\n", table->names[i]);
+    }
+    if (!lanes) {
+        for (int row = 0; row < table->row_count; ++row) run_row(program, table, row);
+        free_program(&compiled);
+        return;
+    }
+
+    // Waves of one batch per thread, emitted in row order
+    int batch_count = (table->row_count + SPMD_LANES - 1) / SPMD_LANES;
+    int wave_size = parallel_thread_count();
+    LaneBatch* batches = (LaneBatch*)malloc(wave_size * sizeof(LaneBatch));
+    if (!batches) {
+        fprintf(stderr, "Memory allocation failed for SPMD batches.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int first = 0; first < batch_count; first += wave_size) {
+        int count = batch_count - first < wave_size ? batch_count - first : wave_size;
+        SpmdWave wave = { .program = &compiled, .table = table, .batches = batches, .first_batch = first };
+        parallel_for(count, run_batch_task, &wave);
+
+        for (int b = 0; b < count; ++b) {
+            LaneBatch* batch = &batches[b];
+            for (int lane = 0; lane < batch->lane_count; ++lane) {
+                if (batch->bailed) {
+                    run_row(program, table, batch->first_row + lane);
+                } else {
+                    write_row_header(batch->first_row + lane);
+                    output_write(batch->out[lane].data, batch->out[lane].length);
+                    if (batch->err[lane].length > 0) {
+                        fflush(stdout);
+                        fwrite(batch->err[lane].data, 1, batch->err[lane].length, stderr);
+                    }
+                }
+                free(batch->out[lane].data);
+                free(batch->err[lane].data);
+            }
+        }
+    }
+    free(batches);
+    free_program(&compiled);
+}
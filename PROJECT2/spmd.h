@@ -0,0 +1,38 @@
+#ifndef SPMD_H
+#define SPMD_H
+
+#include <stdbool.h>
+#include "parser.h"
+#include "bigint.h"
+
+// Rows executed side by side as the lanes of one batch
+#define SPMD_LANES 64
+// Statement executions a batch may spend before its rows are handed to the
+// regular interpreter instead, whose loop solvers skip what lanes must iterate
+#define SPMD_MAX_BATCH_STEPS (1ULL << 24)
+
+// Initial values for --bindings: a header line naming variables, then one row
+// of integers per run, separated by whitespace or commas
+typedef struct {
+    char** names;
+    int column_count;
+    BigInt* values;  // row_count * column_count, row by row
+    int row_count;
+} BindingTable;
+
+// Reads a table; reports the first problem and returns false
+bool binding_table_load(const char* path, BindingTable* table);
+void binding_table_free(BindingTable* table);
+
+// Runs the program once per row, each declaration of a bound variable taking
+// the row's value instead of 0 (for a vector, every element does). Output
+// comes per row, under a "--- Row N ---" line. The program is compiled once
+// into a flat op list run by a lane interpreter: each variable is a column of
+// SPMD_LANES small integers (kept below BATCH_SMALL_LIMIT, spilling to BigInt
+// per lane), so dispatch and loop bookkeeping are paid once per batch of rows.
+// Batches run on the thread pool. Programs with read statements or vectors,
+// and batches over their step budget, run row by row through the regular
+// interpreter, with identical results.
+void run_spmd(ASTNode* program, const BindingTable* table);
+
+#endif // SPMD_H
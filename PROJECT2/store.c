@@ -0,0 +1,394 @@
+#include "store.h"
+#include "digest.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char* store_path = NULL;
+static int store_fd = -1;
+static unsigned char* store_map = NULL;
+static size_t store_map_size = 0;
+
+// The region loaded at open, which the next commit must not overwrite
+static StoreHeader active;
+static int active_slot = -1; // Header block holding it; -1 while the store is empty
+static const StoreEntry* entries = NULL;
+static uint64_t entry_count = 0;
+
+// Open-addressing index from names to entries (-1 = empty slot)
+static int64_t* index_slots = NULL;
+static size_t index_capacity = 0;
+
+// FNV-1a, as the runtime symbol index hashes names
+static unsigned int hash_name(const char* name) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; ++p) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+static uint64_t checksum(const void* data, size_t length) {
+    Digest digest;
+    digest_init(&digest);
+    digest_update(&digest, data, length);
+    return digest_value(&digest);
+}
+
+static uint64_t header_checksum(const StoreHeader* header) {
+    return checksum(header, offsetof(StoreHeader, header_checksum));
+}
+
+static const char* entry_name(const StoreEntry* entry) {
+    return (const char*)store_map + active.data_offset + entry->name_offset;
+}
+
+static const BigInt* entry_values(const StoreEntry* entry) {
+    return (const BigInt*)(store_map + active.data_offset + entry->value_offset);
+}
+
+static bool block_is_zero(const unsigned char* block) {
+    for (size_t i = 0; i < STORE_HEADER_SIZE; ++i) {
+        if (block[i]) return false;
+    }
+    return true;
+}
+
+// True if the header and the region it names are intact and readable by this build
+static bool header_valid(const StoreHeader* header) {
+    if (memcmp(header->magic, STORE_MAGIC, sizeof(header->magic)) != 0) return false;
+    if (header->header_checksum != header_checksum(header)) return false;
+    if (header->bigint_size != sizeof(BigInt)) return false;
+    if (header->data_offset < STORE_DATA_START || header->data_offset % 8 != 0 || header->data_offset > store_map_size ||
+        header->data_length > store_map_size - header->data_offset) {
+        return false;
+    }
+    const unsigned char* region = store_map + header->data_offset;
+    if (checksum(region, header->data_length) != header->data_checksum) return false;
+
+    // The checksum matched, so the entries are as written; still check they stay in the region
+    if (header->entry_count > header->data_length / sizeof(StoreEntry)) return false;
+    const StoreEntry* list = (const StoreEntry*)region;
+    for (uint64_t i = 0; i < header->entry_count; ++i) {
+        const StoreEntry* entry = &list[i];
+        if (entry->name_offset > header->data_length ||
+            entry->name_length >= header->data_length - entry->name_offset ||
+            region[entry->name_offset + entry->name_length] != '\0') {
+            return false;
+        }
+        if (entry->value_offset % 8 != 0 || entry->value_offset > header->data_length ||
+            entry->length > (header->data_length - entry->value_offset) / sizeof(BigInt) ||
+            (!entry->is_vector && entry->length != 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void build_index(void) {
+    index_capacity = 16;
+    while (index_capacity < entry_count * 2) index_capacity *= 2;
+    index_slots = (int64_t*)malloc(index_capacity * sizeof(int64_t));
+    if (!index_slots) {
+        fprintf(stderr, "Memory allocation failed for store index.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < index_capacity; ++i) index_slots[i] = -1;
+    size_t mask = index_capacity - 1;
+    for (uint64_t i = 0; i < entry_count; ++i) {
+        size_t slot = hash_name(entry_name(&entries[i])) & mask;
+        while (index_slots[slot] >= 0) slot = (slot + 1) & mask;
+        index_slots[slot] = (int64_t)i;
+    }
+}
+
+static const StoreEntry* find_entry(const char* name) {
+    if (!index_slots) return NULL;
+    size_t mask = index_capacity - 1;
+    for (size_t slot = hash_name(name) & mask; index_slots[slot] >= 0; slot = (slot + 1) & mask) {
+        const StoreEntry* entry = &entries[index_slots[slot]];
+        if (strcmp(entry_name(entry), name) == 0) return entry;
+    }
+    return NULL;
+}
+
+// Maps the whole file as it is now
+static bool map_file(void) {
+    struct stat info;
+    if (fstat(store_fd, &info) != 0) return false;
+    store_map_size = (size_t)info.st_size;
+    if (store_map_size == 0) {
+        store_map = NULL;
+        return true;
+    }
+    void* map = mmap(NULL, store_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, store_fd, 0);
+    if (map == MAP_FAILED) return false;
+    store_map = (unsigned char*)map;
+    return true;
+}
+
+static void unmap_file(void) {
+    if (store_map) munmap(store_map, store_map_size);
+    store_map = NULL;
+    store_map_size = 0;
+}
+
+bool store_open(const char* path) {
+    store_fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (store_fd < 0) {
+        fprintf(stderr, "Error: Could not open store '%s': %s\n", path, strerror(errno));
+        return false;
+    }
+    // Two runs committing to one file would each drop the other's changes
+    if (flock(store_fd, LOCK_EX | LOCK_NB) != 0) {
+        fprintf(stderr, "Error: Store '%s' is in use by another run\n", path);
+        close(store_fd);
+        store_fd = -1;
+        return false;
+    }
+    store_path = path;
+    if (!map_file()) {
+        fprintf(stderr, "Error: Could not map store '%s': %s\n", path, strerror(errno));
+        store_close();
+        return false;
+    }
+
+    const StoreHeader* candidates[2] = { NULL, NULL };
+    bool looks_like_store = store_map_size == 0;
+    if (store_map_size >= STORE_DATA_START) {
+        for (int slot = 0; slot < 2; ++slot) {
+            const StoreHeader* header = (const StoreHeader*)(store_map + slot * STORE_HEADER_SIZE);
+            if (memcmp(header->magic, STORE_MAGIC, sizeof(header->magic)) == 0) looks_like_store = true;
+            if (header_valid(header)) candidates[slot] = header;
+        }
+        // A first commit interrupted before its header leaves both blocks zero
+        looks_like_store = looks_like_store || (block_is_zero(store_map) &&
+                                                block_is_zero(store_map + STORE_HEADER_SIZE));
+    }
+    if (!looks_like_store) {
+        // Committing would overwrite whatever the file is
+        fprintf(stderr, "Error: '%s' is not a store file\n", path);
+        store_close();
+        return false;
+    }
+
+    if (candidates[0] && (!candidates[1] || candidates[0]->generation > candidates[1]->generation)) {
+        active_slot = 0;
+    } else if (candidates[1]) {
+        active_slot = 1;
+    } else if (store_map_size >= STORE_DATA_START && !(block_is_zero(store_map) &&
+                                                       block_is_zero(store_map + STORE_HEADER_SIZE))) {
+        fprintf(stderr, "Error: Store '%s' is damaged (neither header describes an intact commit)\n", path);
+        store_close();
+        return false;
+    }
+
+    if (active_slot >= 0) {
+        active = *candidates[active_slot];
+        entries = (const StoreEntry*)(store_map + active.data_offset);
+        entry_count = active.entry_count;
+        build_index();
+    } else {
+        memset(&active, 0, sizeof(active));
+    }
+    return true;
+}
+
+bool store_is_open(void) {
+    return store_fd >= 0;
+}
+
+const BigInt* store_number(const char* name) {
+    const StoreEntry* entry = find_entry(name);
+    if (!entry) return NULL;
+    if (entry->is_vector) {
+        fprintf(stderr, "Warning: '%s' is stored as a vector; the number declared now starts at 0.\n", name);
+        return NULL;
+    }
+    return entry_values(entry);
+}
+
+const BigInt* store_vector(const char* name, size_t length) {
+    const StoreEntry* entry = find_entry(name);
+    if (!entry) return NULL;
+    if (!entry->is_vector || entry->length != length) {
+        fprintf(stderr, "Warning: '%s' is stored as %s %llu; the vector declared now starts at 0.\n", name,
+                entry->is_vector ? "a vector of length" : "a number, not a vector of length",
+                entry->is_vector ? (unsigned long long)entry->length : (unsigned long long)length);
+        return NULL;
+    }
+    return entry_values(entry);
+}
+
+static uint64_t align8(uint64_t value) {
+    return (value + 7) & ~(uint64_t)7;
+}
+
+// Flushes file[offset, offset + length) to disk (msync wants a page-aligned start)
+static bool sync_range(uint64_t offset, uint64_t length) {
+    if (length == 0) return true;
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t start = offset / page * page;
+    return msync(store_map + start, offset + length - start, MS_SYNC) == 0;
+}
+
+// Appends one entry and its values (count BigInts, or small ones if wide is NULL)
+typedef struct {
+    unsigned char* region;
+    uint64_t entry_count;
+    uint64_t value_end;
+    uint64_t name_end;
+} RegionWriter;
+
+static void write_entry(RegionWriter* writer, const char* name, bool is_vector, uint64_t length,
+                        const BigInt* wide, const long long* small) {
+    StoreEntry* entry = (StoreEntry*)writer->region + writer->entry_count++;
+    size_t name_length = strlen(name);
+    entry->name_offset = writer->name_end;
+    entry->value_offset = writer->value_end;
+    entry->length = length;
+    entry->is_vector = is_vector;
+    entry->name_length = (uint32_t)name_length;
+    memcpy(writer->region + writer->name_end, name, name_length + 1);
+    writer->name_end += name_length + 1;
+
+    BigInt* values = (BigInt*)(writer->region + writer->value_end);
+    if (wide) {
+        memcpy(values, wide, length * sizeof(BigInt));
+    } else {
+        for (uint64_t i = 0; i < length; ++i) big_int_from_long_long(&values[i], small[i]);
+    }
+    writer->value_end += length * sizeof(BigInt);
+}
+
+// Stored entries the environment did not declare are carried into the commit
+static bool carried_over(const StoreEntry* entry, const RuntimeSymbolTable* numbers, const VectorTable* vectors) {
+    const char* name = entry_name(entry);
+    if (find_runtime_symbol(numbers, name) >= 0) return false;
+    for (int i = 0; i < vectors->count; ++i) {
+        if (strcmp(vectors->vectors[i].name, name) == 0) return false;
+    }
+    return true;
+}
+
+void store_save(const RuntimeSymbolTable* numbers, const VectorTable* vectors) {
+    // Size the region: entries, then values, then names
+    uint64_t count = 0, value_bytes = 0, name_bytes = 0;
+    for (int i = 0; i < numbers->count; ++i) {
+        count++;
+        value_bytes += sizeof(BigInt);
+        name_bytes += strlen(numbers->entries[i].name) + 1;
+    }
+    for (int i = 0; i < vectors->count; ++i) {
+        count++;
+        value_bytes += vectors->vectors[i].length * sizeof(BigInt);
+        name_bytes += strlen(vectors->vectors[i].name) + 1;
+    }
+    bool* keep = entry_count > 0 ? (bool*)calloc(entry_count, sizeof(bool)) : NULL;
+    if (entry_count > 0 && !keep) {
+        fprintf(stderr, "Memory allocation failed for store commit.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint64_t i = 0; i < entry_count; ++i) {
+        keep[i] = carried_over(&entries[i], numbers, vectors);
+        if (!keep[i]) continue;
+        count++;
+        value_bytes += entries[i].length * sizeof(BigInt);
+        name_bytes += entries[i].name_length + 1;
+    }
+    uint64_t values_start = align8(count * sizeof(StoreEntry));
+    uint64_t length = values_start + value_bytes + name_bytes;
+
+    // Before the current region if it fits there, otherwise after it
+    uint64_t offset = STORE_DATA_START;
+    if (active_slot >= 0 && offset + length > active.data_offset) {
+        offset = (active.data_offset + active.data_length + STORE_HEADER_SIZE - 1) / STORE_HEADER_SIZE * STORE_HEADER_SIZE;
+    }
+    uint64_t file_size = offset + length > STORE_DATA_START ? offset + length : STORE_DATA_START;
+    if (file_size > store_map_size) {
+        // Regions beyond the old end read as zeros, and nothing refers to them yet
+        unmap_file();
+        if (ftruncate(store_fd, (off_t)file_size) != 0 || !map_file()) {
+            fprintf(stderr, "Error: Could not grow store '%s': %s; its previous state is kept\n", store_path, strerror(errno));
+            free(keep);
+            return;
+        }
+        entries = (const StoreEntry*)(store_map + active.data_offset);
+    }
+
+    RegionWriter writer = { store_map + offset, 0, values_start, values_start + value_bytes };
+    for (int i = 0; i < numbers->count; ++i) {
+        write_entry(&writer, numbers->entries[i].name, false, 1, &numbers->entries[i].value, NULL);
+    }
+    for (int i = 0; i < vectors->count; ++i) {
+        const NumberVector* vector = &vectors->vectors[i];
+        write_entry(&writer, vector->name, true, vector->length, vector->wide, vector->small);
+    }
+    for (uint64_t i = 0; i < entry_count; ++i) {
+        if (keep[i]) write_entry(&writer, entry_name(&entries[i]), entries[i].is_vector, entries[i].length,
+                                 entry_values(&entries[i]), NULL);
+    }
+    free(keep);
+    // Padding between the entries and the values, so equal states checksum alike
+    memset(writer.region + count * sizeof(StoreEntry), 0, values_start - count * sizeof(StoreEntry));
+
+    StoreHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STORE_MAGIC, sizeof(header.magic));
+    header.generation = active.generation + 1;
+    header.data_offset = offset;
+    header.data_length = length;
+    header.data_checksum = checksum(writer.region, length);
+    header.entry_count = count;
+    header.bigint_size = sizeof(BigInt);
+    header.header_checksum = header_checksum(&header);
+
+    // The region must be on disk before a header points at it
+    int slot = active_slot == 0 ? 1 : 0;
+    if (!sync_range(offset, length)) {
+        fprintf(stderr, "Error: Could not write store '%s': %s; its previous state is kept\n", store_path, strerror(errno));
+        return;
+    }
+    memcpy(store_map + slot * STORE_HEADER_SIZE, &header, sizeof(header));
+    if (!sync_range((uint64_t)slot * STORE_HEADER_SIZE, sizeof(header))) {
+        fprintf(stderr, "Error: Could not write store '%s' header: %s\n", store_path, strerror(errno));
+        return;
+    }
+
+    active = header;
+    active_slot = slot;
+    entries = (const StoreEntry*)(store_map + offset);
+    entry_count = count;
+    free(index_slots);
+    build_index();
+
+    // Space past the new region held only the old one, which no header needs any more
+    if (file_size < store_map_size) {
+        unmap_file();
+        if (ftruncate(store_fd, (off_t)file_size) != 0 || !map_file()) {
+            fprintf(stderr, "Warning: Could not shrink store '%s': %s\n", store_path, strerror(errno));
+        }
+        entries = store_map ? (const StoreEntry*)(store_map + offset) : NULL;
+    }
+}
+
+void store_close(void) {
+    if (store_fd < 0) return;
+    unmap_file();
+    free(index_slots);
+    index_slots = NULL;
+    index_capacity = 0;
+    entries = NULL;
+    entry_count = 0;
+    active_slot = -1;
+    close(store_fd); // Releases the lock
+    store_fd = -1;
+    store_path = NULL;
+}
@@ -0,0 +1,58 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bigint.h"
+#include "interpreter.h"
+#include "vector.h"
+
+// Persistent variables (--store FILE): declarations of stored names start at
+// the value the variable had when an earlier run ended, and every variable is
+// written back when this run ends. The file is mapped, and values are raw
+// BigInts in it, so loading is a checksum and an index rather than parsing.
+//
+// Layout: two header blocks, then data regions. A region holds StoreEntry
+// records, then their values, then their NUL-terminated names. A commit writes
+// a whole new region beside the current one, syncs it, then writes the header
+// block not in use with the next generation and syncs that. Whatever point a
+// crash interrupts it at, one header still describes an intact region, and
+// loading takes the valid header with the higher generation.
+#define STORE_MAGIC "PLSTORE1"
+#define STORE_HEADER_SIZE 4096 // Each header block; regions start after both
+#define STORE_DATA_START (2 * STORE_HEADER_SIZE)
+
+typedef struct {
+    char magic[8];
+    uint64_t generation;      // Commits so far
+    uint64_t data_offset;     // Region in the file
+    uint64_t data_length;
+    uint64_t data_checksum;   // XXH64 of the region
+    uint64_t entry_count;
+    uint64_t bigint_size;     // sizeof(BigInt) of the writer; other layouts are refused
+    uint64_t header_checksum; // XXH64 of the fields above
+} StoreHeader;
+
+typedef struct {
+    uint64_t name_offset;  // Within the region
+    uint64_t value_offset; // Within the region, 8-byte aligned
+    uint64_t length;       // Elements of a vector; 1 for a number
+    uint32_t is_vector;
+    uint32_t name_length;  // Without the NUL
+} StoreEntry;
+
+// Maps and locks the file (creating it if missing); reports the first problem
+// and returns false
+bool store_open(const char* path);
+bool store_is_open(void);
+// Stored value of a number variable, or NULL (not stored, or stored as a vector).
+// Lookups only read, so parallel regions may make them.
+const BigInt* store_number(const char* name);
+// Stored elements of a vector of the given length, or NULL
+const BigInt* store_vector(const char* name, size_t length);
+// Commits the environment: its variables with their current values, plus the
+// stored ones it did not declare, unchanged
+void store_save(const RuntimeSymbolTable* numbers, const VectorTable* vectors);
+void store_close(void);
+
+#endif // STORE_H
@@ -0,0 +1,233 @@
+#include "strscan.h"
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STRSCAN_HAVE_SSSE3_PATH 1
+#endif
+
+// --- Byte-at-a-time automaton ---
+
+// States: what the bytes seen so far still require
+enum {
+    UTF8_ACCEPT = 0,    // Between sequences
+    UTF8_NEED_1,        // One continuation byte (80..BF)
+    UTF8_NEED_2,        // Two continuation bytes
+    UTF8_AFTER_E0,      // A0..BF, then one more (no overlong 3-byte forms)
+    UTF8_AFTER_ED,      // 80..9F, then one more (no surrogates)
+    UTF8_NEED_3,        // Three continuation bytes
+    UTF8_AFTER_F0,      // 90..BF, then two more (no overlong 4-byte forms)
+    UTF8_AFTER_F4,      // 80..8F, then two more (nothing above U+10FFFF)
+    UTF8_REJECT
+};
+
+static int utf8_step(int state, unsigned char byte) {
+    switch (state) {
+        case UTF8_ACCEPT:
+            if (byte < 0x80) return UTF8_ACCEPT;
+            if (byte >= 0xC2 && byte <= 0xDF) return UTF8_NEED_1;
+            if (byte == 0xE0) return UTF8_AFTER_E0;
+            if (byte == 0xED) return UTF8_AFTER_ED;
+            if (byte >= 0xE1 && byte <= 0xEF) return UTF8_NEED_2;
+            if (byte == 0xF0) return UTF8_AFTER_F0;
+            if (byte >= 0xF1 && byte <= 0xF3) return UTF8_NEED_3;
+            if (byte == 0xF4) return UTF8_AFTER_F4;
+            return UTF8_REJECT;
+        case UTF8_NEED_1: return byte >= 0x80 && byte <= 0xBF ? UTF8_ACCEPT : UTF8_REJECT;
+        case UTF8_NEED_2: return byte >= 0x80 && byte <= 0xBF ? UTF8_NEED_1 : UTF8_REJECT;
+        case UTF8_AFTER_E0: return byte >= 0xA0 && byte <= 0xBF ? UTF8_NEED_1 : UTF8_REJECT;
+        case UTF8_AFTER_ED: return byte >= 0x80 && byte <= 0x9F ? UTF8_NEED_1 : UTF8_REJECT;
+        case UTF8_NEED_3: return byte >= 0x80 && byte <= 0xBF ? UTF8_NEED_2 : UTF8_REJECT;
+        case UTF8_AFTER_F0: return byte >= 0x90 && byte <= 0xBF ? UTF8_NEED_2 : UTF8_REJECT;
+        case UTF8_AFTER_F4: return byte >= 0x80 && byte <= 0x8F ? UTF8_NEED_2 : UTF8_REJECT;
+        default: return UTF8_REJECT;
+    }
+}
+
+// Runs the automaton over p[0, n), stepping over ASCII eight bytes at a time
+static int utf8_run(int state, const unsigned char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && state != UTF8_REJECT) {
+        if (state == UTF8_ACCEPT) {
+            uint64_t word;
+            while (i + sizeof(word) <= n) {
+                memcpy(&word, p + i, sizeof(word));
+                if (word & 0x8080808080808080ULL) break;
+                i += sizeof(word);
+            }
+            if (i == n) break;
+        }
+        state = utf8_step(state, p[i++]);
+    }
+    return state;
+}
+
+size_t utf8_invalid_offset(const char* text, size_t length) {
+    const unsigned char* p = (const unsigned char*)text;
+    int state = UTF8_ACCEPT;
+    size_t sequence_start = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (state == UTF8_ACCEPT) sequence_start = i;
+        state = utf8_step(state, p[i]);
+        if (state == UTF8_REJECT) return sequence_start;
+    }
+    return state == UTF8_ACCEPT ? length : sequence_start;
+}
+
+// --- 16 bytes at a time ---
+
+#ifdef STRSCAN_HAVE_SSSE3_PATH
+static pthread_once_t detect_once = PTHREAD_ONCE_INIT;
+static bool cpu_has_ssse3 = false;
+
+static void detect_ssse3(void) {
+    __builtin_cpu_init();
+    cpu_has_ssse3 = __builtin_cpu_supports("ssse3");
+}
+
+// Error classes of a byte pair (the byte before, and this one); a pair is
+// malformed when all three lookups below share a class
+#define TOO_SHORT (1 << 0)      // Lead byte, then a non-continuation
+#define TOO_LONG (1 << 1)       // ASCII, then a continuation
+#define OVERLONG_3 (1 << 2)     // E0 80..9F
+#define TOO_LARGE (1 << 3)      // F4 90..BF, or F5..FF
+#define SURROGATE (1 << 4)      // ED A0..BF
+#define OVERLONG_2 (1 << 5)     // C0..C1
+#define TOO_LARGE_1000 (1 << 6) // F5..FF 80..8F
+#define OVERLONG_4 (1 << 6)     // F0 80..8F
+#define TWO_CONTS (1 << 7)      // Continuation after continuation (unless a 3rd/4th byte)
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+__attribute__((target("ssse3")))
+static __m128i block_errors(__m128i input, __m128i previous) {
+    const __m128i byte_1_high_table = _mm_setr_epi8(
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        (char)TWO_CONTS, (char)TWO_CONTS, (char)TWO_CONTS, (char)TWO_CONTS,
+        TOO_SHORT | OVERLONG_2, TOO_SHORT, TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+    const __m128i byte_1_low_table = _mm_setr_epi8(
+        (char)(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4), (char)(CARRY | OVERLONG_2), (char)CARRY, (char)CARRY,
+        (char)(CARRY | TOO_LARGE), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000));
+    const __m128i byte_2_high_table = _mm_setr_epi8(
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    // prevN holds, at each position, the byte N positions earlier
+    __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+    __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+    __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, nibble));
+    __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+    __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // Third and fourth bytes of a sequence are continuations that must follow
+    // one (TWO_CONTS is expected exactly there)
+    __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i must_continue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must_continue, special);
+}
+
+__attribute__((target("ssse3")))
+static void validate_block(StringScan* scan, __m128i block) {
+    __m128i previous = _mm_loadu_si128((const __m128i*)scan->previous);
+    __m128i errors;
+    if (_mm_movemask_epi8(block) == 0) {
+        // All ASCII: only a sequence left open at the end of the previous block is wrong
+        const __m128i last_leads = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                 (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+        errors = _mm_subs_epu8(previous, last_leads);
+    } else {
+        errors = block_errors(block, previous);
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128())) != 0xFFFF) scan->invalid = true;
+    _mm_storeu_si128((__m128i*)scan->previous, block);
+}
+
+__attribute__((target("ssse3")))
+static size_t scan_ssse3(StringScan* scan, const char* data, size_t length) {
+    size_t i = 0;
+    if (scan->pending_length > 0) {
+        // Complete the block left over from the previous piece
+        size_t take = 16 - scan->pending_length < length ? 16 - scan->pending_length : length;
+        const char* quote = (const char*)memchr(data, '"', take);
+        size_t count = quote ? (size_t)(quote - data) : take;
+        memcpy(scan->pending + scan->pending_length, data, count);
+        scan->pending_length += count;
+        if (quote) return count;
+        if (scan->pending_length < 16) return length;
+        validate_block(scan, _mm_loadu_si128((const __m128i*)scan->pending));
+        scan->pending_length = 0;
+        i = take;
+    }
+
+    const __m128i quote_bytes = _mm_set1_epi8('"');
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        unsigned int quotes = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, quote_bytes));
+        if (quotes) {
+            size_t count = (size_t)__builtin_ctz(quotes);
+            memcpy(scan->pending, data + i, count);
+            scan->pending_length = count;
+            return i + count;
+        }
+        validate_block(scan, block);
+    }
+
+    const char* quote = (const char*)memchr(data + i, '"', length - i);
+    size_t count = quote ? (size_t)(quote - (data + i)) : length - i;
+    memcpy(scan->pending, data + i, count);
+    scan->pending_length = count;
+    return i + count;
+}
+
+__attribute__((target("ssse3")))
+static void finish_ssse3(StringScan* scan) {
+    // Zeros after the last bytes are ASCII, so a sequence cut short shows up
+    unsigned char last[16] = { 0 };
+    memcpy(last, scan->pending, scan->pending_length);
+    validate_block(scan, _mm_loadu_si128((const __m128i*)last));
+}
+#endif
+
+// --- Interface ---
+
+void string_scan_init(StringScan* scan) {
+    memset(scan, 0, sizeof(*scan));
+#ifdef STRSCAN_HAVE_SSSE3_PATH
+    pthread_once(&detect_once, detect_ssse3);
+    scan->vectorized = cpu_has_ssse3;
+#endif
+}
+
+size_t string_scan(StringScan* scan, const char* data, size_t length) {
+#ifdef STRSCAN_HAVE_SSSE3_PATH
+    if (scan->vectorized) return scan_ssse3(scan, data, length);
+#endif
+    const char* quote = (const char*)memchr(data, '"', length);
+    size_t count = quote ? (size_t)(quote - data) : length;
+    scan->state = utf8_run(scan->state, (const unsigned char*)data, count);
+    return count;
+}
+
+bool string_scan_finish(StringScan* scan) {
+#ifdef STRSCAN_HAVE_SSSE3_PATH
+    if (scan->vectorized) {
+        finish_ssse3(scan);
+        return !scan->invalid;
+    }
+#endif
+    return scan->state == UTF8_ACCEPT;
+}
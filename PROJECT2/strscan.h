@@ -0,0 +1,32 @@
+#ifndef STRSCAN_H
+#define STRSCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Scan of the contents of one string literal, fed in pieces as the lexer's
+// buffer fills: finds the closing quote and checks on the way that the bytes
+// before it are well-formed UTF-8. With SSSE3 both happen 16 bytes at a time
+// (the lookup-table validation of Keiser and Lemire); otherwise memchr finds
+// the quote and a byte-at-a-time automaton validates.
+typedef struct {
+    unsigned char previous[16]; // Last validated block; sequences may continue from it
+    unsigned char pending[16];  // Bytes scanned but not validated yet (less than a block)
+    size_t pending_length;
+    int state;                  // Automaton state (byte-at-a-time path)
+    bool invalid;
+    bool vectorized;            // Taking the SSSE3 path (decided once per process)
+} StringScan;
+
+void string_scan_init(StringScan* scan);
+// Scans data[0, length) for the closing quote, returning its index, or length
+// if the literal goes on past the data
+size_t string_scan(StringScan* scan, const char* data, size_t length);
+// After the closing quote: true if everything before it was well-formed
+bool string_scan_finish(StringScan* scan);
+
+// Offset where the first malformed (or cut short) UTF-8 sequence of
+// text[0, length) starts, or length if there is none
+size_t utf8_invalid_offset(const char* text, size_t length);
+
+#endif // STRSCAN_H
@@ -0,0 +1,45 @@
+#!/bin/sh
+# Compares the two front ends: startup (mean wall time of a one-line script,
+# dominated by LR table construction for --parser=lr) and throughput (one run
+# of a generated script of LINES statements, lexing and running included).
+#
+# Usage: tests/bench_parsers.sh [RUNS [LINES]]   (defaults: 200 and 300000)
+# PROGLANG names the interpreter binary (default: ./proglang).
+
+PROGLANG=${PROGLANG:-./proglang}
+RUNS=${1:-200}
+LINES=${2:-300000}
+if [ ! -x "$PROGLANG" ]; then
+    echo "Interpreter '$PROGLANG' not found; build it or set PROGLANG" >&2
+    exit 2
+fi
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+echo 'number a;' > "$work/one_line.txt"
+awk -v lines="$LINES" 'BEGIN {
+    print "number a;"; print "number b;"
+    for (i = 2; i < lines; ++i) {
+        if (i % 4 == 0) print "a += " i ";"
+        else if (i % 4 == 1) print "b -= a;"
+        else if (i % 4 == 2) print "repeat 2 times { a += 1; b += a; }"
+        else print "write a and \" \" and b and newline;"
+    }
+}' > "$work/long.txt"
+
+now_ns() { date +%s%N; }
+
+for parser in lr rd; do
+    start=$(now_ns)
+    i=0
+    while [ $i -lt "$RUNS" ]; do
+        "$PROGLANG" -q --parser=$parser "$work/one_line.txt" > /dev/null
+        i=$((i + 1))
+    done
+    startup=$(( ($(now_ns) - start) / RUNS / 1000 ))
+
+    start=$(now_ns)
+    "$PROGLANG" -q --parser=$parser "$work/long.txt" > /dev/null
+    long=$(( ($(now_ns) - start) / 1000000 ))
+    echo "$parser: startup $startup us (mean of $RUNS), $LINES lines $long ms"
+done
@@ -0,0 +1,28 @@
+#!/bin/sh
+# Differential test of the two front ends: runs --parser=compare on every
+# program below the given directories (default: the corpus next to this
+# script) and fails if the LR and recursive-descent parsers disagree on any.
+#
+# Usage: tests/compare_parsers.sh [directory...]
+# PROGLANG names the interpreter binary (default: ./proglang, built in
+# PROJECT2 with: gcc -O2 -Wall -pthread -o proglang *.c).
+
+PROGLANG=${PROGLANG:-./proglang}
+if [ ! -x "$PROGLANG" ]; then
+    echo "Interpreter '$PROGLANG' not found; build it or set PROGLANG" >&2
+    exit 2
+fi
+[ $# -eq 0 ] && set -- "$(dirname "$0")/corpus"
+
+checked=0
+failed=0
+for file in $(find "$@" -type f -name '*.txt' | sort); do
+    checked=$((checked + 1))
+    # Files the lexer rejects never reach either parser, so only the verdict line counts
+    if "$PROGLANG" -q --parser=compare "$file" 2>&1 | grep -q '^Parsers disagree'; then
+        echo "DISAGREE: $file"
+        failed=$((failed + 1))
+    fi
+done
+echo "Compared $checked program(s): $failed disagreement(s)"
+[ $failed -eq 0 ]
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Regression tests: runs every regress/NAME.txt in each execution mode and
+# compares its output with regress/NAME.out, or, for long outputs, its
+# --digest line with regress/NAME.digest.
+#
+# Usage: tests/run_regress.sh
+# PROGLANG names the interpreter binary (default: ./proglang, built in
+# PROJECT2 with: gcc -O2 -Wall -pthread -o proglang *.c).
+
+PROGLANG=${PROGLANG:-./proglang}
+if [ ! -x "$PROGLANG" ]; then
+    echo "Interpreter '$PROGLANG' not found; build it or set PROGLANG" >&2
+    exit 2
+fi
+
+# Programs run from regress/, so the file names in their messages do not
+# depend on where the script was started
+PROGLANG=$(cd "$(dirname "$PROGLANG")" && pwd)/$(basename "$PROGLANG")
+cd "$(dirname "$0")/regress" || exit 2
+
+failed=0
+for program in *.txt; do
+    expected="${program%.txt}.out"
+    digest=
+    if [ -f "${program%.txt}.digest" ]; then
+        expected="${program%.txt}.digest"
+        digest=--digest
+    fi
+    for mode in "" -O --parser=rd --pipeline; do
+        if ! "$PROGLANG" -q $digest $mode "$program" < /dev/null 2>&1 | cmp -s - "$expected"; then
+            echo "FAIL: $program ${mode:-(default)}"
+            failed=$((failed + 1))
+        fi
+    done
+done
+echo "$failed failure(s)"
+[ $failed -eq 0 ]
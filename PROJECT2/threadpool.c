@@ -0,0 +1,107 @@
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;   // Signalled when a new job is posted
+    pthread_cond_t work_done;    // Signalled when the last task of a job finishes
+    int worker_count;
+    unsigned long generation;    // Incremented for every job, so workers notice new ones
+
+    ParallelTask task;
+    void* context;
+    int task_count;
+    int next_task;               // Next unclaimed task index
+    int finished_tasks;
+    bool busy;                   // A job is in flight (another caller then runs its tasks inline)
+} ThreadPool;
+
+static ThreadPool pool = { .lock = PTHREAD_MUTEX_INITIALIZER, .work_ready = PTHREAD_COND_INITIALIZER,
+                           .work_done = PTHREAD_COND_INITIALIZER, .worker_count = -1 };
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static _Thread_local bool inside_task = false;
+
+// Claims and runs tasks of the current job until none are left. Called with the lock held.
+static void run_tasks_locked(void) {
+    while (pool.next_task < pool.task_count) {
+        int index = pool.next_task++;
+        ParallelTask task = pool.task;
+        void* context = pool.context;
+        pthread_mutex_unlock(&pool.lock);
+        inside_task = true;
+        task(context, index);
+        inside_task = false;
+        pthread_mutex_lock(&pool.lock);
+        if (++pool.finished_tasks == pool.task_count) {
+            pthread_cond_broadcast(&pool.work_done);
+        }
+    }
+}
+
+static void* worker_main(void* arg) {
+    (void)arg;
+    unsigned long seen = 0;
+    pthread_mutex_lock(&pool.lock);
+    while (true) {
+        while (pool.generation == seen) {
+            pthread_cond_wait(&pool.work_ready, &pool.lock);
+        }
+        seen = pool.generation;
+        run_tasks_locked();
+    }
+    return NULL;
+}
+
+static void start_workers(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = cpus > 1 ? (int)cpus - 1 : 0;
+    if (workers > THREADPOOL_MAX_WORKERS) workers = THREADPOOL_MAX_WORKERS;
+
+    int started = 0;
+    for (int i = 0; i < workers; ++i) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, worker_main, NULL) != 0) break;
+        pthread_detach(thread);
+        started++;
+    }
+    pool.worker_count = started;
+}
+
+int parallel_thread_count(void) {
+    pthread_once(&pool_once, start_workers);
+    return pool.worker_count + 1;
+}
+
+void parallel_for(int task_count, ParallelTask task, void* context) {
+    if (task_count <= 0) return;
+    if (inside_task || parallel_thread_count() == 1 || task_count == 1) {
+        for (int i = 0; i < task_count; ++i) task(context, i);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    if (pool.busy) {
+        pthread_mutex_unlock(&pool.lock);
+        for (int i = 0; i < task_count; ++i) task(context, i);
+        return;
+    }
+    pool.busy = true;
+    pool.task = task;
+    pool.context = context;
+    pool.task_count = task_count;
+    pool.next_task = 0;
+    pool.finished_tasks = 0;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.work_ready);
+
+    run_tasks_locked();
+    while (pool.finished_tasks < pool.task_count) {
+        pthread_cond_wait(&pool.work_done, &pool.lock);
+    }
+    pool.busy = false;
+    pthread_mutex_unlock(&pool.lock);
+}
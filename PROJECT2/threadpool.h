@@ -0,0 +1,19 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// Upper bound on worker threads, whatever the machine reports
+#define THREADPOOL_MAX_WORKERS 64
+
+// One unit of work: called once per task index
+typedef void (*ParallelTask)(void* context, int task_index);
+
+// Runs task(context, i) for every i in [0, task_count) on a shared pool of
+// worker threads (created on first use, one per online CPU) and returns once
+// all of them have finished. The calling thread takes part. Calls made from
+// inside a task run sequentially on the calling thread.
+void parallel_for(int task_count, ParallelTask task, void* context);
+
+// Number of threads parallel_for spreads work across, including the caller
+int parallel_thread_count(void);
+
+#endif // THREADPOOL_H
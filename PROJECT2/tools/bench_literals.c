@@ -0,0 +1,94 @@
+// bench-literals: times big_int_from_string() across literal lengths against the
+// digit-at-a-time conversion it replaced, and checks that both agree.
+// Built on its own, from PROJECT2:
+//   gcc -O2 -Wall -pthread -o bench-literals tools/bench_literals.c bigint.c
+// Usage: bench-literals [length...]   (default: 19 100 115 1000 10000)
+#include "../bigint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Total digits converted per length, so short and long strings time alike
+#define DIGITS_PER_LENGTH 20000000
+
+// The previous conversion, as it was: num = num * 10 + digit for every digit (modulo 2^384)
+static void digit_at_a_time(BigInt* num, const char* str) {
+    memset(num->limbs, 0, sizeof(num->limbs));
+    int sign = 1;
+    if (*str == '-') {
+        sign = -1;
+        str++;
+    }
+    BigInt times_ten, digit;
+    for (; *str; ++str) {
+        unsigned long long carry = 0;
+        for (int k = 0; k < NUM_LIMBS; ++k) {
+            unsigned __int128 product = (unsigned __int128)num->limbs[k] * 10 + carry;
+            times_ten.limbs[k] = (unsigned long long)product;
+            carry = (unsigned long long)(product >> 64);
+        }
+        times_ten.sign = 1;
+        big_int_from_long_long(&digit, *str - '0');
+        big_int_abs_add(num, &times_ten, &digit);
+    }
+    num->sign = sign;
+    big_int_normalize(num);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Nanoseconds per conversion of text, over enough repetitions to total DIGITS_PER_LENGTH digits
+static double time_conversion(void (*convert)(BigInt*, const char*), const char* text, size_t length) {
+    long repetitions = DIGITS_PER_LENGTH / (long)length + 1;
+    volatile unsigned long long sink = 0; // Keeps the conversions from being optimized away
+    BigInt result;
+    double start = now_seconds();
+    for (long i = 0; i < repetitions; ++i) {
+        convert(&result, text);
+        sink += result.limbs[0];
+    }
+    (void)sink;
+    return (now_seconds() - start) * 1e9 / (double)repetitions;
+}
+
+int main(int argc, char* argv[]) {
+    static const size_t default_lengths[] = { 19, 100, 115, 1000, 10000 };
+    int count = argc > 1 ? argc - 1 : (int)(sizeof(default_lengths) / sizeof(default_lengths[0]));
+
+    printf("%8s %14s %14s %8s\n", "digits", "old ns", "new ns", "speedup");
+    srand(1);
+    for (int i = 0; i < count; ++i) {
+        size_t length = argc > 1 ? strtoul(argv[i + 1], NULL, 10) : default_lengths[i];
+        if (length == 0) {
+            fprintf(stderr, "Error: Lengths must be positive\n");
+            return EXIT_FAILURE;
+        }
+        char* text = (char*)malloc(length + 1);
+        if (!text) {
+            fprintf(stderr, "Memory allocation failed for benchmark text.\n");
+            return EXIT_FAILURE;
+        }
+        text[0] = (char)('1' + rand() % 9);
+        for (size_t d = 1; d < length; ++d) text[d] = (char)('0' + rand() % 10);
+        text[length] = '\0';
+
+        BigInt expected, actual;
+        digit_at_a_time(&expected, text);
+        big_int_from_string(&actual, text);
+        if (memcmp(expected.limbs, actual.limbs, sizeof(expected.limbs)) != 0 || expected.sign != actual.sign) {
+            fprintf(stderr, "Error: Conversions disagree on a %zu-digit string\n", length);
+            return EXIT_FAILURE;
+        }
+
+        double old_ns = time_conversion(digit_at_a_time, text, length);
+        double new_ns = time_conversion(big_int_from_string, text, length);
+        printf("%8zu %14.0f %14.0f %7.1fx\n", length, old_ns, new_ns, old_ns / new_ns);
+        free(text);
+    }
+    return 0;
+}
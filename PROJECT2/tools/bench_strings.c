@@ -0,0 +1,131 @@
+// bench-strings: times what the lexer does with a string literal once its
+// opening quote is read: scanning and UTF-8 validation alone (all a span into
+// the input would need), the copy of the contents that interning makes, and
+// interning as the lexer does it, for literals seen once and seen again.
+// Built on its own, from PROJECT2:
+//   gcc -O2 -Wall -pthread -o bench-strings tools/bench_strings.c strscan.c constpool.c digest.c bigint.c
+// Usage: bench-strings [length...]   (default: 16 80 256 4096 65536)
+#include "../strscan.h"
+#include "../constpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Literal bytes processed per length and measurement, so short and long literals time alike
+#define BYTES_PER_LENGTH (64u << 20)
+// Distinct literals per length; interning more than this many reuses them
+#define MAX_LITERALS 4096
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Fills text with length bytes of mixed ASCII and two- and three-byte UTF-8
+// (like a localized banner), then the closing quote
+static void fill_literal(char* text, size_t length) {
+    static const char* pieces[] = { "Welcome ", "\xC3\xA9t\xC3\xA9 ", "\xE6\x97\xA5\xE6\x9C\xAC ", "line 42, " };
+    size_t filled = 0;
+    while (filled < length) {
+        const char* piece = pieces[rand() % 4];
+        size_t piece_length = strlen(piece);
+        if (filled + piece_length > length) piece = "x", piece_length = 1;
+        memcpy(text + filled, piece, piece_length);
+        filled += piece_length;
+    }
+    text[length] = '"';
+}
+
+// What the lexer does before deciding what to keep: find the quote, validate
+static size_t scan(const char* text, size_t length) {
+    StringScan state;
+    string_scan_init(&state);
+    size_t end = string_scan(&state, text, length + 1);
+    return string_scan_finish(&state) ? end : 0;
+}
+
+int main(int argc, char* argv[]) {
+    static const size_t default_lengths[] = { 16, 80, 256, 4096, 65536 };
+    int count = argc > 1 ? argc - 1 : (int)(sizeof(default_lengths) / sizeof(default_lengths[0]));
+
+    printf("%8s %12s %12s %14s %14s\n", "bytes", "scan ns", "copy ns", "intern new ns", "intern seen ns");
+    srand(1);
+    for (int i = 0; i < count; ++i) {
+        size_t length = argc > 1 ? strtoul(argv[i + 1], NULL, 10) : default_lengths[i];
+        if (length == 0) {
+            fprintf(stderr, "Error: Lengths must be positive\n");
+            return EXIT_FAILURE;
+        }
+        long repetitions = BYTES_PER_LENGTH / (long)length + 1;
+        int literals = repetitions < MAX_LITERALS ? (int)repetitions : MAX_LITERALS;
+        char** texts = (char**)malloc(literals * sizeof(char*));
+        if (!texts) {
+            fprintf(stderr, "Memory allocation failed for benchmark literals.\n");
+            return EXIT_FAILURE;
+        }
+        for (int t = 0; t < literals; ++t) {
+            texts[t] = (char*)malloc(length + 1);
+            if (!texts[t]) {
+                fprintf(stderr, "Memory allocation failed for benchmark literals.\n");
+                return EXIT_FAILURE;
+            }
+            fill_literal(texts[t], length);
+            if (scan(texts[t], length) != length) {
+                fprintf(stderr, "Error: A %zu-byte benchmark literal does not scan as valid\n", length);
+                return EXIT_FAILURE;
+            }
+        }
+
+        volatile size_t sink = 0; // Keeps the work from being optimized away
+        double start = now_seconds();
+        for (long r = 0; r < repetitions; ++r) sink += scan(texts[r % literals], length);
+        double scan_ns = (now_seconds() - start) * 1e9 / (double)repetitions;
+
+        // The copy interning adds for a literal it has not seen: allocate, copy, terminate
+        start = now_seconds();
+        for (long r = 0; r < repetitions; ++r) {
+            char* copy = (char*)malloc(length + 1);
+            if (!copy) {
+                fprintf(stderr, "Memory allocation failed for benchmark copy.\n");
+                return EXIT_FAILURE;
+            }
+            memcpy(copy, texts[r % literals], length);
+            copy[length] = '\0';
+            sink += (size_t)copy[length / 2];
+            free(copy);
+        }
+        double copy_ns = (now_seconds() - start) * 1e9 / (double)repetitions;
+
+        // Interning as the lexer does it, into an emptied pool each round, so
+        // every literal is new; the last round's entries stay for the next test
+        double new_seconds = 0.0;
+        for (long done = 0; done < repetitions; done += literals) {
+            constant_pool_free();
+            start = now_seconds();
+            for (int t = 0; t < literals; ++t) {
+                size_t end = scan(texts[t], length);
+                sink += (size_t)constant_pool_string(texts[t], end)->length;
+            }
+            new_seconds += now_seconds() - start;
+        }
+        double new_ns = new_seconds * 1e9 / (double)(((repetitions + literals - 1) / literals) * literals);
+
+        // Now every literal is in the pool: hashing and comparing, no copy
+        start = now_seconds();
+        for (long r = 0; r < repetitions; ++r) {
+            const char* text = texts[r % literals];
+            size_t end = scan(text, length);
+            sink += (size_t)constant_pool_string(text, end)->length;
+        }
+        double seen_ns = (now_seconds() - start) * 1e9 / (double)repetitions;
+        (void)sink;
+
+        printf("%8zu %12.0f %12.0f %14.0f %14.0f\n", length, scan_ns, copy_ns, new_ns, seen_ns);
+        constant_pool_free();
+        for (int t = 0; t < literals; ++t) free(texts[t]);
+        free(texts);
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+// proglang-decompress: decodes the output of a run with --compress.
+// Built on its own, from PROJECT2:
+//   gcc -O2 -Wall -o proglang-decompress tools/proglang_decompress.c compress.c
+#include "../compress.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[]) {
+    if (argc > 3 || (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0))) {
+        fprintf(stderr, "Usage: %s [compressed_file [output_file]]\n", argv[0]);
+        fprintf(stderr, "Reads stdin and writes stdout when a file is not given or is '-'\n");
+        return EXIT_FAILURE;
+    }
+    FILE* in = argc > 1 && strcmp(argv[1], "-") != 0 ? fopen(argv[1], "rb") : stdin;
+    if (!in) {
+        fprintf(stderr, "Error: Could not open input file '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    FILE* out = argc > 2 && strcmp(argv[2], "-") != 0 ? fopen(argv[2], "wb") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: Could not open output file '%s'\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    bool ok = decompress_stream(in, out);
+    if (fflush(out) != 0) {
+        fprintf(stderr, "Error: Could not write the output\n");
+        ok = false;
+    }
+    if (in != stdin) fclose(in);
+    if (out != stdout) fclose(out);
+    return ok ? 0 : EXIT_FAILURE;
+}
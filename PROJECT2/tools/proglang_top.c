@@ -0,0 +1,204 @@
+// proglang-top: shows the progress of interpreters started with --metrics.
+// Built on its own, from PROJECT2:
+//   gcc -O2 -Wall -o proglang-top tools/proglang_top.c
+#include "../metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// Where Linux keeps POSIX shared memory objects
+#define SHM_DIRECTORY "/dev/shm"
+#define MAX_PROCESSES 256
+
+static const char* phase_names[METRICS_PHASE_COUNT] = {
+    "starting", "lexing", "parsing", "linking", "optimizing", "running", "finished"
+};
+
+typedef struct {
+    int32_t pid;
+    int32_t phase;
+    char script[METRICS_SCRIPT_LENGTH];
+    uint64_t started_ns;
+    uint64_t statements;
+    uint64_t loop_depth;
+    uint64_t loop_iteration;
+    uint64_t bytes_written;
+    uint64_t memory_bytes;
+} Sample;
+
+// Statement counts of the previous refresh, for the rate column
+static Sample previous[MAX_PROCESSES];
+static int previous_count = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Copies one segment; false if it is not (yet) a complete segment
+static bool read_segment(const char* name, Sample* sample) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", SHM_DIRECTORY, name);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    void* map = mmap(NULL, sizeof(MetricsSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    const MetricsSegment* segment = (const MetricsSegment*)map;
+    bool ok = memcmp(segment->magic, METRICS_MAGIC, sizeof(segment->magic)) == 0;
+    if (ok) {
+        // Pairs with the fence metrics_open puts before the magic
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        sample->pid = segment->pid;
+        sample->phase = __atomic_load_n(&segment->phase, __ATOMIC_RELAXED);
+        memcpy(sample->script, segment->script, sizeof(sample->script));
+        sample->script[sizeof(sample->script) - 1] = '\0';
+        sample->started_ns = segment->started_ns;
+        sample->statements = __atomic_load_n(&segment->statements, __ATOMIC_RELAXED);
+        sample->loop_depth = __atomic_load_n(&segment->loop_depth, __ATOMIC_RELAXED);
+        sample->loop_iteration = __atomic_load_n(&segment->loop_iteration, __ATOMIC_RELAXED);
+        sample->bytes_written = __atomic_load_n(&segment->bytes_written, __ATOMIC_RELAXED);
+        sample->memory_bytes = __atomic_load_n(&segment->memory_bytes, __ATOMIC_RELAXED);
+        if (sample->phase < 0 || sample->phase >= METRICS_PHASE_COUNT) sample->phase = METRICS_PHASE_STARTING;
+    }
+    munmap(map, sizeof(MetricsSegment));
+    return ok;
+}
+
+// Formats a byte count with a binary unit
+static void format_bytes(uint64_t bytes, char* buffer, size_t size) {
+    static const char* units[] = { "B", "K", "M", "G", "T" };
+    double value = (double)bytes;
+    int unit = 0;
+    while (value >= 1024.0 && unit < 4) {
+        value /= 1024.0;
+        unit++;
+    }
+    if (unit == 0) snprintf(buffer, size, "%lluB", (unsigned long long)bytes);
+    else snprintf(buffer, size, "%.1f%s", value, units[unit]);
+}
+
+static int compare_pids(const void* a, const void* b) {
+    return ((const Sample*)a)->pid - ((const Sample*)b)->pid;
+}
+
+// Collects the segments of interpreters, removing finished ones after this
+// last look at their final counts and dropping those whose process died
+// without finishing (killed, or crashed); returns how many it found
+static int collect(Sample* samples) {
+    DIR* dir = opendir(SHM_DIRECTORY);
+    if (!dir) {
+        fprintf(stderr, "Error: Could not open '%s'\n", SHM_DIRECTORY);
+        exit(EXIT_FAILURE);
+    }
+    int count = 0;
+    size_t prefix_length = strlen(METRICS_NAME_PREFIX);
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL && count < MAX_PROCESSES) {
+        if (strncmp(entry->d_name, METRICS_NAME_PREFIX, prefix_length) != 0) continue;
+        Sample sample;
+        if (!read_segment(entry->d_name, &sample)) continue;
+        bool finished = sample.phase == METRICS_PHASE_FINISHED;
+        if (finished || (kill(sample.pid, 0) != 0 && errno == ESRCH)) {
+            char name[512];
+            snprintf(name, sizeof(name), "/%s", entry->d_name);
+            shm_unlink(name);
+            if (!finished) continue;
+        }
+        samples[count++] = sample;
+    }
+    closedir(dir);
+    qsort(samples, count, sizeof(Sample), compare_pids);
+    return count;
+}
+
+static void print_table(const Sample* samples, int count, double interval_seconds) {
+    uint64_t now = now_ns();
+    printf("%7s %-10s %9s %14s %12s %5s %12s %9s %9s  %s\n",
+           "PID", "PHASE", "ELAPSED", "STATEMENTS", "STMTS/S", "DEPTH", "ITERATION", "OUTPUT", "MEMORY", "SCRIPT");
+    for (int i = 0; i < count; ++i) {
+        const Sample* sample = &samples[i];
+        double elapsed = now > sample->started_ns ? (double)(now - sample->started_ns) / 1e9 : 0.0;
+
+        // The rate needs this process in the previous refresh; until then it
+        // is the average since startup
+        double rate = elapsed > 0.0 ? (double)sample->statements / elapsed : 0.0;
+        for (int j = 0; j < previous_count; ++j) {
+            if (previous[j].pid == sample->pid && previous[j].started_ns == sample->started_ns) {
+                rate = (double)(sample->statements - previous[j].statements) / interval_seconds;
+                break;
+            }
+        }
+
+        char output[32], memory[32];
+        format_bytes(sample->bytes_written, output, sizeof(output));
+        format_bytes(sample->memory_bytes, memory, sizeof(memory));
+        printf("%7d %-10s %8.1fs %14llu %12.0f %5llu %12llu %9s %9s  %s\n",
+               sample->pid, phase_names[sample->phase], elapsed,
+               (unsigned long long)sample->statements, rate,
+               (unsigned long long)sample->loop_depth, (unsigned long long)sample->loop_iteration,
+               output, memory, sample->script);
+    }
+    if (count == 0) printf("(no interpreters running with --metrics)\n");
+    fflush(stdout);
+
+    memcpy(previous, samples, sizeof(Sample) * count);
+    previous_count = count;
+}
+
+static void print_usage(const char* program_name) {
+    fprintf(stderr, "Usage: %s [-d SECONDS] [-n COUNT] [-1]\n", program_name);
+    fprintf(stderr, "  -d SECONDS  Time between refreshes (default 1)\n");
+    fprintf(stderr, "  -n COUNT    Stop after COUNT refreshes (default: run until interrupted)\n");
+    fprintf(stderr, "  -1          Print one table and exit (same as -n 1)\n");
+}
+
+int main(int argc, char* argv[]) {
+    double interval_seconds = 1.0;
+    long refreshes = -1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            interval_seconds = atof(argv[++i]);
+            if (interval_seconds <= 0.0) {
+                fprintf(stderr, "Error: -d expects a positive number of seconds\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            refreshes = atol(argv[++i]);
+            if (refreshes < 1) {
+                fprintf(stderr, "Error: -n expects a positive count\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "-1") == 0) {
+            refreshes = 1;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Clears the screen between tables only when someone is watching
+    bool interactive = isatty(STDOUT_FILENO) && refreshes != 1;
+    static Sample samples[MAX_PROCESSES];
+    for (long n = 0; refreshes < 0 || n < refreshes; ++n) {
+        if (n > 0) {
+            struct timespec pause = { (time_t)interval_seconds,
+                                      (long)((interval_seconds - (double)(time_t)interval_seconds) * 1e9) };
+            nanosleep(&pause, NULL);
+        }
+        int count = collect(samples);
+        if (interactive) printf("\033[H\033[2J");
+        else if (n > 0) printf("\n");
+        print_table(samples, count, interval_seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,740 @@
+#include "units.h"
+#include "cache.h"
+#include "lexer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define UNIT_MAGIC "PLUNIT01"
+// Bits of UnitNodeRecord.loop_parts
+#define UNIT_LOOP_COUNT 1
+#define UNIT_LOOP_BODY 2
+
+// On-disk unit: header, identity string, source, artifact. Like output cache
+// entries, the identity and source are kept so reuse is verified byte for byte.
+typedef struct {
+    char magic[8];
+    uint64_t identity_length;
+    uint64_t source_length;
+    uint64_t artifact_length;
+} UnitEntryHeader;
+
+// One node of an artifact, followed by payload_length bytes: an identifier's
+// name, an integer's BigInt, a string's contents or a keyword's lexeme. Nodes
+// come in ast_walk order (children, then a loop's count and body), so each
+// record is followed by the subtrees it owns.
+typedef struct {
+    int32_t type;
+    int32_t line;
+    int32_t column;
+    int32_t offset;
+    int32_t num_children;
+    int32_t loop_parts;
+    int32_t symbol_index;
+    uint32_t payload_length;
+} UnitNodeRecord;
+
+// A file compiled in this run, found again by the hash of its bytes
+typedef struct {
+    uint64_t hash;
+    char* source;
+    size_t source_length;
+    char* artifact;
+    size_t artifact_length;
+} CompiledUnit;
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} ByteBuffer;
+
+// A file on the include chain being linked
+typedef struct {
+    dev_t device;
+    ino_t inode;
+} ActiveFile;
+
+typedef struct {
+    UnitParser parse;
+    void* parse_context;
+    const char* cache_dir;
+    ActiveFile* active; // The program, then each file whose include is being linked
+    int active_count;
+    int active_capacity;
+} Linker;
+
+// Compiled units and the file names linked nodes point to, for the whole run
+static struct {
+    CompiledUnit* units;
+    int count;
+    int capacity;
+    char** paths;
+    int path_count;
+    int path_capacity;
+} registry;
+
+static void append_bytes(ByteBuffer* buffer, const void* data, size_t length) {
+    if (buffer->length + length > buffer->capacity) {
+        size_t capacity = buffer->capacity == 0 ? 4096 : buffer->capacity;
+        while (capacity < buffer->length + length) capacity *= 2;
+        buffer->data = (char*)realloc(buffer->data, capacity);
+        if (!buffer->data) {
+            fprintf(stderr, "Memory allocation failed for unit artifact.\n");
+            exit(EXIT_FAILURE);
+        }
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+}
+
+// Path of an included file: absolute, or relative to the directory of the file naming it
+static char* resolve_path(const char* including_path, const char* path) {
+    const char* slash = path[0] == '/' ? NULL : strrchr(including_path, '/');
+    size_t directory_length = slash ? (size_t)(slash - including_path) + 1 : 0;
+    char* resolved = (char*)malloc(directory_length + strlen(path) + 1);
+    if (!resolved) {
+        fprintf(stderr, "Memory allocation failed for include path.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(resolved, including_path, directory_length);
+    strcpy(resolved + directory_length, path);
+    return resolved;
+}
+
+// A copy of path that lives until units_free
+static const char* intern_path(const char* path) {
+    for (int i = 0; i < registry.path_count; ++i) {
+        if (strcmp(registry.paths[i], path) == 0) return registry.paths[i];
+    }
+    if (registry.path_count >= registry.path_capacity) {
+        registry.path_capacity = registry.path_capacity == 0 ? 8 : registry.path_capacity * 2;
+        registry.paths = (char**)realloc(registry.paths, registry.path_capacity * sizeof(char*));
+        if (!registry.paths) {
+            fprintf(stderr, "Memory allocation failed for unit paths.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    char* copy = strdup(path);
+    if (!copy) {
+        fprintf(stderr, "Memory allocation failed for unit paths.\n");
+        exit(EXIT_FAILURE);
+    }
+    registry.paths[registry.path_count++] = copy;
+    return copy;
+}
+
+// --- Artifacts ---
+
+static void encode_visit(ASTNode* node, int depth, void* context) {
+    (void)depth;
+    ByteBuffer* out = (ByteBuffer*)context;
+    UnitNodeRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = node->type;
+    record.line = node->location.line;
+    record.column = node->location.column;
+    record.offset = node->location.offset;
+    record.num_children = node->num_children;
+
+    const void* payload = NULL;
+    size_t payload_length = 0;
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            record.symbol_index = node->data.identifier.symbol_table_index;
+            payload = node->data.identifier.name;
+            payload_length = strlen(node->data.identifier.name);
+            break;
+        case AST_INTEGER_LITERAL:
+            payload = &node->data.constant->value;
+            payload_length = sizeof(BigInt);
+            break;
+        case AST_STRING_LITERAL:
+            payload = node->data.constant->text;
+            payload_length = node->data.constant->length;
+            break;
+        case AST_KEYWORD:
+            payload = node->data.keyword_lexeme;
+            payload_length = strlen(node->data.keyword_lexeme);
+            break;
+        case AST_LOOP_STATEMENT:
+            record.loop_parts = (node->data.loop.count_expr ? UNIT_LOOP_COUNT : 0) |
+                                (node->data.loop.body ? UNIT_LOOP_BODY : 0);
+            break;
+        default:
+            break;
+    }
+    record.payload_length = (uint32_t)payload_length;
+    append_bytes(out, &record, sizeof(record));
+    if (payload_length > 0) append_bytes(out, payload, payload_length);
+}
+
+static char* copy_text(const char* text, size_t length) {
+    char* copy = (char*)malloc(length + 1);
+    if (!copy) {
+        fprintf(stderr, "Memory allocation failed for unit node.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// A node still owed subtrees while decoding
+typedef struct {
+    ASTNode* node;
+    int children;   // Children still to come
+    int loop_parts; // UNIT_LOOP_* parts still to come
+} DecodeFrame;
+
+// Rebuilds the tree an artifact describes, its nodes located in filename.
+// Returns NULL if the bytes do not form exactly one well-formed tree.
+static ASTNode* decode_artifact(const char* data, size_t length, const char* filename) {
+    DecodeFrame* frames = NULL;
+    int frame_count = 0, frame_capacity = 0;
+    ASTNode* root = NULL;
+    size_t pos = 0;
+
+    while (pos < length) {
+        UnitNodeRecord record;
+        if (length - pos < sizeof(record)) goto malformed;
+        memcpy(&record, data + pos, sizeof(record));
+        pos += sizeof(record);
+        if (record.payload_length > length - pos || record.num_children < 0 ||
+            record.type < AST_PROGRAM || record.type > AST_ERROR_NODE_TYPE || (root && frame_count == 0)) {
+            goto malformed;
+        }
+
+        SourceLocation location = { record.line, record.column, record.offset, filename };
+        ASTNode* node = create_ast_node((ASTNodeType)record.type, location);
+        const char* payload = data + pos;
+        pos += record.payload_length;
+        switch (node->type) {
+            case AST_IDENTIFIER:
+                node->data.identifier.name = copy_text(payload, record.payload_length);
+                node->data.identifier.symbol_table_index = record.symbol_index;
+                break;
+            case AST_INTEGER_LITERAL: {
+                BigInt value;
+                if (record.payload_length != sizeof(value)) {
+                    free(node);
+                    goto malformed;
+                }
+                memcpy(&value, payload, sizeof(value));
+                node->data.constant = constant_pool_integer(&value);
+                break;
+            }
+            case AST_STRING_LITERAL:
+                node->data.constant = constant_pool_string(payload, record.payload_length);
+                break;
+            case AST_KEYWORD:
+                node->data.keyword_lexeme = copy_text(payload, record.payload_length);
+                break;
+            default:
+                break;
+        }
+
+        // Hang the node in its parent's next open slot
+        if (!root) {
+            root = node;
+        } else {
+            DecodeFrame* parent = &frames[frame_count - 1];
+            if (parent->children > 0) {
+                add_child_to_ast_node(parent->node, node);
+                parent->children--;
+            } else if (parent->loop_parts & UNIT_LOOP_COUNT) {
+                parent->node->data.loop.count_expr = node;
+                parent->loop_parts &= ~UNIT_LOOP_COUNT;
+            } else {
+                parent->node->data.loop.body = node;
+                parent->loop_parts = 0;
+            }
+            while (frame_count > 0 && frames[frame_count - 1].children == 0 && frames[frame_count - 1].loop_parts == 0) {
+                frame_count--;
+            }
+        }
+
+        int loop_parts = node->type == AST_LOOP_STATEMENT ? record.loop_parts & (UNIT_LOOP_COUNT | UNIT_LOOP_BODY) : 0;
+        if (record.num_children > 0 || loop_parts) {
+            if (frame_count >= frame_capacity) {
+                frame_capacity = frame_capacity == 0 ? 64 : frame_capacity * 2;
+                frames = (DecodeFrame*)realloc(frames, frame_capacity * sizeof(DecodeFrame));
+                if (!frames) {
+                    fprintf(stderr, "Memory allocation failed for unit decoding.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            frames[frame_count++] = (DecodeFrame){ node, record.num_children, loop_parts };
+        }
+    }
+    if (!root || frame_count > 0) goto malformed;
+    free(frames);
+    return root;
+
+malformed:
+    free(frames);
+    free_ast_node(root);
+    return NULL;
+}
+
+// --- Compilation ---
+
+// Lexes and parses a unit's source into its artifact; false after reporting errors
+static bool compile_source(const Linker* linker, const char* path, CompiledUnit* unit) {
+    LexContext lex;
+    init_lexer(&lex, NULL, path);
+    lexer_set_input_string(&lex, unit->source, unit->source_length);
+    int capacity = 256, count = 0;
+    Token* tokens = (Token*)malloc(capacity * sizeof(Token));
+    if (!tokens) {
+        fprintf(stderr, "Memory allocation failed for tokens array.\n");
+        exit(EXIT_FAILURE);
+    }
+    do {
+        if (count >= capacity) {
+            capacity *= 2;
+            tokens = (Token*)realloc(tokens, capacity * sizeof(Token));
+            if (!tokens) {
+                fprintf(stderr, "Memory re-allocation failed for tokens array.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        tokens[count] = get_next_token(&lex);
+    } while (tokens[count++].type != TOKEN_EOF && tokens[count - 1].type != TOKEN_ERROR);
+    free_lex_context(&lex);
+
+    ASTNode* program = tokens[count - 1].type == TOKEN_EOF ? linker->parse(tokens, count, linker->parse_context) : NULL;
+    free(tokens);
+    if (!program) return false;
+
+    ByteBuffer artifact = { NULL, 0, 0 };
+    ast_walk(program->children[0], true, encode_visit, &artifact); // The statement list
+    free_ast_node(program);
+    unit->artifact = artifact.data;
+    unit->artifact_length = artifact.length;
+    return true;
+}
+
+static bool read_exact(int fd, void* data, size_t length, off_t offset) {
+    char* p = (char*)data;
+    while (length > 0) {
+        ssize_t n = pread(fd, p, length, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        offset += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static char* entry_path(const char* cache_dir, uint64_t hash, const char* prefix) {
+    size_t length = strlen(cache_dir) + strlen(prefix) + 64;
+    char* path = (char*)malloc(length);
+    if (!path) {
+        fprintf(stderr, "Memory allocation failed for cache paths.\n");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(path, length, "%s/%s%016llx%s", cache_dir, prefix, (unsigned long long)hash, UNIT_ENTRY_SUFFIX);
+    return path;
+}
+
+// Takes the artifact of a unit with the same identity and source from the cache directory
+static bool load_entry(const char* cache_dir, const char* identity, CompiledUnit* unit) {
+    char* path = entry_path(cache_dir, unit->hash, "");
+    int fd = open(path, O_RDONLY);
+    free(path);
+    if (fd < 0) return false;
+
+    UnitEntryHeader header;
+    size_t identity_length = strlen(identity);
+    bool hit = read_exact(fd, &header, sizeof(header), 0) &&
+               memcmp(header.magic, UNIT_MAGIC, sizeof(header.magic)) == 0 &&
+               header.identity_length == identity_length && header.source_length == unit->source_length &&
+               header.artifact_length <= SIZE_MAX / 2;
+    char* stored = NULL;
+    size_t stored_length = hit ? identity_length + unit->source_length + header.artifact_length : 0;
+    if (hit) {
+        stored = (char*)malloc(stored_length + 1);
+        if (!stored) {
+            fprintf(stderr, "Memory allocation failed for unit artifact.\n");
+            exit(EXIT_FAILURE);
+        }
+        hit = read_exact(fd, stored, stored_length, sizeof(header)) &&
+              memcmp(stored, identity, identity_length) == 0 &&
+              memcmp(stored + identity_length, unit->source, unit->source_length) == 0;
+    }
+    if (hit) {
+        futimens(fd, NULL); // Mark as recently used for eviction
+        memmove(stored, stored + identity_length + unit->source_length, header.artifact_length);
+        unit->artifact = stored;
+        unit->artifact_length = header.artifact_length;
+    } else {
+        free(stored);
+    }
+    close(fd);
+    return hit;
+}
+
+// Stores a compiled unit in the cache directory; failures only cost the reuse
+static void store_entry(const char* cache_dir, const char* identity, const CompiledUnit* unit) {
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), ".tmp-%ld-", (long)getpid());
+    char* temp_path = entry_path(cache_dir, unit->hash, prefix);
+    char* path = entry_path(cache_dir, unit->hash, "");
+    UnitEntryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, UNIT_MAGIC, sizeof(header.magic));
+    header.identity_length = strlen(identity);
+    header.source_length = unit->source_length;
+    header.artifact_length = unit->artifact_length;
+
+    FILE* file = fopen(temp_path, "wb");
+    bool stored = file && fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(identity, 1, header.identity_length, file) == header.identity_length &&
+                  fwrite(unit->source, 1, unit->source_length, file) == unit->source_length &&
+                  fwrite(unit->artifact, 1, unit->artifact_length, file) == unit->artifact_length;
+    if (file && fclose(file) != 0) stored = false;
+    if (!stored || rename(temp_path, path) != 0) unlink(temp_path);
+    free(temp_path);
+    free(path);
+}
+
+// Checks an artifact read back from disk, dropping it if it is damaged
+static bool artifact_decodes(CompiledUnit* unit) {
+    ASTNode* tree = decode_artifact(unit->artifact, unit->artifact_length, NULL);
+    free_ast_node(tree);
+    if (tree) return true;
+    free(unit->artifact);
+    unit->artifact = NULL;
+    unit->artifact_length = 0;
+    return false;
+}
+
+// The compiled form of the file at path: from this run, the cache directory or
+// a fresh compilation. NULL after reporting why there is none.
+static const CompiledUnit* compile_unit(Linker* linker, const char* path, const ASTNode* include,
+                                        const char* including_path) {
+    CompiledUnit unit;
+    memset(&unit, 0, sizeof(unit));
+    unit.source = cache_read_file(path, &unit.source_length);
+    if (!unit.source) {
+        fprintf(stderr, "Link Error: Could not open '%s' (included from '%s' at line %d, column %d).\n", path,
+                including_path, include->location.line, include->location.column);
+        return NULL;
+    }
+    unit.hash = cache_hash_bytes(CACHE_HASH_SEED, unit.source, unit.source_length);
+    for (int i = 0; i < registry.count; ++i) {
+        const CompiledUnit* known = &registry.units[i];
+        if (known->hash == unit.hash && known->source_length == unit.source_length &&
+            memcmp(known->source, unit.source, unit.source_length) == 0) {
+            free(unit.source);
+            if (trace_enabled) printf("[DEBUG] Unit '%s': compiled earlier in this run\n", path);
+            return known;
+        }
+    }
+
+    char identity[512];
+    cache_build_identity(identity, sizeof(identity), "unit");
+    if (linker->cache_dir && load_entry(linker->cache_dir, identity, &unit) && artifact_decodes(&unit)) {
+        if (trace_enabled) printf("[DEBUG] Unit '%s': reused from '%s'\n", path, linker->cache_dir);
+    } else if (compile_source(linker, path, &unit)) {
+        if (trace_enabled) printf("[DEBUG] Unit '%s': compiled (%zu artifact bytes)\n", path, unit.artifact_length);
+        if (linker->cache_dir) store_entry(linker->cache_dir, identity, &unit);
+    } else {
+        fprintf(stderr, "Link Error: '%s' (included from '%s' at line %d, column %d) does not parse.\n", path,
+                including_path, include->location.line, include->location.column);
+        free(unit.source);
+        return NULL;
+    }
+
+    if (registry.count >= registry.capacity) {
+        registry.capacity = registry.capacity == 0 ? 8 : registry.capacity * 2;
+        registry.units = (CompiledUnit*)realloc(registry.units, registry.capacity * sizeof(CompiledUnit));
+        if (!registry.units) {
+            fprintf(stderr, "Memory allocation failed for compiled units.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    registry.units[registry.count] = unit;
+    return &registry.units[registry.count++];
+}
+
+// --- Linking ---
+
+static bool link_list(Linker* linker, ASTNode* list, const char* path, int loop_depth);
+
+static bool push_active(Linker* linker, const struct stat* st) {
+    for (int i = 0; i < linker->active_count; ++i) {
+        if (linker->active[i].device == st->st_dev && linker->active[i].inode == st->st_ino) return false;
+    }
+    if (linker->active_count >= linker->active_capacity) {
+        linker->active_capacity = linker->active_capacity == 0 ? 8 : linker->active_capacity * 2;
+        linker->active = (ActiveFile*)realloc(linker->active, linker->active_capacity * sizeof(ActiveFile));
+        if (!linker->active) {
+            fprintf(stderr, "Memory allocation failed for include chain.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    linker->active[linker->active_count++] = (ActiveFile){ st->st_dev, st->st_ino };
+    return true;
+}
+
+// The linked statement list of the file an include statement names, or NULL
+// after reporting why it cannot be linked
+static ASTNode* include_unit(Linker* linker, const ASTNode* include, const char* including_path, int loop_depth) {
+    char* resolved = resolve_path(including_path, include->children[0]->data.constant->text);
+    const char* path = intern_path(resolved);
+    free(resolved);
+
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "Link Error: Could not open '%s' (included from '%s' at line %d, column %d).\n", path,
+                including_path, include->location.line, include->location.column);
+        return NULL;
+    }
+    if (!push_active(linker, &st)) {
+        fprintf(stderr, "Link Error: '%s' includes itself (through '%s' at line %d, column %d).\n", path,
+                including_path, include->location.line, include->location.column);
+        return NULL;
+    }
+    const CompiledUnit* unit = compile_unit(linker, path, include, including_path);
+    ASTNode* list = unit ? decode_artifact(unit->artifact, unit->artifact_length, path) : NULL;
+    if (unit && !list) fprintf(stderr, "Link Error: The compiled form of '%s' is damaged.\n", path);
+    if (list && !link_list(linker, list, path, loop_depth)) {
+        free_ast_node(list);
+        list = NULL;
+    }
+    linker->active_count--;
+    return list;
+}
+
+// Links the body of a loop nested loop_depth deep
+static bool link_loop(Linker* linker, ASTNode* loop, const char* path, int loop_depth) {
+    // Each file was parsed within the bound on its own; an include inside a loop adds up
+    if (loop_depth > max_nesting_depth) {
+        fprintf(stderr, "Link Error: Included statements nest repeat statements deeper than %d ('%s' at line %d, column %d).\n",
+                max_nesting_depth, path, loop->location.line, loop->location.column);
+        return false;
+    }
+    ASTNode* body = loop->data.loop.body;
+    if (!body) return true;
+    switch (body->type) {
+        case AST_INCLUDE_STATEMENT: {
+            // repeat N times include "file"; runs the file's statements as one block
+            ASTNode* list = include_unit(linker, body, path, loop_depth);
+            if (!list) return false;
+            ASTNode* block = create_ast_node(AST_CODE_BLOCK, body->location);
+            add_child_to_ast_node(block, list);
+            free_ast_node(body);
+            loop->data.loop.body = block;
+            return true;
+        }
+        case AST_CODE_BLOCK:
+            return body->num_children == 1 ? link_list(linker, body->children[0], path, loop_depth) : true;
+        case AST_LOOP_STATEMENT:
+            return link_loop(linker, body, path, loop_depth + 1);
+        default:
+            return true;
+    }
+}
+
+// Replaces the include statements of a statement list by the statements they
+// name, in order, linking loop bodies on the way
+static bool link_list(Linker* linker, ASTNode* list, const char* path, int loop_depth) {
+    int first_include = 0;
+    while (first_include < list->num_children && list->children[first_include]->type != AST_INCLUDE_STATEMENT) {
+        ASTNode* statement = list->children[first_include++];
+        if (statement->type == AST_LOOP_STATEMENT && !link_loop(linker, statement, path, loop_depth + 1)) return false;
+    }
+    if (first_include == list->num_children) return true;
+
+    // Rebuilt from the first include on; on failure the rest is kept as is, so
+    // the program still frees as one tree
+    ASTNode** children = list->children;
+    int count = list->num_children;
+    list->children = NULL;
+    list->num_children = 0;
+    list->children_capacity = 0;
+    bool ok = true;
+    for (int i = 0; i < count; ++i) {
+        ASTNode* statement = children[i];
+        if (!ok || i < first_include) {
+            add_child_to_ast_node(list, statement);
+        } else if (statement->type == AST_INCLUDE_STATEMENT) {
+            ASTNode* unit = include_unit(linker, statement, path, loop_depth);
+            if (!unit) {
+                ok = false;
+                add_child_to_ast_node(list, statement);
+                continue;
+            }
+            for (int j = 0; j < unit->num_children; ++j) add_child_to_ast_node(list, unit->children[j]);
+            unit->num_children = 0;
+            free_ast_node(unit);
+            free_ast_node(statement);
+        } else {
+            ok = statement->type != AST_LOOP_STATEMENT || link_loop(linker, statement, path, loop_depth + 1);
+            add_child_to_ast_node(list, statement);
+        }
+    }
+    free(children);
+    return ok;
+}
+
+static void find_include(ASTNode* node, int depth, void* context) {
+    (void)depth;
+    ASTNode** found = (ASTNode**)context;
+    if (node->type == AST_INCLUDE_STATEMENT && !*found) *found = node;
+}
+
+ASTNode* units_find_include(ASTNode* node) {
+    ASTNode* found = NULL;
+    ast_walk(node, true, find_include, &found);
+    return found;
+}
+
+bool units_link(ASTNode* program, const char* program_path, UnitParser parse, void* parse_context,
+                const char* cache_dir) {
+    if (!program || program->num_children != 1) return true;
+    return units_link_list(program->children[0], program_path, parse, parse_context, cache_dir);
+}
+
+bool units_link_list(ASTNode* list, const char* program_path, UnitParser parse, void* parse_context,
+                     const char* cache_dir) {
+    // Linking recurses once per nesting level (within max_nesting_depth); a
+    // list without includes needs none of it, so it is not walked that way
+    if (!units_find_include(list)) return true;
+    Linker linker = { parse, parse_context, cache_dir, NULL, 0, 0 };
+    struct stat st;
+    if (stat(program_path, &st) == 0) push_active(&linker, &st);
+    bool ok = link_list(&linker, list, program_path, 0);
+    free(linker.active);
+    return ok;
+}
+
+void units_free(void) {
+    for (int i = 0; i < registry.count; ++i) {
+        free(registry.units[i].source);
+        free(registry.units[i].artifact);
+    }
+    free(registry.units);
+    for (int i = 0; i < registry.path_count; ++i) free(registry.paths[i]);
+    free(registry.paths);
+    memset(&registry, 0, sizeof(registry));
+}
+
+// --- Cache Keys ---
+
+// A file found while gathering an include closure. Files are told apart by
+// device and inode (by path when they cannot be found), so differently
+// spelled paths to one file are visited once.
+typedef struct {
+    char* path;
+    bool exists;
+    dev_t device;
+    ino_t inode;
+} IncludedFile;
+
+typedef struct {
+    IncludedFile* files;
+    int count;
+    int capacity;
+} IncludedFiles;
+
+static bool add_included(IncludedFiles* files, char* path) {
+    struct stat st;
+    bool exists = stat(path, &st) == 0;
+    for (int i = 0; i < files->count; ++i) {
+        const IncludedFile* known = &files->files[i];
+        if (exists ? known->exists && known->device == st.st_dev && known->inode == st.st_ino
+                   : !known->exists && strcmp(known->path, path) == 0) {
+            return false;
+        }
+    }
+    if (files->count >= files->capacity) {
+        files->capacity = files->capacity == 0 ? 8 : files->capacity * 2;
+        files->files = (IncludedFile*)realloc(files->files, files->capacity * sizeof(IncludedFile));
+        if (!files->files) {
+            fprintf(stderr, "Memory allocation failed for include closure.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    files->files[files->count++] = (IncludedFile){ path, exists, exists ? st.st_dev : 0, exists ? st.st_ino : 0 };
+    return true;
+}
+
+static bool mentions_include(const char* text, size_t length) {
+    const char* end = text + length;
+    for (const char* p = text; (p = (const char*)memchr(p, 'i', (size_t)(end - p))) != NULL; ++p) {
+        if (end - p >= 7 && memcmp(p, "include", 7) == 0) return true;
+    }
+    return false;
+}
+
+// Adds the files text names in include statements (a text that does not lex
+// is scanned up to its error, which the run will report)
+static void scan_includes(IncludedFiles* files, const char* path, const char* text, size_t length) {
+    if (!mentions_include(text, length)) return; // Most files include nothing: skip lexing them
+    LexContext lex;
+    init_lexer(&lex, NULL, path);
+    lex.report_errors = false;
+    lexer_set_input_string(&lex, text, length);
+    TokenType previous = TOKEN_EOF;
+    Token token;
+    do {
+        token = get_next_token(&lex);
+        if (previous == TOKEN_INCLUDE && token.type == TOKEN_STRING) {
+            char* resolved = resolve_path(path, token.value.string_constant->text);
+            if (!add_included(files, resolved)) free(resolved);
+        }
+        previous = token.type;
+    } while (token.type != TOKEN_EOF && token.type != TOKEN_ERROR);
+    free_lex_context(&lex);
+}
+
+void units_append_sources(const char* path, char** source, size_t* source_length) {
+    IncludedFiles files = { NULL, 0, 0 };
+    char* own_path = strdup(path);
+    if (!own_path) {
+        fprintf(stderr, "Memory allocation failed for include closure.\n");
+        exit(EXIT_FAILURE);
+    }
+    add_included(&files, own_path); // The source itself is already in the buffer
+    scan_includes(&files, path, *source, *source_length);
+    for (int i = 1; i < files.count; ++i) {
+        size_t length = 0;
+        char* text = cache_read_file(files.files[i].path, &length);
+        char line[64];
+        if (text) {
+            snprintf(line, sizeof(line), "\n%zu\n", length);
+        } else {
+            snprintf(line, sizeof(line), "\n-\n");
+        }
+        size_t name_length = strlen(files.files[i].path);
+        size_t line_length = strlen(line);
+        *source = (char*)realloc(*source, *source_length + name_length + line_length + length + 1);
+        if (!*source) {
+            fprintf(stderr, "Memory allocation failed for cached source.\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(*source + *source_length, files.files[i].path, name_length);
+        *source_length += name_length;
+        memcpy(*source + *source_length, line, line_length);
+        *source_length += line_length;
+        if (text) {
+            memcpy(*source + *source_length, text, length);
+            *source_length += length;
+            scan_includes(&files, files.files[i].path, text, length);
+            free(text);
+        }
+    }
+    for (int i = 0; i < files.count; ++i) free(files.files[i].path);
+    free(files.files);
+}
@@ -0,0 +1,44 @@
+#ifndef UNITS_H
+#define UNITS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "parser.h"
+
+// File name suffix of compiled units in a cache directory
+#define UNIT_ENTRY_SUFFIX ".plu"
+
+// Parses the tokens of one file (ending with TOKEN_EOF) into an AST_PROGRAM,
+// reporting any syntax error and returning NULL
+typedef ASTNode* (*UnitParser)(Token* tokens, int num_tokens, void* context);
+
+// Replaces every `include "file";` below program (an AST_PROGRAM) with the
+// statements of that file, which may include others in turn. A path is taken
+// relative to the directory of the file naming it. Each file is compiled once
+// per content: lexed, parsed and stored as a flat artifact keyed by the hash of
+// its bytes, which every include site decodes into fresh nodes. Artifacts last
+// for the run, and with a cache_dir (NULL for none) they are also kept there,
+// verified byte for byte against the source on reuse, so other scripts and
+// later runs skip lexing and parsing the file too. Names are resolved at run
+// time, so a unit links by name with the statements around its include site.
+// Reports the first missing file, cycle, syntax error or nesting overflow and
+// returns false.
+bool units_link(ASTNode* program, const char* program_path, UnitParser parse, void* parse_context,
+                const char* cache_dir);
+// The same for an AST_STATEMENT_LIST of top-level statements, linked in place,
+// for front ends that run statements as they are parsed (--pipeline, --repl)
+bool units_link_list(ASTNode* list, const char* program_path, UnitParser parse, void* parse_context,
+                     const char* cache_dir);
+// An include statement in the tree below node, or NULL if there is none
+ASTNode* units_find_include(ASTNode* node);
+
+// Releases the artifacts and the file names linked nodes point to (for their
+// locations); free those trees first
+void units_free(void);
+
+// Appends every file the source at path includes, directly or not, to the
+// source buffer (its name, length and bytes), so a cache key over the buffer
+// changes when any of them does
+void units_append_sources(const char* path, char** source, size_t* source_length);
+
+#endif // UNITS_H
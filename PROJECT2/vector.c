@@ -0,0 +1,243 @@
+#include "vector.h"
+#include "batch_update.h"
+#include "output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes of decimal text gathered before vector_write hands it to the sink
+#define VECTOR_WRITE_BUFFER (16 * 1024)
+
+static void* allocate_elements(size_t length, size_t size) {
+    void* elements = malloc((length > 0 ? length : 1) * size);
+    if (!elements) {
+        fprintf(stderr, "Memory allocation failed for vector elements.\n");
+        exit(EXIT_FAILURE);
+    }
+    return elements;
+}
+
+// True (with the value in out) if value fits the small representation
+static bool small_value(const BigInt* value, long long* out) {
+    for (int i = 1; i < NUM_LIMBS; ++i) {
+        if (value->limbs[i] != 0) return false;
+    }
+    if (value->limbs[0] >= (unsigned long long)BATCH_SMALL_LIMIT) return false;
+    *out = value->sign < 0 ? -(long long)value->limbs[0] : (long long)value->limbs[0];
+    return true;
+}
+
+// Moves the elements to BigInts, keeping their values
+static void promote(NumberVector* vector) {
+    BigInt* wide = (BigInt*)allocate_elements(vector->length, sizeof(BigInt));
+    for (size_t i = 0; i < vector->length; ++i) big_int_from_long_long(&wide[i], vector->small[i]);
+    free(vector->small);
+    vector->small = NULL;
+    vector->wide = wide;
+}
+
+// Switches representation without keeping the values (they are about to be overwritten)
+static void make_small(NumberVector* vector) {
+    if (vector->small) return;
+    free(vector->wide);
+    vector->wide = NULL;
+    vector->small = (long long*)allocate_elements(vector->length, sizeof(long long));
+}
+
+static void make_wide(NumberVector* vector) {
+    if (vector->wide) return;
+    free(vector->small);
+    vector->small = NULL;
+    vector->wide = (BigInt*)allocate_elements(vector->length, sizeof(BigInt));
+}
+
+// values[i] += sign * deltas[i] for i < length (sign * deltas[0] for every i
+// when repeat is set), BATCH_MAX_LANES at a time. Sums of two small values are
+// exact, so a chunk that leaves the small range is still right; it ends the run
+// and false is returned, with *done set to the elements updated.
+static bool add_small_elements(long long* values, const long long* deltas, bool repeat, int sign,
+                               size_t length, size_t* done) {
+    long long lane_deltas[BATCH_MAX_LANES];
+    if (repeat) {
+        for (int l = 0; l < BATCH_MAX_LANES; ++l) lane_deltas[l] = sign * deltas[0];
+    }
+    size_t i = 0;
+    while (i < length) {
+        int count = length - i < BATCH_MAX_LANES ? (int)(length - i) : BATCH_MAX_LANES;
+        const long long* chunk = lane_deltas;
+        if (!repeat && sign > 0) {
+            chunk = deltas + i;
+        } else if (!repeat) {
+            for (int l = 0; l < count; ++l) lane_deltas[l] = -deltas[i + l];
+        }
+        unsigned long long outside = batch_add_small(values + i, chunk, count);
+        i += count;
+        if (outside) {
+            *done = i;
+            return false;
+        }
+    }
+    *done = length;
+    return true;
+}
+
+// --- Table ---
+
+void vector_table_init(VectorTable* table) {
+    table->vectors = NULL;
+    table->count = 0;
+    table->capacity = 0;
+}
+
+void vector_table_free(VectorTable* table) {
+    for (int i = 0; i < table->count; ++i) {
+        free(table->vectors[i].name);
+        free(table->vectors[i].small);
+        free(table->vectors[i].wide);
+    }
+    free(table->vectors);
+    vector_table_init(table);
+}
+
+NumberVector* vector_table_find(VectorTable* table, const char* name) {
+    for (int i = 0; i < table->count; ++i) {
+        if (strcmp(table->vectors[i].name, name) == 0) return &table->vectors[i];
+    }
+    return NULL;
+}
+
+NumberVector* vector_table_add(VectorTable* table, const char* name, size_t length, const BigInt* value) {
+    if (table->count >= table->capacity) {
+        table->capacity = table->capacity == 0 ? 4 : table->capacity * 2;
+        table->vectors = (NumberVector*)realloc(table->vectors, table->capacity * sizeof(NumberVector));
+        if (!table->vectors) {
+            fprintf(stderr, "Memory allocation failed for vector table.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    NumberVector* vector = &table->vectors[table->count++];
+    vector->name = strdup(name);
+    if (!vector->name) {
+        fprintf(stderr, "Memory allocation failed for vector name.\n");
+        exit(EXIT_FAILURE);
+    }
+    vector->length = length;
+    vector->small = NULL;
+    vector->wide = NULL;
+    vector_fill(vector, value);
+    return vector;
+}
+
+// --- Element-wise Operations ---
+
+void vector_fill(NumberVector* vector, const BigInt* value) {
+    long long small;
+    if (small_value(value, &small)) {
+        make_small(vector);
+        for (size_t i = 0; i < vector->length; ++i) vector->small[i] = small;
+    } else {
+        make_wide(vector);
+        for (size_t i = 0; i < vector->length; ++i) big_int_copy(&vector->wide[i], value);
+    }
+}
+
+void vector_copy(NumberVector* dest, const NumberVector* source) {
+    if (dest == source) return;
+    if (source->small) {
+        make_small(dest);
+        memcpy(dest->small, source->small, dest->length * sizeof(long long));
+    } else {
+        make_wide(dest);
+        memcpy(dest->wide, source->wide, dest->length * sizeof(BigInt));
+    }
+}
+
+void vector_add_scalar(NumberVector* vector, const BigInt* amount, int sign) {
+    size_t start = 0;
+    long long small;
+    if (vector->small && small_value(amount, &small)) {
+        if (add_small_elements(vector->small, &small, true, sign, vector->length, &start)) return;
+        promote(vector);
+    } else if (vector->small) {
+        promote(vector);
+    }
+
+    BigInt step;
+    big_int_copy(&step, amount);
+    if (sign < 0) {
+        step.sign = -step.sign;
+        big_int_normalize(&step);
+    }
+    for (size_t i = start; i < vector->length; ++i) big_int_add(&vector->wide[i], &vector->wide[i], &step);
+}
+
+void vector_add(NumberVector* dest, const NumberVector* source, int sign) {
+    size_t start = 0;
+    if (dest->small && source->small) {
+        if (add_small_elements(dest->small, source->small, false, sign, dest->length, &start)) return;
+        promote(dest); // When source is dest, its remaining elements keep their values
+    } else if (dest->small) {
+        promote(dest);
+    }
+
+    for (size_t i = start; i < dest->length; ++i) {
+        BigInt converted;
+        const BigInt* amount = &converted;
+        if (source->small) {
+            big_int_from_long_long(&converted, source->small[i]);
+        } else {
+            amount = &source->wide[i];
+        }
+        if (sign > 0) {
+            big_int_add(&dest->wide[i], &dest->wide[i], amount);
+        } else {
+            big_int_sub(&dest->wide[i], &dest->wide[i], amount);
+        }
+    }
+}
+
+void vector_set(NumberVector* vector, size_t i, const BigInt* value) {
+    long long small;
+    if (vector->small && small_value(value, &small)) {
+        vector->small[i] = small;
+        return;
+    }
+    if (vector->small) promote(vector);
+    big_int_copy(&vector->wide[i], value);
+}
+
+// --- Output ---
+
+static size_t format_small(long long value, char* out) {
+    char digits[24];
+    int count = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    size_t length = 0;
+    if (value < 0) out[length++] = '-';
+    while (count > 0) out[length++] = digits[--count];
+    return length;
+}
+
+void vector_write(const NumberVector* vector) {
+    char buffer[VECTOR_WRITE_BUFFER];
+    size_t used = 0;
+    for (size_t i = 0; i < vector->length; ++i) {
+        // Room for a separator and the longest BigInt text
+        if (used + MAX_BIGINT_STRING_LEN + 1 > sizeof(buffer)) {
+            output_write(buffer, used);
+            used = 0;
+        }
+        if (i > 0) buffer[used++] = ' ';
+        if (vector->small) {
+            used += format_small(vector->small[i], buffer + used);
+        } else {
+            big_int_to_string(&vector->wide[i], buffer + used);
+            used += strlen(buffer + used);
+        }
+    }
+    if (used > 0) output_write(buffer, used);
+}
@@ -0,0 +1,50 @@
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "bigint.h"
+
+// Most elements a vector declaration may ask for
+#define VECTOR_MAX_LENGTH (1 << 22)
+
+// Elements of a `vector` variable, in one contiguous slab. While every element
+// is below BATCH_SMALL_LIMIT in magnitude the slab holds plain 64-bit integers,
+// updated BATCH_MAX_LANES at a time by batch_add_small. Once an element grows
+// past that, the whole vector moves to BigInts (wide) until it is refilled
+// with small values. Elements behave exactly like number variables,
+// wrap-around included.
+typedef struct {
+    char* name;
+    size_t length;
+    long long* small; // NULL while wide
+    BigInt* wide;     // NULL while small
+} NumberVector;
+
+// Vectors by name. Programs declare few of them, so lookups scan the list.
+// Pointers into it stay valid until the next vector_table_add.
+typedef struct {
+    NumberVector* vectors;
+    int count;
+    int capacity;
+} VectorTable;
+
+void vector_table_init(VectorTable* table);
+void vector_table_free(VectorTable* table);
+NumberVector* vector_table_find(VectorTable* table, const char* name);
+// Adds a vector of length elements, all equal to value (the name must be new)
+NumberVector* vector_table_add(VectorTable* table, const char* name, size_t length, const BigInt* value);
+
+// vector[i] := value for every i
+void vector_fill(NumberVector* vector, const BigInt* value);
+// dest[i] := source[i] (same length)
+void vector_copy(NumberVector* dest, const NumberVector* source);
+// vector[i] += sign * amount for every i (sign is 1 or -1)
+void vector_add_scalar(NumberVector* vector, const BigInt* amount, int sign);
+// dest[i] += sign * source[i] (same length; source may be dest)
+void vector_add(NumberVector* dest, const NumberVector* source, int sign);
+void vector_set(NumberVector* vector, size_t i, const BigInt* value);
+// Writes the elements separated by single spaces through the output sink
+void vector_write(const NumberVector* vector);
+
+#endif // VECTOR_H
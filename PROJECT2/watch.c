@@ -0,0 +1,124 @@
+#include "watch.h"
+#include "incremental.h"
+#include "reexec.h"
+#include "output.h"
+#include "units.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+static char* read_whole_file(const char* filename, size_t* out_length) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return NULL;
+    size_t capacity = 4096, length = 0;
+    char* data = (char*)malloc(capacity);
+    if (!data) {
+        fprintf(stderr, "Memory allocation failed for watched file contents.\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t n;
+    while ((n = fread(data + length, 1, capacity - length, file)) > 0) {
+        length += n;
+        if (length == capacity) {
+            capacity *= 2;
+            data = (char*)realloc(data, capacity);
+            if (!data) {
+                fprintf(stderr, "Memory allocation failed for watched file contents.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    fclose(file);
+    *out_length = length;
+    return data;
+}
+
+static double elapsed_ms(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static void rerun(ReexecSession* session, const IncrementalParser* ip) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    reexec_session_run(session, ip);
+    output_write(session->output, session->output_length);
+    fflush(stdout);
+    fprintf(stderr, "[watch] %d statement(s) run, %d replayed, %d re-parsed (%.2f ms)\n",
+            session->last_executed, session->last_replayed, ip->last_reparsed, elapsed_ms(&start));
+}
+
+// Re-runs replay statements by their place in the incrementally parsed text,
+// which splicing in other files would break, so a program with an include is
+// refused as a whole instead of run in part. False after reporting it.
+static bool free_of_includes(const IncrementalParser* ip, const char* filename) {
+    const ASTNode* include = units_find_include(incremental_parser_program(ip));
+    if (!include) return true;
+    fprintf(stderr, "Link Error: --watch does not link include statements ('%s' at line %d, column %d).\n", filename,
+            include->location.line, include->location.column);
+    return false;
+}
+
+// Turns the difference between the old and new text into a single edit
+static bool apply_file_change(IncrementalParser* ip, const char* text, size_t length) {
+    size_t prefix = 0;
+    size_t limit = length < ip->length ? length : ip->length;
+    while (prefix < limit && ip->text[prefix] == text[prefix]) prefix++;
+    size_t suffix = 0;
+    while (suffix < limit - prefix && ip->text[ip->length - 1 - suffix] == text[length - 1 - suffix]) suffix++;
+    if (prefix == length && prefix == ip->length) return false; // Touched but unchanged
+    return incremental_parser_edit(ip, prefix, ip->length - prefix - suffix, text + prefix, length - prefix - suffix);
+}
+
+bool run_watch(const Grammar* grammar, const char* filename) {
+    size_t length;
+    char* text = read_whole_file(filename, &length);
+    if (!text) {
+        fprintf(stderr, "Error: Could not open input file '%s'\n", filename);
+        return false;
+    }
+    struct stat last_stat;
+    stat(filename, &last_stat);
+
+    IncrementalParser* ip = incremental_parser_create(grammar, text, length, filename);
+    free(text);
+    if (!ip) return false;
+
+    if (incremental_parser_program(ip) && !free_of_includes(ip, filename)) {
+        incremental_parser_free(ip);
+        return false;
+    }
+
+    ReexecSession session;
+    reexec_session_init(&session);
+    interpreter_begin();
+    if (incremental_parser_program(ip)) rerun(&session, ip);
+
+    struct timespec interval = { .tv_sec = 0, .tv_nsec = WATCH_POLL_INTERVAL_MS * 1000000L };
+    while (true) {
+        nanosleep(&interval, NULL);
+        struct stat current;
+        if (stat(filename, &current) != 0) continue; // Mid-save by an editor; try again
+        if (current.st_mtim.tv_sec == last_stat.st_mtim.tv_sec && current.st_mtim.tv_nsec == last_stat.st_mtim.tv_nsec &&
+            current.st_size == last_stat.st_size) {
+            continue;
+        }
+        last_stat = current;
+
+        text = read_whole_file(filename, &length);
+        if (!text) continue;
+        bool changed = apply_file_change(ip, text, length);
+        free(text);
+        // A text that does not parse (or link) keeps the previous run's records for the next good one
+        if (changed && incremental_parser_program(ip) && free_of_includes(ip, filename)) rerun(&session, ip);
+    }
+
+    // Not reached: the loop only ends when the process is interrupted
+    interpreter_end();
+    reexec_session_free(&session);
+    incremental_parser_free(ip);
+    return true;
+}
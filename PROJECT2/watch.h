@@ -0,0 +1,19 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <stdbool.h>
+#include "parser.h"
+
+// How often the watched file is checked for changes, in milliseconds
+#define WATCH_POLL_INTERVAL_MS 100
+
+// Runs the file, then re-runs it whenever it changes on disk. Each change is
+// applied as one edit: only the touched statements are re-parsed, and only
+// statements whose code or inputs changed are re-executed. The parsing tables
+// must already be built. Include statements are not linked: a version of the
+// file with one is reported with a Link Error and not run. Runs until
+// interrupted; returns false if the file cannot be read or starts out with an
+// include.
+bool run_watch(const Grammar* grammar, const char* filename);
+
+#endif // WATCH_H